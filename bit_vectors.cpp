@@ -26,6 +26,7 @@ uint32_t bit_vector_dword_next_bit_index(
 
 	uint32_t word_index, bit_offset;
 	bit_vector_traits_dword::bit_cursors_from_bit_index(start_bit_index, word_index, bit_offset);
+	auto word_length = static_cast<uint32_t>( bit_vector_traits_dword::get_size_in_words(bit_length) );
 
 	// get a mask for the the bits that start at bit_offset, thus ignoring bits that came before startBitIndex
 	auto bitmask = bit_vector_dword_section_bitmask_little_endian(bit_offset);
@@ -43,7 +44,7 @@ uint32_t bit_vector_dword_next_bit_index(
 			result_bit_index = bit_vector_dword_count_zeros_for_next_bit_little_endian(word) + (word_index * BIT_COUNT(word));
 
 		// I perform the increment and loop condition here to keep the for() statement simple
-		if (++word_index == bit_length)
+		if (++word_index == word_length)
 			break;
 	}
 
@@ -1,336 +1,259 @@
 #include <precompile.h>
 #include <boggle.h>
 
+#include <boggle_board_batch_file.h>
 #include <boggle_dictionary.h>
 #include <boggle_dictionary_compact_trie.h>
-#include <boggle_dictionary_trie.h>
+#include <boggle_dictionary_compact_trie_cache.h>
 #include <boggle_dictionary_word.h>
+#include <boggle_found_words.h>
 #include <boggle_grid.h>
 #include <boggle_grid_cell.h>
 #include <boggle_grid_cell_neighbor.h>
 #include <boggle_grid_char.h>
+#include <boggle_resident_dictionary.h>
+#include <boggle_solve_context.h>
+#include <trace.h>
 #include <trie_boggle_board_solver.h>
 
-struct s_boggle_dictionary_binary_file_header
-{
-	enum
-	{
-		k_signature = 'bdic',
-		k_version = 1,
-	};
-
-	uint32_t signature;
-	uint32_t version;
-
-	struct
-	{
-		int32_t offset;
-		int32_t length;
-	}dictionary, dictionary_trie;
-};
-static_assert(sizeof(s_boggle_dictionary_binary_file_header) == 0x18,
-	"Unexpected s_boggle_dictionary_binary_file_header size");
-
 c_boggle::c_boggle()
-	: m_dictionary(nullptr)
-	, m_dictionary_compact_trie(nullptr)
+	: m_resident_dictionary()
+	, m_mutex()
+	, m_filtered_dictionary_compact_trie_cache()
+	, m_filtered_dictionary_compact_trie_cache_memory_budget(c_boggle_dictionary_compact_trie_cache::k_default_memory_budget)
 	, m_currently_solving_board(false)
 	, m_filter_dictionary_with_occuring_grid_chars(false)
-	, m_estimated_total_memory_used_for_dictionary_trie(0)
-	, m_estimated_total_memory_used_for_dictionary_compact_trie(0)
-	, m_estimated_total_memory_used_for_grid(0)
-	, m_estimated_total_memory_used_for_solver(0)
+	, m_verify_binary_legal_words_checksums(true)
+	, m_load_trie_only_dictionary(false)
+	, m_shortest_word_length(c_boggle_dictionary::k_shortest_acceptable_word_length)
+	, m_longest_word_length(c_boggle_dictionary::k_longest_acceptable_word_length)
+	, m_solve_context(new c_boggle_solve_context)
+	, m_board_batch_solve_contexts()
+	, m_last_solve_stats()
 {
 }
 
 c_boggle::~c_boggle()
 {
-	deallocate_dictionary();
 }
 
-void c_boggle::deallocate_dictionary()
+std::shared_ptr<c_boggle_dictionary_compact_trie_cache> c_boggle::get_filtered_dictionary_trie_cache_for_solving(
+	const std::shared_ptr<const c_boggle_resident_dictionary>& resident_dictionary)
 {
-	deallocate_dictionary_trie();
-
-	if (m_dictionary)
+	// filtered tries are built from the dictionary's words, which a trie-only dictionary doesn't
+	// have. The solver's pruning still skips the subtrees filtering would have dropped
+	if (!m_filter_dictionary_with_occuring_grid_chars ||
+		resident_dictionary->get_dictionary()->is_trie_only())
 	{
-		delete m_dictionary;
-		m_dictionary = nullptr;
+		return nullptr;
 	}
-}
 
-void c_boggle::deallocate_dictionary_trie()
-{
-	if (m_dictionary_compact_trie)
-	{
-		delete m_dictionary_compact_trie;
-		m_dictionary_compact_trie = nullptr;
-	}
-}
+	std::lock_guard<std::mutex> lock(m_mutex);
 
-bool c_boggle::build_dictionary_trie(
-	const uint32_t occuring_grid_chars_flags)
-{
-	static_assert(sizeof(occuring_grid_chars_flags) == sizeof(boggle_grid_char_flags_t),
-		"This API needs to be updated");
-
-	bool success = true;
-
-	c_boggle_dictionary_trie dictionary_trie(m_dictionary,
-		occuring_grid_chars_flags);
-
-	success = dictionary_trie.build();
-	m_estimated_total_memory_used_for_dictionary_trie = dictionary_trie.estimate_total_memory_used();
-
-	if (success)
+	// the cached tries are of no use once the dictionary they were built from is replaced. The
+	// cache keeps its dictionary alive, so it can't have been reused by a new one
+	if (!m_filtered_dictionary_compact_trie_cache ||
+		m_filtered_dictionary_compact_trie_cache->get_dictionary() != resident_dictionary->get_dictionary())
 	{
-		m_dictionary_compact_trie = new c_boggle_dictionary_compact_trie(dictionary_trie);
-
-		success = m_dictionary_compact_trie->build(dictionary_trie);
-
-		m_estimated_total_memory_used_for_dictionary_compact_trie = m_dictionary_compact_trie->estimate_total_memory_used();
+		m_filtered_dictionary_compact_trie_cache = std::make_shared<c_boggle_dictionary_compact_trie_cache>(
+			resident_dictionary, m_filtered_dictionary_compact_trie_cache_memory_budget);
 	}
 
-	return success;
+	return m_filtered_dictionary_compact_trie_cache;
 }
 
-bool c_boggle::build_dictionary_trie(
+std::shared_ptr<const c_boggle_dictionary_compact_trie> c_boggle::get_dictionary_trie_for_solving(
+	const std::shared_ptr<const c_boggle_resident_dictionary>& resident_dictionary,
 	const c_boggle_grid& grid)
 {
-	auto occuring_grid_chars_flags = grid.get_occuring_grid_chars_flags();
-
-	if (m_dictionary_compact_trie != nullptr)
-	{
-		if (m_filter_dictionary_with_occuring_grid_chars &&
-			occuring_grid_chars_flags != m_dictionary_compact_trie->get_occuring_grid_chars_flags())
-		{
-			deallocate_dictionary_trie();
-		}
-	}
+	std::shared_ptr<c_boggle_dictionary_compact_trie_cache> filtered_dictionary_compact_trie_cache =
+		get_filtered_dictionary_trie_cache_for_solving(resident_dictionary);
+	if (filtered_dictionary_compact_trie_cache)
+		return filtered_dictionary_compact_trie_cache->get_or_build(grid.get_occuring_grid_chars_flags());
+
+	// shares ownership with the resident dictionary, which keeps the trie alive for the solve
+	return std::shared_ptr<const c_boggle_dictionary_compact_trie>(
+		resident_dictionary, resident_dictionary->get_dictionary_trie());
+}
 
-	bool success = true;
+void c_boggle::publish_resident_dictionary(
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary)
+{
+	std::shared_ptr<c_boggle_dictionary_compact_trie_cache> previous_filtered_dictionary_compact_trie_cache;
 
-	if (m_dictionary_compact_trie == nullptr)
 	{
-		if (!m_filter_dictionary_with_occuring_grid_chars)
-			occuring_grid_chars_flags = MASK(k_number_of_boggle_grid_characters);
+		std::lock_guard<std::mutex> lock(m_mutex);
 
-		build_dictionary_trie(occuring_grid_chars_flags);
+		m_resident_dictionary.swap(resident_dictionary);
+		m_filtered_dictionary_compact_trie_cache.swap(previous_filtered_dictionary_compact_trie_cache);
 	}
 
-	return success;
+	// the previous dictionary and its filtered tries are freed here, outside the lock, unless a
+	// solve is still holding on to them
 }
 
 void c_boggle::set_legal_words_from_alphabetically_sorted_array(
 	const std::vector<std::string>& all_words)
 {
-	if (m_currently_solving_board.load())
-	{
-		output_error("set_legal_words called while we're already solving a board");
-		return;
-	}
-
-	deallocate_dictionary();
-	m_dictionary = new c_boggle_dictionary;
-	if (!m_dictionary)
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary =
+		c_boggle_resident_dictionary::create_from_alphabetically_sorted_array(all_words);
+	if (!resident_dictionary)
 	{
-		output_error("set_legal_words failed to allocate dictionary");
+		output_error("set_legal_words failed to build dictionary from all_words");
 		return;
 	}
 
-	if (!m_dictionary->set_legal_words_from_alphabetically_sorted_array(all_words))
-	{
-		output_error("set_legal_words failed to add all_words to dictionary");
-		return;
-	}
+	publish_resident_dictionary(std::move(resident_dictionary));
 }
 
-bool c_boggle::load_binary_legal_words(
-	_iobuf* file,
+bool c_boggle::load_text_legal_words(
 	const char* filename)
 {
-	s_boggle_dictionary_binary_file_header header;
+	TRACE_SCOPE("load_text_legal_words");
 
-	if (1 != fread(&header, sizeof header, 1, file))
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary =
+		c_boggle_resident_dictionary::create_from_text_file(filename);
+	if (!resident_dictionary)
 		return false;
 
-	if (header.signature != header.k_signature ||
-		header.version != header.k_version ||
-		header.dictionary.offset <= 0 ||
-		header.dictionary.length <= 0 ||
-		header.dictionary_trie.offset <= 0 ||
-		header.dictionary_trie.length <= 0)
-	{
-		output_error("load_binary_legal_words file has invalid header: %s",
-			filename);
-		return false;
-	}
-
-	deallocate_dictionary();
-
-	if (0 != fseek(file, header.dictionary.offset, SEEK_SET))
-	{
-		output_error("load_binary_legal_words failed to seek to dictionary blob: %s",
-			filename);
-		return false;
-	}
+	publish_resident_dictionary(std::move(resident_dictionary));
+	return true;
+}
 
-	m_dictionary = new c_boggle_dictionary;
-	if (!m_dictionary)
-	{
-		output_error("load_binary_legal_words failed to allocate dictionary: %s",
-			filename);
-		return false;
-	}
-	if (!m_dictionary->read_from_file(file))
-	{
-		output_error("load_binary_legal_words failed to read dictionary blob: %s",
-			filename);
-		return false;
-	}
+bool c_boggle::load_binary_legal_words(
+	const char* filename,
+	const bool map_file)
+{
+	TRACE_SCOPE(map_file ? "map_binary_legal_words" : "load_binary_legal_words");
 
-	if (0 != fseek(file, header.dictionary_trie.offset, SEEK_SET))
-	{
-		output_error("load_binary_legal_words failed to seek to dictionary trie blob: %s",
-			filename);
-		return false;
-	}
+	s_boggle_resident_dictionary_binary_file_options options;
+	options.map_file = map_file;
+	options.verify_checksums = m_verify_binary_legal_words_checksums;
+	options.trie_only = m_load_trie_only_dictionary;
 
-	m_dictionary_compact_trie = new c_boggle_dictionary_compact_trie;
-	if (!m_dictionary_compact_trie)
-	{
-		output_error("load_binary_legal_words failed to allocate dictionary trie: %s",
-			filename);
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary =
+		c_boggle_resident_dictionary::create_from_binary_file(filename, options);
+	if (!resident_dictionary)
 		return false;
-	}
-	if (!m_dictionary_compact_trie->read_from_file(file, m_dictionary))
-	{
-		output_error("load_binary_legal_words failed to read dictionary trie blob: %s",
-			filename);
-		return false;
-	}
 
+	publish_resident_dictionary(std::move(resident_dictionary));
 	return true;
 }
 
 bool c_boggle::load_binary_legal_words(
 	const char* filename)
 {
-	if (m_currently_solving_board.load())
-	{
-		output_error("load_binary_legal_words called while we're already solving a board");
-		return false;
-	}
+	return load_binary_legal_words(filename, false);
+}
 
-	if (!filename || *filename == '\0')
-	{
-		output_error("load_binary_legal_words passed null or empty filename");
-		return false;
-	}
+bool c_boggle::map_binary_legal_words(
+	const char* filename)
+{
+	return load_binary_legal_words(filename, true);
+}
 
-	FILE* file;
-	if (fopen_s(&file, filename, "rb") != 0)
+bool c_boggle::save_binary_legal_words(
+	const char* filename)
+{
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = get_resident_dictionary();
+	if (!resident_dictionary)
 	{
-		output_error("load_binary_legal_words failed to open file: %s",
-			filename);
+		output_error("save_binary_legal_words called before set_legal_words");
 		return false;
 	}
 
-	bool success = load_binary_legal_words(file, filename);
-	fclose(file);
+	return resident_dictionary->save_binary_file(filename);
+}
 
-	return success;
+std::future<bool> c_boggle::replace_resident_dictionary_in_background(
+	std::function<std::shared_ptr<const c_boggle_resident_dictionary>()> create_resident_dictionary)
+{
+	return std::async(std::launch::async,
+		[this, create_resident_dictionary]()
+		{
+			std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = create_resident_dictionary();
+			if (!resident_dictionary)
+				return false;
+
+			publish_resident_dictionary(std::move(resident_dictionary));
+			return true;
+		});
 }
 
-bool c_boggle::save_binary_legal_words(
-	_iobuf* file,
+std::future<bool> c_boggle::load_text_legal_words_in_background(
 	const char* filename)
 {
-	s_boggle_dictionary_binary_file_header header =
-	{
-		header.k_signature,
-		header.k_version,
-		{ sizeof header, 0 },
-		{ sizeof header, 0 },
-	};
+	// the caller's filename needn't outlive this call
+	std::string text_filename(filename);
 
-	if (1 != fwrite(&header, sizeof header, 1, file))
-		return false;
+	return replace_resident_dictionary_in_background(
+		[text_filename]()
+		{
+			TRACE_SCOPE("load_text_legal_words_in_background");
 
-	header.dictionary.offset = ftell(file);
-	if (!m_dictionary->write_to_file(file))
-	{
-		output_error("save_binary_legal_words failed to write dictionary blob: %s",
-			filename);
-		return false;
-	}
-	header.dictionary.length = ftell(file) - header.dictionary.offset;
+			return c_boggle_resident_dictionary::create_from_text_file(text_filename.c_str());
+		});
+}
 
-	header.dictionary_trie.offset = ftell(file);
-	if (!m_dictionary_compact_trie->write_to_file(file))
-	{
-		output_error("save_binary_legal_words failed to write dictionary trie blob: %s",
-			filename);
-		return false;
-	}
-	header.dictionary_trie.length = ftell(file) - header.dictionary_trie.offset;
+std::future<bool> c_boggle::map_binary_legal_words_in_background(
+	const char* filename)
+{
+	std::string binary_filename(filename);
 
-	if (0 != fseek(file, 0, SEEK_SET))
-	{
-		output_error("save_binary_legal_words failed to seek to header for finalization: %s",
-			filename);
-		return false;
-	}
+	s_boggle_resident_dictionary_binary_file_options options;
+	options.map_file = true;
+	options.verify_checksums = m_verify_binary_legal_words_checksums;
+	options.trie_only = m_load_trie_only_dictionary;
 
-	if (1 != fwrite(&header, sizeof header, 1, file))
-		return false;
+	return replace_resident_dictionary_in_background(
+		[binary_filename, options]()
+		{
+			TRACE_SCOPE("map_binary_legal_words_in_background");
 
-	return true;
+			return c_boggle_resident_dictionary::create_from_binary_file(binary_filename.c_str(), options);
+		});
 }
 
-bool c_boggle::save_binary_legal_words(
-	const char* filename)
+void c_boggle::set_resident_dictionary(
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary)
 {
-	if (m_currently_solving_board.load())
+	if (!resident_dictionary)
 	{
-		output_error("save_binary_legal_words called while we're already solving a board");
-		return false;
+		output_error("set_resident_dictionary passed null dictionary");
+		return;
 	}
 
-	if (!filename || *filename == '\0')
-	{
-		output_error("save_binary_legal_words passed null or empty filename");
-		return false;
-	}
+	publish_resident_dictionary(std::move(resident_dictionary));
+}
 
-	if (!m_dictionary)
-	{
-		output_error("save_binary_legal_words called before set_legal_words");
-		return false;
-	}
-	if (!m_dictionary_compact_trie &&
-		!build_dictionary_trie(MASK(k_number_of_boggle_grid_characters)))
-	{
-		output_error("save_binary_legal_words failed to build dictionary trie");
-		return false;
-	}
+std::shared_ptr<const c_boggle_resident_dictionary> c_boggle::get_resident_dictionary() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
 
-	FILE* file;
-	if (fopen_s(&file, filename, "w+b") != 0)
-	{
-		output_error("save_binary_legal_words failed to open/create file: %s",
-			filename);
-		return false;
-	}
+	return m_resident_dictionary;
+}
 
-	bool success = save_binary_legal_words(file, filename);
-	fclose(file);
+const c_boggle_dictionary* c_boggle::get_dictionary() const
+{
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = get_resident_dictionary();
 
-	return success;
+	return resident_dictionary
+		? resident_dictionary->get_dictionary()
+		: nullptr;
+}
+
+const c_boggle_dictionary_compact_trie* c_boggle::get_dictionary_trie() const
+{
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = get_resident_dictionary();
+
+	return resident_dictionary
+		? resident_dictionary->get_dictionary_trie()
+		: nullptr;
 }
 
 bool c_boggle::solve_board(
-	std::vector<std::string>& found_words,
+	c_boggle_solve_context& context,
+	std::vector<std::string>* found_words,
 	const int board_width,
 	const int board_height,
 	const char* board_letters)
@@ -341,8 +264,9 @@ bool c_boggle::solve_board(
 		return false;
 	}
 
-	m_estimated_total_memory_used_for_grid = 0;
-	m_estimated_total_memory_used_for_solver = 0;
+	m_last_solve_stats.clear();
+
+	TRACE_SCOPE("solve_board");
 
 	bool success = false;
 	m_currently_solving_board.store(true);
@@ -360,20 +284,25 @@ bool c_boggle::solve_board(
 			output_error("called solve_board with a null or empty board_letters string");
 			break;
 		}
-		if (!m_dictionary)
+
+		// the dictionary may be replaced while we're solving, this keeps the one we started with alive
+		std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = get_resident_dictionary();
+		if (!resident_dictionary)
 		{
 			output_error("called solve_board without first calling set_legal_words");
 			break;
 		}
 
-		c_boggle_grid grid(board_width, board_height);
-		if (!grid.set_grid_characters(board_letters))
 		{
-			output_error("solve_board couldn't use board_letters data");
-			break;
-		}
+			TRACE_SCOPE("build_grid");
 
-		m_estimated_total_memory_used_for_grid = grid.estimate_total_memory_used();
+			if (!context.set_board(board_width, board_height, board_letters))
+			{
+				output_error("solve_board couldn't use board_letters data");
+				break;
+			}
+		}
+		const c_boggle_grid& grid = context.get_grid();
 
 		// based on the English dictionary I unearthed, there are indeed words that are just one letter, so this could be a legitimate board to solve
 #if 0
@@ -389,10 +318,16 @@ bool c_boggle::solve_board(
 		}
 #endif
 
-		if (!build_dictionary_trie(grid))
+		std::shared_ptr<const c_boggle_dictionary_compact_trie> dictionary_compact_trie;
 		{
-			output_error("solve_board couldn't allocate/build dictionary_trie or its compact form");
-			break;
+			TRACE_SCOPE("get_dictionary_trie");
+
+			dictionary_compact_trie = get_dictionary_trie_for_solving(resident_dictionary, grid);
+			if (!dictionary_compact_trie)
+			{
+				output_error("solve_board couldn't allocate/build dictionary_trie or its compact form");
+				break;
+			}
 		}
 
 		int processor_count = omp_get_num_procs();
@@ -400,16 +335,12 @@ bool c_boggle::solve_board(
 			processor_count);
 
 		c_trie_boggle_board_solver board_solver(
-			*m_dictionary_compact_trie, grid, found_words);
+			*dictionary_compact_trie, context, context.get_found_words(), found_words);
 
 		board_solver.solve_board();
 
-		m_estimated_total_memory_used_for_solver = board_solver.estimate_total_memory_used();
-
-		m_dictionary_compact_trie->revert_runtime_changes();
-
 		output_message("finished solving board, found %d words",
-			static_cast<int>(found_words.size()));
+			static_cast<int>(context.get_found_words().count));
 
 		long long stopwatch_millis = std::chrono::duration_cast<std::chrono::milliseconds>(board_solver.get_time_spent_solving()).count();
 		long long stopwatch_micros = std::chrono::duration_cast<std::chrono::microseconds>(board_solver.get_time_spent_solving()).count();
@@ -417,6 +348,27 @@ bool c_boggle::solve_board(
 		output_message("\ttotal time spent solving: %" PRId64 "ms (%" PRId64 "us)",
 			stopwatch_millis, stopwatch_micros);
 
+#if BOGGLE_SOLVER_STATS
+		m_last_solve_stats = board_solver.get_stats();
+
+		auto& totals = m_last_solve_stats.totals;
+		output_message("\tnodes entered: %" PRIu64 ", neighbor probes: %" PRIu64 ", trie child lookups: %" PRIu64 " hits %" PRIu64 " misses, qu probes: %" PRIu64 ", max depth: %u",
+			totals.nodes_entered,
+			totals.neighbor_probes,
+			totals.trie_child_lookup_hits, totals.trie_child_lookup_misses,
+			totals.qu_probes,
+			totals.max_depth);
+		for (size_t thread_index = 0; thread_index < m_last_solve_stats.threads.size(); thread_index++)
+		{
+			auto& thread_stats = m_last_solve_stats.threads[thread_index];
+			output_message("\tthread #%d: %u roots, busy %" PRId64 "us, idle %" PRId64 "us",
+				static_cast<int>(thread_index),
+				thread_stats.roots_solved,
+				static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(thread_stats.busy_time).count()),
+				static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(thread_stats.idle_time).count()));
+		}
+#endif
+
 		success = true;
 	} while (false);
 
@@ -424,6 +376,24 @@ bool c_boggle::solve_board(
 	return success;
 }
 
+bool c_boggle::solve_board(
+	std::vector<std::string>& found_words,
+	const int board_width,
+	const int board_height,
+	const char* board_letters)
+{
+	return solve_board(*m_solve_context, &found_words, board_width, board_height, board_letters);
+}
+
+bool c_boggle::solve_board(
+	c_boggle_solve_context& context,
+	const int board_width,
+	const int board_height,
+	const char* board_letters)
+{
+	return solve_board(context, nullptr, board_width, board_height, board_letters);
+}
+
 std::vector<std::string> c_boggle::solve_board(
 	const int board_width,
 	const int board_height,
@@ -436,6 +406,139 @@ std::vector<std::string> c_boggle::solve_board(
 	return found_words;
 }
 
+bool c_boggle::solve_board_batch(
+	c_boggle_board_batch_reader& reader,
+	const board_batch_solved_callback_t& board_solved_callback,
+	const board_batch_progress_callback_t& progress_callback)
+{
+	// enough boards to keep every thread busy, few enough that results aren't held up for long
+	static const int k_boards_per_group = 1024;
+
+	if (m_currently_solving_board.load())
+	{
+		output_error("solve_board_batch called while we're already solving a board");
+		return false;
+	}
+
+	m_currently_solving_board.store(true);
+
+	// the dictionary may be replaced while we're solving, this keeps the one we started with alive
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary = get_resident_dictionary();
+	if (!resident_dictionary)
+	{
+		output_error("called solve_board_batch without first calling set_legal_words");
+		m_currently_solving_board.store(false);
+		return false;
+	}
+
+	const c_boggle_dictionary_compact_trie& dictionary_compact_trie = *resident_dictionary->get_dictionary_trie();
+	std::shared_ptr<c_boggle_dictionary_compact_trie_cache> filtered_dictionary_compact_trie_cache =
+		get_filtered_dictionary_trie_cache_for_solving(resident_dictionary);
+
+	// reused from group to group
+	std::vector<s_boggle_batch_board> boards(k_boards_per_group);
+	std::vector<s_boggle_found_words> boards_found_words(k_boards_per_group);
+
+	// and from batch to batch
+	while (m_board_batch_solve_contexts.size() < static_cast<size_t>(omp_get_max_threads()))
+		m_board_batch_solve_contexts.emplace_back(new c_boggle_solve_context);
+	for (auto& context : m_board_batch_solve_contexts)
+		context->set_word_length_limits(m_shortest_word_length, m_longest_word_length);
+
+	s_boggle_board_batch_progress progress = {};
+	progress.file_size = reader.get_file_size();
+
+	bool success = true;
+	for (;;)
+	{
+		int board_count = 0;
+		{
+			TRACE_SCOPE("read_board_group");
+
+			while (board_count < k_boards_per_group && reader.read_board(boards[board_count]))
+			{
+				board_count++;
+			}
+		}
+
+		if (board_count == 0)
+			break;
+
+		int failed_board_count = 0;
+
+		{
+			TRACE_SCOPE("solve_board_group", nullptr, static_cast<int64_t>(progress.boards_solved));
+
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:failed_board_count)
+			for (int board_index = 0; board_index < board_count; board_index++)
+			{
+				TRACE_SCOPE("solve_batch_board", nullptr, static_cast<int64_t>(progress.boards_solved + board_index));
+
+				auto& board = boards[board_index];
+				auto& found_words = boards_found_words[board_index];
+				auto& context = *m_board_batch_solve_contexts[omp_get_thread_num()];
+
+				if (!context.set_board(board.width, board.height, board.letters.c_str()))
+				{
+					failed_board_count++;
+					continue;
+				}
+
+				std::shared_ptr<const c_boggle_dictionary_compact_trie> filtered_dictionary_compact_trie;
+				if (filtered_dictionary_compact_trie_cache)
+				{
+					filtered_dictionary_compact_trie =
+						filtered_dictionary_compact_trie_cache->get_or_build(context.get_grid().get_occuring_grid_chars_flags());
+					if (!filtered_dictionary_compact_trie)
+					{
+						failed_board_count++;
+						continue;
+					}
+				}
+
+				// each board's solver runs its root chars on this thread, as we're already in a parallel region
+				c_trie_boggle_board_solver board_solver(
+					filtered_dictionary_compact_trie ? *filtered_dictionary_compact_trie : dictionary_compact_trie,
+					context, found_words);
+
+				board_solver.solve_board();
+			}
+		}
+
+		if (failed_board_count > 0)
+		{
+			output_error("solve_board_batch couldn't use the letters of, or build a trie for, %d boards",
+				failed_board_count);
+			success = false;
+			break;
+		}
+
+		TRACE_SCOPE("report_board_group");
+
+		for (int board_index = 0; board_index < board_count; board_index++)
+		{
+			if (board_solved_callback)
+				board_solved_callback(boards[board_index], boards_found_words[board_index]);
+			progress.words_found += boards_found_words[board_index].count;
+		}
+
+		progress.boards_solved += board_count;
+		progress.bytes_read = reader.get_bytes_read();
+		if (progress_callback)
+			progress_callback(progress);
+	}
+
+	if (reader.has_failed())
+	{
+		output_error("solve_board_batch stopped after %" PRIu64 " boards, failed to read the next one",
+			progress.boards_solved);
+		success = false;
+	}
+
+	m_currently_solving_board.store(false);
+	return success;
+}
+
 void c_boggle::set_filter_dictionary_with_occuring_grid_chars(
 	const bool filter)
 {
@@ -448,3 +551,51 @@ void c_boggle::set_filter_dictionary_with_occuring_grid_chars(
 	m_filter_dictionary_with_occuring_grid_chars = filter;
 }
 
+bool c_boggle::set_word_length_limits(
+	const uint32_t shortest_word_length,
+	const uint32_t longest_word_length)
+{
+	if (m_currently_solving_board.load())
+	{
+		output_error("set_word_length_limits called while we're already solving a board");
+		return false;
+	}
+
+	if (!m_solve_context->set_word_length_limits(shortest_word_length, longest_word_length))
+		return false;
+
+	m_shortest_word_length = shortest_word_length;
+	m_longest_word_length = longest_word_length;
+	return true;
+}
+
+void c_boggle::set_verify_binary_legal_words_checksums(
+	const bool verify)
+{
+	m_verify_binary_legal_words_checksums = verify;
+}
+
+void c_boggle::set_load_trie_only_dictionary(
+	const bool trie_only)
+{
+	m_load_trie_only_dictionary = trie_only;
+}
+
+std::shared_ptr<const c_boggle_dictionary_compact_trie_cache> c_boggle::get_filtered_dictionary_trie_cache() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_filtered_dictionary_compact_trie_cache;
+}
+
+void c_boggle::set_filtered_dictionary_trie_cache_memory_budget(
+	const size_t memory_budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_filtered_dictionary_compact_trie_cache_memory_budget = memory_budget;
+
+	if (m_filtered_dictionary_compact_trie_cache)
+		m_filtered_dictionary_compact_trie_cache->set_memory_budget(memory_budget);
+}
+
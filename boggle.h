@@ -1,14 +1,34 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-struct _iobuf;
+#include <boggle_solver_stats.h>
+#include <tracked_memory.h>
 
+struct s_boggle_batch_board;
+struct s_boggle_found_words;
+class c_boggle_board_batch_reader;
 class c_boggle_dictionary;
 class c_boggle_dictionary_compact_trie;
+class c_boggle_dictionary_compact_trie_cache;
 class c_boggle_grid;
+class c_boggle_resident_dictionary;
+class c_boggle_solve_context;
+
+struct s_boggle_board_batch_progress
+{
+	uint64_t boards_solved;
+	uint64_t words_found;
+	// of the board batch file
+	uint64_t bytes_read;
+	uint64_t file_size;
+};
 
 // Solves a boggle board using a trie representation of legal ASCII words.
 // Given that dictionaries don't often change, the internals support
@@ -17,38 +37,65 @@ class c_boggle_grid;
 
 class c_boggle
 {
-	c_boggle_dictionary* m_dictionary;
-	c_boggle_dictionary_compact_trie* m_dictionary_compact_trie;
+	// the dictionary and its full trie, possibly shared with other c_boggle instances. Solves take
+	// their own reference, so a new dictionary can be published while a board is still being
+	// solved with the old one
+	std::shared_ptr<const c_boggle_resident_dictionary> m_resident_dictionary;
+	// guards m_resident_dictionary and m_filtered_dictionary_compact_trie_cache, which are only
+	// ever copied or swapped under it, as other threads may be publishing or holding on to them
+	mutable std::mutex m_mutex;
+	// filtered tries of the resident dictionary, keyed by the grid chars occurring on the boards
+	// they were built for. Shared by solve_board and solve_board_batch
+	std::shared_ptr<c_boggle_dictionary_compact_trie_cache> m_filtered_dictionary_compact_trie_cache;
+	size_t m_filtered_dictionary_compact_trie_cache_memory_budget;
 	std::atomic_bool m_currently_solving_board;
 	// should we filter our view of the dictionary using only words
 	// that contain only characters that also appear on input grids?
+	// #NOTE the solver already prunes trie subtrees whose words can't be made from the
+	// grid chars on the board, so this only buys a smaller trie at the cost of a rebuild
 	bool m_filter_dictionary_with_occuring_grid_chars;
+	// should loading binary legal words verify the checksum of every section?
+	bool m_verify_binary_legal_words_checksums;
+	// should loading binary legal words skip the word strings, naming found words from the trie instead?
+	bool m_load_trie_only_dictionary;
+	// the word length limits of solves with our own contexts, see set_word_length_limits
+	uint32_t m_shortest_word_length;
+	uint32_t m_longest_word_length;
+	// for solve_board calls which aren't given a context
+	std::unique_ptr<c_boggle_solve_context> m_solve_context;
+	// for solve_board_batch, indexed by OpenMP thread number
+	std::vector<std::unique_ptr<c_boggle_solve_context>> m_board_batch_solve_contexts;
 
-public:
-	size_t m_estimated_total_memory_used_for_dictionary_trie;
-	size_t m_estimated_total_memory_used_for_dictionary_compact_trie;
-	size_t m_estimated_total_memory_used_for_grid;
-	size_t m_estimated_total_memory_used_for_solver;
+	// from the last solve_board, see get_last_solve_stats
+	s_boggle_solver_stats m_last_solve_stats;
 
-private:
-	void deallocate_dictionary();
+	// the cache of filtered tries built from the resident dictionary, replacing the cache of any
+	// previous dictionary. Returns nullptr if the dictionary isn't to be filtered
+	std::shared_ptr<c_boggle_dictionary_compact_trie_cache> get_filtered_dictionary_trie_cache_for_solving(
+		const std::shared_ptr<const c_boggle_resident_dictionary>& resident_dictionary);
 
-	void deallocate_dictionary_trie();
-
-	bool build_dictionary_trie(
-		// really a boggle_grid_char_flags_t, but not trying to force
-		// the more private headers to get included just to satisfy private APIs
-		const uint32_t occuring_grid_chars_flags);
-
-	bool build_dictionary_trie(
+	// the trie to solve the grid with, either the resident dictionary's own or a filtered one
+	// built from it. Returns nullptr on failure
+	std::shared_ptr<const c_boggle_dictionary_compact_trie> get_dictionary_trie_for_solving(
+		const std::shared_ptr<const c_boggle_resident_dictionary>& resident_dictionary,
 		const c_boggle_grid& grid);
 
+	// solves already in flight keep using the previous dictionary, which is freed once the last
+	// of them finishes. Drops the filtered tries of the previous dictionary
+	void publish_resident_dictionary(
+		std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary);
+
 	bool load_binary_legal_words(
-		_iobuf* file,
-		const char* filename);
-	bool save_binary_legal_words(
-		_iobuf* file,
-		const char* filename);
+		const char* filename,
+		const bool map_file);
+
+	// found_words may be null, leaving the found words in the context only
+	bool solve_board(
+		c_boggle_solve_context& context,
+		std::vector<std::string>* found_words,
+		const int board_width,
+		const int board_height,
+		const char* board_letters);
 
 public:
 	c_boggle();
@@ -57,17 +104,44 @@ public:
 	// prior to solving any board, configure the legal words
 	// #NOTE given that this is a public API and I can't guarantee the lifetime of all_words
 	// we build our own private representation of all_words (c_boggle_dictionary)
+	// #NOTE this and the other legal words setters may be called while another thread is solving
+	// a board. The new dictionary is built first and only then replaces the old one, which
+	// stays in place if building or loading fails
 	void set_legal_words_from_alphabetically_sorted_array(
 		// alphabetically-sorted array of legal words
 		const std::vector<std::string>& all_words);
 
+	// reads the legal words from a text file, one word per line. Much faster than reading them
+	// into an array for set_legal_words_from_alphabetically_sorted_array, as the file is decoded,
+	// sorted and deduplicated in parallel
+	bool load_text_legal_words(
+		const char* filename);
+
 	// try and load the optimized representation of legal words from an existing binary file
 	bool load_binary_legal_words(
 		const char* filename);
+	// like load_binary_legal_words, but the file is mapped and used in place instead of being
+	// copied. Start-up is much faster, and the pages are shared with other processes mapping the file
+	bool map_binary_legal_words(
+		const char* filename);
 	// save the optimized representation of legal words to a binary file
 	bool save_binary_legal_words(
 		const char* filename);
 
+	// builds or loads a new dictionary on another thread with create_resident_dictionary, then
+	// publishes it as the legal words setters do. Boards can be solved with the current dictionary
+	// meanwhile. The future is true once the new dictionary is in place, false if it couldn't be created
+	// #NOTE the future must be waited on or destroyed before this c_boggle is
+	std::future<bool> replace_resident_dictionary_in_background(
+		std::function<std::shared_ptr<const c_boggle_resident_dictionary>()> create_resident_dictionary);
+	// load_text_legal_words on another thread, see replace_resident_dictionary_in_background
+	std::future<bool> load_text_legal_words_in_background(
+		const char* filename);
+	// map_binary_legal_words on another thread, with the binary legal words options in place when
+	// this is called, see replace_resident_dictionary_in_background
+	std::future<bool> map_binary_legal_words_in_background(
+		const char* filename);
+
 	// find all words on the specified board, returning a list of them
 	bool solve_board(
 		std::vector<std::string>& found_words,
@@ -87,14 +161,60 @@ public:
 		// board_width*board_height characters in row major order
 		const char* board_letters);
 
-	const c_boggle_dictionary* get_dictionary() const
+	// find all words on the specified board, leaving them in context.get_found_words(). Solving
+	// successive boards with the same context reuses its memory, so once it has grown to fit the
+	// largest board solving doesn't allocate
+	bool solve_board(
+		c_boggle_solve_context& context,
+		// width of the board, e.g. 4 for a retail Boggle game
+		const int board_width,
+		// height of the board, e.g. 4 for a retail Boggle game
+		const int board_height,
+		// board_width*board_height characters in row major order
+		const char* board_letters);
+
+	typedef std::function<void(const s_boggle_batch_board& board, const s_boggle_found_words& found_words)>
+		board_batch_solved_callback_t;
+	typedef std::function<void(const s_boggle_board_batch_progress& progress)>
+		board_batch_progress_callback_t;
+
+	// find all words on every board the reader gives us. Boards are solved in groups, spread
+	// across threads a board at a time rather than a root char at a time, which suits many
+	// small boards. board_solved_callback (if any) is called in the order the boards were read,
+	// with the found words left as a bit vector (see c_boggle_result_writer), and
+	// progress_callback (if any) after each group
+	// #NOTE when filtering the dictionary with occurring grid chars, each board is solved with a
+	// filtered trie from the same cache as solve_board, so boards with the same letters share one
+	bool solve_board_batch(
+		c_boggle_board_batch_reader& reader,
+		const board_batch_solved_callback_t& board_solved_callback,
+		const board_batch_progress_callback_t& progress_callback = nullptr);
+
+	// use a dictionary which may also be in use by other c_boggle instances, e.g. one from a
+	// c_boggle_dictionary_registry
+	void set_resident_dictionary(
+		std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary);
+
+	std::shared_ptr<const c_boggle_resident_dictionary> get_resident_dictionary() const;
+
+	// only valid until the dictionary is replaced, use get_resident_dictionary to hold on to it
+	const c_boggle_dictionary* get_dictionary() const;
+
+	const c_boggle_dictionary_compact_trie* get_dictionary_trie() const;
+
+	// what the solver did during the last solve_board. Only filled in when built with BOGGLE_SOLVER_STATS
+	const s_boggle_solver_stats& get_last_solve_stats() const
 	{
-		return m_dictionary;
+		return m_last_solve_stats;
 	}
 
-	const c_boggle_dictionary_compact_trie* get_dictionary_trie() const
+	// the memory allocated for a subsystem, measured across every c_boggle instance in the
+	// process. Mapped binary dictionaries aren't counted, as their pages belong to the file
+	static void get_memory_stats(
+		const e_memory_tag tag,
+		s_memory_tag_stats& out_stats)
 	{
-		return m_dictionary_compact_trie;
+		get_memory_tag_stats(tag, out_stats);
 	}
 
 	bool is_filtering_dictionary_with_occuring_grid_chars() const
@@ -102,8 +222,54 @@ public:
 		return m_filter_dictionary_with_occuring_grid_chars;
 	}
 
+	bool is_verifying_binary_legal_words_checksums() const
+	{
+		return m_verify_binary_legal_words_checksums;
+	}
+
+	// verifying means reading the whole file up front, which hot loads of a mapped file may want to skip
+	void set_verify_binary_legal_words_checksums(
+		const bool verify);
+
+	bool is_loading_trie_only_dictionary() const
+	{
+		return m_load_trie_only_dictionary;
+	}
+
+	// Binary legal words loaded after this skip the dictionary's string pool and words, which cuts
+	// resident memory for large dictionaries. Found words are then named from the paths taken
+	// through the trie. Such a dictionary can't be filtered with occurring grid chars, or saved
+	void set_load_trie_only_dictionary(
+		const bool trie_only);
+
+	uint32_t get_shortest_word_length() const
+	{
+		return m_shortest_word_length;
+	}
+
+	uint32_t get_longest_word_length() const
+	{
+		return m_longest_word_length;
+	}
+
+	// only find words of shortest_word_length to longest_word_length chars in solve_board calls
+	// which aren't given a context, and solve_board_batch, see
+	// c_boggle_solve_context::set_word_length_limits. Contexts passed to solve_board keep their own
+	bool set_word_length_limits(
+		const uint32_t shortest_word_length,
+		const uint32_t longest_word_length);
+
 	// filter won't actually be respected until the next time solve_board is called
 	void set_filter_dictionary_with_occuring_grid_chars(
 		const bool filter);
+
+	// cache of filtered tries, only allocated once filtering is used with the current dictionary,
+	// else nullptr. The cache is safe to query from other threads, and stays valid while shared,
+	// even once a solve with a new dictionary has replaced it
+	std::shared_ptr<const c_boggle_dictionary_compact_trie_cache> get_filtered_dictionary_trie_cache() const;
+
+	// how many bytes of filtered tries to keep around for boards whose grid chars we've seen before
+	void set_filtered_dictionary_trie_cache_memory_budget(
+		const size_t memory_budget);
 };
 
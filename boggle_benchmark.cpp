@@ -0,0 +1,506 @@
+#include <precompile.h>
+#include <boggle_benchmark.h>
+
+#include <ransampl.h>
+
+#include <boggle_dictionary.h>
+#include <boggle_dictionary_compact_trie.h>
+#include <boggle_dictionary_compact_trie_cache.h>
+#include <boggle_found_words.h>
+#include <boggle_grid.h>
+#include <boggle_grid_char.h>
+#include <boggle_resident_dictionary.h>
+#include <boggle_solve_context.h>
+#include <boggle_solver_stats.h>
+#include <trie_boggle_board_solver.h>
+#include <utilities.h>
+
+static const std::array<int, 5> k_boggle_benchmark_board_sizes = { {
+	4, 5, 10, 100, 255,
+} };
+
+static const std::array<const char*, 2> k_boggle_benchmark_dictionary_filenames = { {
+	R"(data\10x10_Dictionary.txt)",
+	R"(data\english.txt)",
+} };
+
+// the trie-only engine needs its dictionary loaded from a binary file, which is written here
+static const char* k_boggle_benchmark_trie_only_dictionary_filename =
+	R"(boggle_benchmark_trie_only.boggle_dictionary)";
+
+struct s_boggle_benchmark_dictionary
+{
+	const char* filename;
+	std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary;
+	// nullptr when the dictionary couldn't be saved and loaded back trie-only
+	std::shared_ptr<const c_boggle_resident_dictionary> trie_only_resident_dictionary;
+	std::unique_ptr<c_boggle_dictionary_compact_trie_cache> filtered_dictionary_compact_trie_cache;
+};
+
+struct s_boggle_benchmark_trial_result
+{
+	double seconds;
+	int64_t nodes_visited;
+	int64_t words_found;
+};
+
+struct s_boggle_benchmark_result
+{
+	const char* dictionary_filename;
+	uint32_t dictionary_words_count;
+	e_boggle_benchmark_engine engine;
+	int board_width;
+	int board_height;
+	int thread_count;
+	int boards_per_trial;
+	int trials;
+	double median_seconds;
+	double p99_seconds;
+	double boards_per_second;
+	double nodes_per_second;
+	// the same every trial, as every trial solves the same boards
+	int64_t nodes_visited_per_trial;
+	int64_t words_found_per_trial;
+};
+
+const char* boggle_benchmark_engine_to_string(
+	const e_boggle_benchmark_engine engine)
+{
+	switch (engine)
+	{
+	case _boggle_benchmark_engine_root_char_threads:	return "root_char_threads";
+	case _boggle_benchmark_engine_board_per_thread:		return "board_per_thread";
+	case _boggle_benchmark_engine_filtered_trie:		return "filtered_trie";
+	case _boggle_benchmark_engine_trie_only:			return "trie_only";
+	default:
+		return "unknown";
+	}
+}
+
+void get_default_boggle_benchmark_options(
+	s_boggle_benchmark_options& out_options)
+{
+	out_options.seed = 0x626f6767; // 'bogg'
+	out_options.warm_up_trials = 2;
+	out_options.trials = 10;
+	out_options.cells_per_trial = 100 * 100;
+	out_options.report_filename = "boggle_benchmark.json";
+}
+
+void generate_random_boggle_board(
+	const int board_width,
+	const int board_height,
+	std::default_random_engine& generator,
+	std::string& board_letters)
+{
+	int board_cell_count = board_width * board_height;
+	board_letters.clear();
+	board_letters.reserve(board_cell_count + 1);
+
+	ransampl_ws* ws = ransampl_alloc(static_cast<int>(k_boggle_grid_char_frequencies.size()));
+	ransampl_set(ws, k_boggle_grid_char_frequencies.data());
+
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+	for (int x = 0; x < board_cell_count; x++)
+	{
+		double ran1 = distribution(generator);
+		double ran2 = distribution(generator);
+
+		int freq_index = ransampl_draw(ws, ran1, ran2);
+		auto grid_char = static_cast<boggle_grid_char_t>(freq_index);
+		board_letters.push_back( boggle_grid_char_to_string(grid_char)[0] );
+	}
+
+	ransampl_free(ws);
+}
+
+static bool load_boggle_benchmark_dictionary(
+	s_boggle_benchmark_dictionary& dictionary)
+{
+	output_message("benchmark loading dictionary %s...",
+		dictionary.filename);
+
+	dictionary.resident_dictionary = c_boggle_resident_dictionary::create_from_text_file(dictionary.filename);
+	if (!dictionary.resident_dictionary)
+		return false;
+
+	dictionary.filtered_dictionary_compact_trie_cache.reset(new c_boggle_dictionary_compact_trie_cache(
+		dictionary.resident_dictionary));
+
+	s_boggle_resident_dictionary_binary_file_options options;
+	options.map_file = false;
+	options.verify_checksums = true;
+	options.trie_only = true;
+
+	if (dictionary.resident_dictionary->save_binary_file(k_boggle_benchmark_trie_only_dictionary_filename))
+	{
+		dictionary.trie_only_resident_dictionary = c_boggle_resident_dictionary::create_from_binary_file(
+			k_boggle_benchmark_trie_only_dictionary_filename, options);
+		remove(k_boggle_benchmark_trie_only_dictionary_filename);
+	}
+
+	if (!dictionary.trie_only_resident_dictionary)
+	{
+		output_message("benchmark couldn't load %s trie-only, skipping the trie_only engine for it",
+			dictionary.filename);
+	}
+
+	return true;
+}
+
+// solves every board once, returning false if a board's letters couldn't be used
+static bool run_boggle_benchmark_trial(
+	s_boggle_benchmark_dictionary& dictionary,
+	const e_boggle_benchmark_engine engine,
+	const int board_width,
+	const int board_height,
+	const std::vector<std::string>& boards_letters,
+	std::vector<s_boggle_found_words>& boards_found_words,
+	// indexed by OpenMP thread number
+	std::vector<std::unique_ptr<c_boggle_solve_context>>& threads_contexts,
+	s_boggle_benchmark_trial_result& out_result)
+{
+	const c_boggle_resident_dictionary& resident_dictionary = engine == _boggle_benchmark_engine_trie_only
+		? *dictionary.trie_only_resident_dictionary
+		: *dictionary.resident_dictionary;
+	const c_boggle_dictionary_compact_trie& dictionary_compact_trie = *resident_dictionary.get_dictionary_trie();
+
+	int board_count = static_cast<int>(boards_letters.size());
+	int failed_board_count = 0;
+	int64_t nodes_visited = 0;
+	int64_t words_found = 0;
+
+	auto start_time = std::chrono::high_resolution_clock::now();
+
+	if (engine == _boggle_benchmark_engine_board_per_thread)
+	{
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:failed_board_count, nodes_visited, words_found)
+		for (int board_index = 0; board_index < board_count; board_index++)
+		{
+			auto& context = *threads_contexts[omp_get_thread_num()];
+			if (!context.set_board(board_width, board_height, boards_letters[board_index].c_str()))
+			{
+				failed_board_count++;
+				continue;
+			}
+
+			// each board's solver runs its root chars on this thread, as we're already in a parallel region
+			c_trie_boggle_board_solver board_solver(
+				dictionary_compact_trie, context, boards_found_words[board_index]);
+
+			board_solver.solve_board();
+
+#if BOGGLE_SOLVER_STATS
+			nodes_visited += board_solver.get_stats().totals.nodes_entered;
+#endif
+			words_found += boards_found_words[board_index].count;
+		}
+	}
+	else
+	{
+		auto& context = *threads_contexts[0];
+		for (int board_index = 0; board_index < board_count; board_index++)
+		{
+			if (!context.set_board(board_width, board_height, boards_letters[board_index].c_str()))
+			{
+				failed_board_count++;
+				continue;
+			}
+			const c_boggle_grid& grid = context.get_grid();
+
+			std::shared_ptr<const c_boggle_dictionary_compact_trie> filtered_dictionary_compact_trie;
+			if (engine == _boggle_benchmark_engine_filtered_trie)
+			{
+				filtered_dictionary_compact_trie =
+					dictionary.filtered_dictionary_compact_trie_cache->get_or_build(grid.get_occuring_grid_chars_flags());
+				if (!filtered_dictionary_compact_trie)
+				{
+					failed_board_count++;
+					continue;
+				}
+			}
+
+			c_trie_boggle_board_solver board_solver(
+				filtered_dictionary_compact_trie ? *filtered_dictionary_compact_trie : dictionary_compact_trie,
+				context, boards_found_words[board_index]);
+
+			board_solver.solve_board();
+
+#if BOGGLE_SOLVER_STATS
+			nodes_visited += board_solver.get_stats().totals.nodes_entered;
+#endif
+			words_found += boards_found_words[board_index].count;
+		}
+	}
+
+	auto end_time = std::chrono::high_resolution_clock::now();
+
+	out_result.seconds = std::chrono::duration<double>(end_time - start_time).count();
+	out_result.nodes_visited = nodes_visited;
+	out_result.words_found = words_found;
+
+	return failed_board_count == 0;
+}
+
+static bool run_boggle_benchmark(
+	const s_boggle_benchmark_options& options,
+	s_boggle_benchmark_dictionary& dictionary,
+	const e_boggle_benchmark_engine engine,
+	const int board_width,
+	const int board_height,
+	const int thread_count,
+	const std::vector<std::string>& boards_letters,
+	s_boggle_benchmark_result& out_result)
+{
+	int previous_thread_count = omp_get_max_threads();
+	omp_set_num_threads(thread_count);
+
+	// reused from trial to trial, as a batch solve would
+	std::vector<s_boggle_found_words> boards_found_words(boards_letters.size());
+	std::vector<std::unique_ptr<c_boggle_solve_context>> threads_contexts(thread_count);
+	for (auto& context : threads_contexts)
+	{
+		context.reset(new c_boggle_solve_context);
+	}
+	std::vector<s_boggle_benchmark_trial_result> trial_results(options.trials);
+
+	bool success = true;
+	for (int trial_index = -options.warm_up_trials; success && trial_index < options.trials; trial_index++)
+	{
+		s_boggle_benchmark_trial_result trial_result;
+		success = run_boggle_benchmark_trial(dictionary, engine, board_width, board_height,
+			boards_letters, boards_found_words, threads_contexts, trial_result);
+
+		if (trial_index >= 0)
+			trial_results[trial_index] = trial_result;
+	}
+
+	omp_set_num_threads(previous_thread_count);
+
+	if (!success)
+	{
+		output_error("benchmark couldn't solve the %d by %d boards",
+			board_width, board_height);
+		return false;
+	}
+
+	std::vector<double> trial_seconds;
+	trial_seconds.reserve(trial_results.size());
+	for (auto& trial_result : trial_results)
+	{
+		trial_seconds.push_back(trial_result.seconds);
+	}
+	std::sort(trial_seconds.begin(), trial_seconds.end());
+
+	size_t trial_count = trial_seconds.size();
+	// nearest rank
+	size_t p99_index = ((trial_count * 99) + 99) / 100 - 1;
+
+	out_result.dictionary_filename = dictionary.filename;
+	out_result.dictionary_words_count = dictionary.resident_dictionary->get_dictionary()->get_words_count();
+	out_result.engine = engine;
+	out_result.board_width = board_width;
+	out_result.board_height = board_height;
+	out_result.thread_count = thread_count;
+	out_result.boards_per_trial = static_cast<int>(boards_letters.size());
+	out_result.trials = options.trials;
+	out_result.median_seconds = (trial_count % 2) != 0
+		? trial_seconds[trial_count / 2]
+		: (trial_seconds[(trial_count / 2) - 1] + trial_seconds[trial_count / 2]) / 2.0;
+	out_result.p99_seconds = trial_seconds[std::min(p99_index, trial_count - 1)];
+	out_result.nodes_visited_per_trial = trial_results[0].nodes_visited;
+	out_result.words_found_per_trial = trial_results[0].words_found;
+	out_result.boards_per_second = out_result.median_seconds > 0.0
+		? out_result.boards_per_trial / out_result.median_seconds
+		: 0.0;
+	out_result.nodes_per_second = out_result.median_seconds > 0.0
+		? out_result.nodes_visited_per_trial / out_result.median_seconds
+		: 0.0;
+
+	output_message("\t%s %s %dx%d %d threads: median %.3fms, p99 %.3fms, %.0f boards/s",
+		dictionary.filename,
+		boggle_benchmark_engine_to_string(engine),
+		board_width, board_height,
+		thread_count,
+		out_result.median_seconds * 1000.0,
+		out_result.p99_seconds * 1000.0,
+		out_result.boards_per_second);
+
+	return true;
+}
+
+// backslashes in the filenames are the only thing we write which needs escaping
+static void write_boggle_benchmark_json_string(
+	FILE* file,
+	const char* string)
+{
+	fputc('"', file);
+	for (; *string != '\0'; string++)
+	{
+		if (*string == '\\' || *string == '"')
+			fputc('\\', file);
+		fputc(*string, file);
+	}
+	fputc('"', file);
+}
+
+static bool write_boggle_benchmark_report(
+	const s_boggle_benchmark_options& options,
+	const std::vector<s_boggle_benchmark_result>& results)
+{
+	FILE* file;
+	if (fopen_s(&file, options.report_filename, "w") != 0)
+	{
+		output_error("failed to open/create benchmark report: %s",
+			options.report_filename);
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"seed\": %u,\n", options.seed);
+	fprintf(file, "\t\"warm_up_trials\": %d,\n", options.warm_up_trials);
+	fprintf(file, "\t\"trials\": %d,\n", options.trials);
+	fprintf(file, "\t\"processors\": %d,\n", omp_get_num_procs());
+	fprintf(file, "\t\"pointer_size\": %d,\n", static_cast<int>(sizeof(void*)));
+	fprintf(file, "\t\"debug\": %s,\n",
+#if _DEBUG
+		"true");
+#else
+		"false");
+#endif
+	fprintf(file, "\t\"extended_alphabet\": %s,\n",
+		BOGGLE_GRID_CHAR_EXTENDED_ALPHABET ? "true" : "false");
+	// without solver stats nodes aren't counted, so the results leave out nodes_visited_per_trial and
+	// nodes_per_second rather than report 0
+	fprintf(file, "\t\"solver_stats\": %s,\n",
+		BOGGLE_SOLVER_STATS ? "true" : "false");
+	fprintf(file, "\t\"interleaved_walks\": %d,\n",
+		BOGGLE_SOLVER_INTERLEAVED_WALKS);
+	fprintf(file, "\t\"prefetch_child_nodes\": %s,\n",
+		BOGGLE_SOLVER_PREFETCH_CHILD_NODES ? "true" : "false");
+	fprintf(file, "\t\"results\": [");
+
+	for (size_t result_index = 0; result_index < results.size(); result_index++)
+	{
+		auto& result = results[result_index];
+
+		fprintf(file, "%s\n\t\t{\"dictionary\": ", result_index > 0 ? "," : "");
+		write_boggle_benchmark_json_string(file, result.dictionary_filename);
+		fprintf(file, ", \"dictionary_words\": %u, \"engine\": \"%s\", \"board_width\": %d, \"board_height\": %d, \"threads\": %d"
+			", \"boards_per_trial\": %d, \"trials\": %d, \"median_seconds\": %.9f, \"p99_seconds\": %.9f"
+			", \"boards_per_second\": %.3f, \"words_found_per_trial\": %" PRId64,
+			result.dictionary_words_count,
+			boggle_benchmark_engine_to_string(result.engine),
+			result.board_width, result.board_height,
+			result.thread_count,
+			result.boards_per_trial,
+			result.trials,
+			result.median_seconds,
+			result.p99_seconds,
+			result.boards_per_second,
+			result.words_found_per_trial);
+#if BOGGLE_SOLVER_STATS
+		fprintf(file, ", \"nodes_visited_per_trial\": %" PRId64 ", \"nodes_per_second\": %.3f",
+			result.nodes_visited_per_trial,
+			result.nodes_per_second);
+#endif
+		fprintf(file, "}");
+	}
+
+	fprintf(file, "\n\t]\n}\n");
+
+	bool success = ferror(file) == 0;
+	success = fclose(file) == 0 && success;
+
+	if (!success)
+	{
+		output_error("failed to write benchmark report: %s",
+			options.report_filename);
+	}
+
+	return success;
+}
+
+bool run_boggle_benchmarks(
+	const s_boggle_benchmark_options& options)
+{
+	if (options.trials <= 0 || options.warm_up_trials < 0 || options.cells_per_trial <= 0 ||
+		!options.report_filename)
+	{
+		output_error("run_boggle_benchmarks called with invalid trial counts or no report filename");
+		return false;
+	}
+
+#if !BOGGLE_SOLVER_STATS
+	output_message("benchmark won't count nodes visited, that needs a build with BOGGLE_SOLVER_STATS 1");
+#endif
+
+	// 1, 2, 4... then every processor
+	std::vector<int> thread_counts;
+	int processor_count = omp_get_num_procs();
+	for (int thread_count = 1; thread_count < processor_count; thread_count *= 2)
+	{
+		thread_counts.push_back(thread_count);
+	}
+	thread_counts.push_back(processor_count);
+
+	// generated up front and in a fixed order, so they don't depend on which dictionaries loaded
+	std::vector<std::vector<std::string>> boards_letters_by_size(k_boggle_benchmark_board_sizes.size());
+	std::default_random_engine generator(options.seed);
+	for (size_t size_index = 0; size_index < k_boggle_benchmark_board_sizes.size(); size_index++)
+	{
+		int board_size = k_boggle_benchmark_board_sizes[size_index];
+		int boards_per_trial = std::max(options.cells_per_trial / (board_size * board_size), 1);
+
+		boards_letters_by_size[size_index].resize(boards_per_trial);
+		for (auto& board_letters : boards_letters_by_size[size_index])
+		{
+			generate_random_boggle_board(board_size, board_size, generator, board_letters);
+		}
+	}
+
+	std::vector<s_boggle_benchmark_result> results;
+
+	for (const char* dictionary_filename : k_boggle_benchmark_dictionary_filenames)
+	{
+		s_boggle_benchmark_dictionary dictionary;
+		dictionary.filename = dictionary_filename;
+		if (!load_boggle_benchmark_dictionary(dictionary))
+		{
+			output_error("benchmark skipping dictionary %s, failed to load it",
+				dictionary_filename);
+			continue;
+		}
+
+		for (int engine = 0; engine < k_number_of_boggle_benchmark_engines; engine++)
+		{
+			if (engine == _boggle_benchmark_engine_trie_only && !dictionary.trie_only_resident_dictionary)
+				continue;
+
+			for (size_t size_index = 0; size_index < k_boggle_benchmark_board_sizes.size(); size_index++)
+			{
+				for (int thread_count : thread_counts)
+				{
+					s_boggle_benchmark_result result;
+					if (run_boggle_benchmark(options, dictionary, static_cast<e_boggle_benchmark_engine>(engine),
+						k_boggle_benchmark_board_sizes[size_index], k_boggle_benchmark_board_sizes[size_index],
+						thread_count,
+						boards_letters_by_size[size_index],
+						result))
+					{
+						results.push_back(result);
+					}
+				}
+			}
+		}
+	}
+
+	if (results.empty())
+	{
+		output_error("no benchmarks could be run");
+		return false;
+	}
+
+	return write_boggle_benchmark_report(options, results);
+}
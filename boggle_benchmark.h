@@ -0,0 +1,55 @@
+#pragma once
+
+#include <inttypes.h>
+#include <random>
+#include <string>
+
+// Solves the same randomly generated boards over a sweep of board sizes, dictionaries, thread
+// counts and engines, timing repeated trials of each, and reports the results as JSON so runs
+// from different builds can be compared. Nodes visited are only counted, and reported, when
+// built with BOGGLE_SOLVER_STATS.
+
+enum e_boggle_benchmark_engine
+{
+	// a board at a time, its root chars spread across threads, as c_boggle::solve_board does
+	_boggle_benchmark_engine_root_char_threads,
+	// boards spread across threads and each solved on one, as c_boggle::solve_board_batch does
+	_boggle_benchmark_engine_board_per_thread,
+	// like root char threads, but with a trie filtered to the grid chars on each board
+	_boggle_benchmark_engine_filtered_trie,
+	// like root char threads, but with a trie-only dictionary, so found words are named from paths
+	_boggle_benchmark_engine_trie_only,
+
+	k_number_of_boggle_benchmark_engines
+};
+
+struct s_boggle_benchmark_options
+{
+	// the boards are generated from this, so every run solves the same boards
+	uint32_t seed;
+	// untimed trials run before the timed ones, to fill caches and fault in pages
+	int warm_up_trials;
+	int trials;
+	// each trial solves as many boards as it takes to make up about this many cells, so small
+	// boards aren't timed on a handful of microseconds
+	int cells_per_trial;
+	const char* report_filename;
+};
+
+const char* boggle_benchmark_engine_to_string(
+	const e_boggle_benchmark_engine engine);
+
+void get_default_boggle_benchmark_options(
+	s_boggle_benchmark_options& out_options);
+
+// returns false if no benchmark could be run or the report couldn't be written. Dictionaries
+// which fail to load are skipped
+bool run_boggle_benchmarks(
+	const s_boggle_benchmark_options& options);
+
+// letters are drawn using k_boggle_grid_char_frequencies
+void generate_random_boggle_board(
+	const int board_width,
+	const int board_height,
+	std::default_random_engine& generator,
+	std::string& board_letters);
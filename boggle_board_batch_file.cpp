@@ -0,0 +1,360 @@
+#include <precompile.h>
+#include <boggle_board_batch_file.h>
+
+#include <boggle_grid.h>
+#include <utilities.h>
+
+static_assert(k_number_of_boggle_grid_characters <= (1 << k_boggle_board_batch_file_bits_per_grid_char),
+	"k_boggle_board_batch_file_bits_per_grid_char can't represent every grid char");
+
+static bool is_valid_boggle_batch_board_size(
+	const int width,
+	const int height)
+{
+	return width > 0 && height > 0
+		&& c_boggle_grid::is_valid_board_size(width, height);
+}
+
+
+c_boggle_board_batch_reader::c_boggle_board_batch_reader()
+	: m_file()
+	, m_format(_boggle_board_batch_file_format_text)
+	, m_position(0)
+	, m_failed(false)
+	, m_line()
+	, m_packed_grid_chars()
+{
+}
+
+bool c_boggle_board_batch_reader::open(
+	const char* filename)
+{
+	close();
+
+	if (!m_file.open(filename))
+	{
+		output_error("failed to open board batch file: %s",
+			filename);
+		return false;
+	}
+
+	auto header = reinterpret_cast<const s_boggle_board_batch_file_header*>(m_file.peek(sizeof(s_boggle_board_batch_file_header)));
+	if (header && header->signature == k_boggle_board_batch_file_signature)
+	{
+		if (header->version != k_boggle_board_batch_file_version)
+		{
+			output_error("board batch file has unsupported version %u: %s",
+				header->version,
+				filename);
+			close();
+			return false;
+		}
+
+		m_format = _boggle_board_batch_file_format_binary;
+
+		s_boggle_board_batch_file_header consumed_header;
+		m_file.read(consumed_header);
+	}
+	else
+	{
+		m_format = _boggle_board_batch_file_format_text;
+
+		size_t byte_order_marker_size = static_cast<size_t>(std::min<uint64_t>(m_file.get_file_size(), 4));
+		size_t text_offset;
+		if (!handle_byte_order_marker(m_file.peek(byte_order_marker_size), byte_order_marker_size, text_offset))
+		{
+			output_error("board batch file is not text or has unacceptable BOM: %s",
+				filename);
+			close();
+			return false;
+		}
+
+		uint8_t byte_order_marker[4];
+		m_file.read(byte_order_marker, text_offset);
+	}
+
+	return true;
+}
+
+void c_boggle_board_batch_reader::close()
+{
+	m_file.close();
+	m_format = _boggle_board_batch_file_format_text;
+	m_position = 0;
+	m_failed = false;
+}
+
+bool c_boggle_board_batch_reader::read_text_board(
+	s_boggle_batch_board& out_board)
+{
+	for (;;)
+	{
+		if (!m_file.read_line(m_line))
+			return false;
+
+		m_position++;
+
+		const char* cursor = m_line.c_str();
+		while (*cursor == ' ' || *cursor == '\t')
+			cursor++;
+
+		if (*cursor == '\0' || *cursor == '#')
+			continue;
+
+		char* width_end;
+		char* height_end;
+		long width = strtol(cursor, &width_end, 10);
+		long height = strtol(width_end, &height_end, 10);
+		if (width_end == cursor || height_end == width_end ||
+			!is_valid_boggle_batch_board_size(static_cast<int>(width), static_cast<int>(height)))
+		{
+			output_error("\tboard at line #%" PRIu64 " has a missing or invalid size",
+				m_position);
+			m_failed = true;
+			return false;
+		}
+
+		out_board.width = static_cast<int>(width);
+		out_board.height = static_cast<int>(height);
+		out_board.letters.clear();
+
+		cursor = height_end;
+		char character;
+		for (size_t sequence_length; (sequence_length = boggle_grid_char_character_from_utf8(cursor, character)) != 0; cursor += sequence_length)
+		{
+			if (character == ' ' || character == '\t')
+				continue;
+
+			if (boggle_grid_char_from_character(character) == k_invalid_boggle_grid_char)
+			{
+				output_error("\tboard at line #%" PRIu64 " contains unacceptable characters (starting at column #%d)",
+					m_position,
+					static_cast<int>(cursor - m_line.c_str()) + 1);
+				m_failed = true;
+				return false;
+			}
+
+			out_board.letters.push_back(character);
+		}
+
+		if (out_board.letters.size() != static_cast<size_t>(out_board.width * out_board.height))
+		{
+			output_error("\tboard at line #%" PRIu64 " has %d letters rather than %d by %d",
+				m_position,
+				static_cast<int>(out_board.letters.size()),
+				out_board.width, out_board.height);
+			m_failed = true;
+			return false;
+		}
+
+		return true;
+	}
+}
+
+bool c_boggle_board_batch_reader::read_binary_board(
+	s_boggle_batch_board& out_board)
+{
+	uint64_t board_offset = m_file.get_bytes_consumed();
+
+	s_boggle_board_batch_file_board_header board_header;
+	if (!m_file.read(board_header))
+	{
+		if (m_file.get_bytes_consumed() != board_offset)
+		{
+			output_error("\tboard #%" PRIu64 " is truncated",
+				m_position);
+			m_failed = true;
+		}
+
+		return false;
+	}
+
+	if (!is_valid_boggle_batch_board_size(board_header.width, board_header.height))
+	{
+		output_error("\tboard #%" PRIu64 " has an invalid size",
+			m_position);
+		m_failed = true;
+		return false;
+	}
+
+	size_t cell_count = static_cast<size_t>(board_header.width) * board_header.height;
+	m_packed_grid_chars.resize(((cell_count * k_boggle_board_batch_file_bits_per_grid_char) + 7) / 8);
+	if (!m_file.read(m_packed_grid_chars.data(), m_packed_grid_chars.size()))
+	{
+		output_error("\tboard #%" PRIu64 " is truncated",
+			m_position);
+		m_failed = true;
+		return false;
+	}
+
+	out_board.width = board_header.width;
+	out_board.height = board_header.height;
+	out_board.letters.clear();
+
+	uint32_t bits = 0;
+	uint32_t bits_count = 0;
+	for (size_t cell_index = 0, packed_index = 0; cell_index < cell_count; cell_index++)
+	{
+		while (bits_count < k_boggle_board_batch_file_bits_per_grid_char)
+		{
+			bits |= static_cast<uint32_t>(m_packed_grid_chars[packed_index++]) << bits_count;
+			bits_count += 8;
+		}
+
+		auto grid_char = static_cast<boggle_grid_char_t>(bits & MASK(k_boggle_board_batch_file_bits_per_grid_char));
+		bits >>= k_boggle_board_batch_file_bits_per_grid_char;
+		bits_count -= k_boggle_board_batch_file_bits_per_grid_char;
+
+		if (grid_char >= k_number_of_boggle_grid_characters)
+		{
+			output_error("\tboard #%" PRIu64 " contains an invalid grid char",
+				m_position);
+			m_failed = true;
+			return false;
+		}
+
+		out_board.letters.push_back(boggle_grid_char_to_string(grid_char)[0]);
+	}
+
+	m_position++;
+	return true;
+}
+
+bool c_boggle_board_batch_reader::read_board(
+	s_boggle_batch_board& out_board)
+{
+	if (!m_file.is_open() || m_failed)
+		return false;
+
+	return m_format == _boggle_board_batch_file_format_binary
+		? read_binary_board(out_board)
+		: read_text_board(out_board);
+}
+
+
+c_boggle_board_batch_writer::c_boggle_board_batch_writer()
+	: m_file()
+	, m_format(_boggle_board_batch_file_format_text)
+	, m_boards_written(0)
+	, m_line()
+	, m_packed_grid_chars()
+{
+}
+
+bool c_boggle_board_batch_writer::open(
+	const char* filename,
+	const e_boggle_board_batch_file_format format)
+{
+	close();
+
+	if (!m_file.open(filename))
+	{
+		output_error("failed to open/create board batch file: %s",
+			filename);
+		return false;
+	}
+
+	m_format = format;
+
+	if (m_format == _boggle_board_batch_file_format_binary)
+	{
+		s_boggle_board_batch_file_header header;
+		header.signature = k_boggle_board_batch_file_signature;
+		header.version = k_boggle_board_batch_file_version;
+		m_file.write(header);
+	}
+
+	return true;
+}
+
+bool c_boggle_board_batch_writer::close()
+{
+	m_boards_written = 0;
+	return m_file.close();
+}
+
+bool c_boggle_board_batch_writer::write_text_board(
+	const int width,
+	const int height,
+	const char* letters)
+{
+	char size_prefix[32];
+	int size_prefix_length = sprintf_s(size_prefix, sizeof size_prefix, "%d %d ", width, height);
+
+	m_line.assign(size_prefix, size_prefix_length);
+	for (int cell_index = 0; cell_index < width * height; cell_index++)
+	{
+		boggle_grid_char_character_to_utf8(letters[cell_index], m_line);
+	}
+	m_line.push_back('\n');
+
+	return m_file.write(m_line.data(), m_line.size());
+}
+
+bool c_boggle_board_batch_writer::write_binary_board(
+	const int width,
+	const int height,
+	const char* letters)
+{
+	s_boggle_board_batch_file_board_header board_header;
+	board_header.width = static_cast<uint16_t>(width);
+	board_header.height = static_cast<uint16_t>(height);
+
+	m_packed_grid_chars.clear();
+
+	uint32_t bits = 0;
+	uint32_t bits_count = 0;
+	for (int cell_index = 0; cell_index < width * height; cell_index++)
+	{
+		bits |= static_cast<uint32_t>(boggle_grid_char_from_character(letters[cell_index])) << bits_count;
+		bits_count += k_boggle_board_batch_file_bits_per_grid_char;
+
+		for (; bits_count >= 8; bits >>= 8, bits_count -= 8)
+		{
+			m_packed_grid_chars.push_back(static_cast<uint8_t>(bits));
+		}
+	}
+	if (bits_count > 0)
+	{
+		m_packed_grid_chars.push_back(static_cast<uint8_t>(bits));
+	}
+
+	return m_file.write(board_header)
+		&& m_file.write(m_packed_grid_chars.data(), m_packed_grid_chars.size());
+}
+
+bool c_boggle_board_batch_writer::write_board(
+	const int width,
+	const int height,
+	const char* letters)
+{
+	if (!m_file.is_open())
+		return false;
+
+	if (!is_valid_boggle_batch_board_size(width, height) || !letters)
+	{
+		output_error("write_board called with invalid board size: %d by %d",
+			width, height);
+		return false;
+	}
+
+	for (int cell_index = 0; cell_index < width * height; cell_index++)
+	{
+		if (letters[cell_index] == '\0' ||
+			boggle_grid_char_from_character(letters[cell_index]) == k_invalid_boggle_grid_char)
+		{
+			output_error("write_board called with too few or invalid letters at index #%d",
+				cell_index);
+			return false;
+		}
+	}
+
+	bool success = m_format == _boggle_board_batch_file_format_binary
+		? write_binary_board(width, height, letters)
+		: write_text_board(width, height, letters);
+
+	if (success)
+		m_boards_written++;
+
+	return success;
+}
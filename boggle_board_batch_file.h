@@ -0,0 +1,157 @@
+#pragma once
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+#include <boggle_grid_char.h>
+#include <double_buffered_file.h>
+
+// Files of many boards, for solving in batches rather than one board per file.
+// Text files have one board per line, its width and height then its letters, e.g.
+// "4 4 abcdefghijklmnop". Letters are UTF-8, one per cell, with 'q' for the Qu cell. Blank lines
+// and lines starting with '#' are skipped.
+// Binary files have a header, then per board its width and height followed by its grid chars,
+// bit packed with k_boggle_board_batch_file_bits_per_grid_char bits each.
+
+enum e_boggle_board_batch_file_format
+{
+	_boggle_board_batch_file_format_text,
+	_boggle_board_batch_file_format_binary,
+
+	k_number_of_boggle_board_batch_file_formats
+};
+
+enum
+{
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	// grid chars are packed wider, so files aren't interchangeable with the default alphabet
+	k_boggle_board_batch_file_signature = 'bbax',
+#else
+	k_boggle_board_batch_file_signature = 'bbat',
+#endif
+	k_boggle_board_batch_file_version = 1,
+
+	// 5 bits for the default alphabet
+	k_boggle_board_batch_file_bits_per_grid_char = compile_time_log2(k_number_of_boggle_grid_characters - 1) + 1,
+};
+
+struct s_boggle_board_batch_file_header
+{
+	uint32_t signature;
+	uint32_t version;
+};
+
+struct s_boggle_board_batch_file_board_header
+{
+	uint16_t width;
+	uint16_t height;
+};
+
+struct s_boggle_batch_board
+{
+	int width;
+	int height;
+	// width*height characters in row major order, as c_boggle::solve_board takes them
+	std::string letters;
+};
+
+class c_boggle_board_batch_reader
+{
+	c_double_buffered_file_reader m_file;
+	e_boggle_board_batch_file_format m_format;
+	// counts lines rather than boards for text files, for error messages
+	uint64_t m_position;
+	bool m_failed;
+	std::string m_line;
+	std::vector<uint8_t> m_packed_grid_chars;
+
+private:
+	bool read_text_board(
+		s_boggle_batch_board& out_board);
+
+	bool read_binary_board(
+		s_boggle_batch_board& out_board);
+
+public:
+	c_boggle_board_batch_reader();
+
+	// the format is told apart by the binary file's header
+	bool open(
+		const char* filename);
+
+	void close();
+
+	// false once there are no more boards, or on a malformed board (see has_failed). The board's
+	// letters are reused, so reading into the same board doesn't allocate
+	bool read_board(
+		s_boggle_batch_board& out_board);
+
+	e_boggle_board_batch_file_format get_format() const
+	{
+		return m_format;
+	}
+
+	bool has_failed() const
+	{
+		return m_failed || m_file.has_failed();
+	}
+
+	// for reporting progress
+	uint64_t get_bytes_read() const
+	{
+		return m_file.get_bytes_consumed();
+	}
+
+	uint64_t get_file_size() const
+	{
+		return m_file.get_file_size();
+	}
+};
+
+class c_boggle_board_batch_writer
+{
+	c_double_buffered_file_writer m_file;
+	e_boggle_board_batch_file_format m_format;
+	uint64_t m_boards_written;
+	std::string m_line;
+	std::vector<uint8_t> m_packed_grid_chars;
+
+private:
+	bool write_text_board(
+		const int width,
+		const int height,
+		const char* letters);
+
+	bool write_binary_board(
+		const int width,
+		const int height,
+		const char* letters);
+
+public:
+	c_boggle_board_batch_writer();
+
+	bool open(
+		const char* filename,
+		const e_boggle_board_batch_file_format format);
+
+	// false if any board couldn't be written
+	bool close();
+
+	bool write_board(
+		const int width,
+		const int height,
+		// width*height characters in row major order
+		const char* letters);
+
+	bool write_board(
+		const s_boggle_batch_board& board)
+	{
+		return write_board(board.width, board.height, board.letters.c_str());
+	}
+
+	uint64_t get_boards_written() const
+	{
+		return m_boards_written;
+	}
+};
@@ -3,9 +3,16 @@
 
 #include <boggle_dictionary_word.h>
 #include <boggle_grid_char.h>
+#include <memory_mapped_file.h>
+#include <tracked_memory.h>
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+static_assert(sizeof(s_boggle_dictionary_word) == 0x10,
+	"Unexpected s_boggle_dictionary_word size");
+#else
 static_assert(sizeof(s_boggle_dictionary_word) == 0xC,
-	"Unexpected s_boggle_grid_cell size");
+	"Unexpected s_boggle_dictionary_word size");
+#endif
 
 
 void s_boggle_dictionary_word::initialize(
@@ -44,6 +51,8 @@ c_boggle_dictionary::c_boggle_dictionary()
 	, m_words_count(0)
 	, m_words(nullptr)
 	, m_root_chars_word_lengths()
+	, m_owns_words_memory(true)
+	, m_trie_only(false)
 {
 	m_root_chars_word_lengths.fill({ s_boggle_dictionary_word::k_max_length, 0 });
 }
@@ -57,7 +66,7 @@ size_t c_boggle_dictionary::estimate_total_memory_used() const
 {
 	size_t estimated_total_memory_used = sizeof(*this);
 	estimated_total_memory_used += m_string_pool_size;
-	estimated_total_memory_used += sizeof(m_words[0]) + m_words_count;
+	estimated_total_memory_used += sizeof(m_words[0]) * m_words_count;
 	return estimated_total_memory_used;
 }
 
@@ -79,16 +88,10 @@ uint32_t c_boggle_dictionary::calculate_string_pool_size_for_legal_words(
 void c_boggle_dictionary::allocate_words_array(
 	const size_t new_size)
 {
+	assert(m_owns_words_memory);
+
 	size_t total_new_size = new_size * sizeof(*m_words);
-	void* memory;
-	if (m_words)
-	{
-		memory = realloc(m_words, total_new_size);
-	}
-	else
-	{
-		memory = malloc(total_new_size);
-	}
+	void* memory = tracked_realloc(_memory_tag_dictionary, m_words, total_new_size);
 	m_words = reinterpret_cast<s_boggle_dictionary_word*>(memory);
 }
 
@@ -96,16 +99,79 @@ void c_boggle_dictionary::delete_words_memory()
 {
 	if (m_string_pool)
 	{
-		delete[] m_string_pool;
-		m_string_pool_size = 0;
+		if (m_owns_words_memory)
+			tracked_delete_array(_memory_tag_dictionary, m_string_pool);
 		m_string_pool = nullptr;
 	}
 	if (m_words)
 	{
-		free(m_words);
-		m_words_count = 0;
+		if (m_owns_words_memory)
+			tracked_free(_memory_tag_dictionary, m_words);
 		m_words = nullptr;
 	}
+
+	m_string_pool_size = 0;
+	m_words_count = 0;
+	m_owns_words_memory = true;
+	m_trie_only = false;
+}
+
+void c_boggle_dictionary::initialize_word(
+	s_boggle_dictionary_word& word,
+	const uint32_t word_string_pool_offset,
+	const uint32_t word_length) const
+{
+	const char* word_string = &m_string_pool[word_string_pool_offset];
+
+	char prev_char = std::numeric_limits<char>::min();
+	char curr_char;
+	bool word_contains_qu = false;
+	uint32_t word_length_with_qu_as_one_grid_char = 0;
+	boggle_grid_char_flags_t grid_chars_in_word_flags = 0;
+	for (uint32_t char_index = 0
+		; char_index < word_length
+		; char_index++, word_length_with_qu_as_one_grid_char++)
+	{
+		curr_char = word_string[char_index];
+		assert(boggle_grid_char_is_valid_character(curr_char));
+
+		if (curr_char == 'u' && prev_char == 'q')
+		{
+			// this will always be >= 1, so we don't have to worry about underflow
+			word_length_with_qu_as_one_grid_char--;
+			word_contains_qu = true;
+		}
+		else
+		{
+			auto curr_grid_char = boggle_grid_char_from_character(curr_char);
+			SET_BOGGLE_GRID_CHAR_FLAG(grid_chars_in_word_flags, curr_grid_char, true);
+		}
+
+		prev_char = curr_char;
+	}
+
+	word.initialize(word_length, word_length_with_qu_as_one_grid_char,
+		word_string_pool_offset, word_contains_qu,
+		grid_chars_in_word_flags);
+}
+
+void c_boggle_dictionary::accumulate_word_lengths(
+	const s_boggle_dictionary_word& word)
+{
+	auto word_length = static_cast<uint16_t>(word.get_length());
+	auto first_grid_char = boggle_grid_char_from_character(m_string_pool[word.string_pool_offset]);
+	auto& root_char_word_lengths = m_root_chars_word_lengths[first_grid_char];
+
+	root_char_word_lengths.shortest_word_length =
+		std::min(root_char_word_lengths.shortest_word_length, word_length);
+	root_char_word_lengths.longest_word_length =
+		std::max(root_char_word_lengths.longest_word_length, word_length);
+
+	m_shortest_word_length =
+		std::min(m_shortest_word_length, root_char_word_lengths.shortest_word_length);
+	m_longest_word_length =
+		std::max(m_longest_word_length, root_char_word_lengths.longest_word_length);
+	m_avg_word_length += word_length;
 }
 
 bool c_boggle_dictionary::add_word(
@@ -128,16 +194,11 @@ bool c_boggle_dictionary::add_word(
 		return false;
 	}
 
-	char prev_char = std::numeric_limits<char>::min();
-	char curr_char;
-	bool word_contains_qu = false;
-	uint32_t word_length_with_qu_as_one_grid_char = 0;
-	boggle_grid_char_flags_t grid_chars_in_word_flags = 0;
 	for (size_t char_index = 0
 		; char_index < word_string.length()
-		; char_index++, word_length_with_qu_as_one_grid_char++)
+		; char_index++)
 	{
-		curr_char = word_string.at(char_index);
+		char curr_char = word_string.at(char_index);
 		if (!boggle_grid_char_is_valid_character(curr_char))
 		{
 			// undo the modifications we've made to the string pool
@@ -148,45 +209,17 @@ bool c_boggle_dictionary::add_word(
 			return false;
 		}
 
-		curr_char = tolower(curr_char);
-		m_string_pool[word_string_pool_offset + char_index] = curr_char;
-
-		if (curr_char == 'u' && prev_char == 'q')
-		{
-			// this will always be >= 1, so we don't have to worry about underflow
-			word_length_with_qu_as_one_grid_char--;
-			word_contains_qu = true;
-		}
-		else
-		{
-			auto curr_grid_char = boggle_grid_char_from_character(curr_char);
-			SET_FLAG(grid_chars_in_word_flags, curr_grid_char, true);
-		}
+		m_string_pool[word_string_pool_offset + char_index] = boggle_grid_char_character_to_lower(curr_char);
 	}
 
 	m_string_pool[word_string_pool_offset + word_length] = '\0';
 
 	auto& word = m_words[m_words_count++];
-	word.initialize(word_length, word_length_with_qu_as_one_grid_char,
-		word_string_pool_offset, word_contains_qu,
-		grid_chars_in_word_flags);
+	initialize_word(word, word_string_pool_offset, word_length);
+	accumulate_word_lengths(word);
 
 	word_string_pool_offset += word_length + 1;
 
-	auto first_grid_char = boggle_grid_char_from_character(word_string.at(0));
-	auto& root_char_word_lengths = m_root_chars_word_lengths[first_grid_char];
-
-	root_char_word_lengths.shortest_word_length =
-		std::min(root_char_word_lengths.shortest_word_length, static_cast<uint16_t>(word_length));
-	root_char_word_lengths.longest_word_length =
-		std::max(root_char_word_lengths.longest_word_length, static_cast<uint16_t>(word_length));
-
-	m_shortest_word_length =
-		std::min(m_shortest_word_length, root_char_word_lengths.shortest_word_length);
-	m_longest_word_length =
-		std::max(m_longest_word_length, root_char_word_lengths.longest_word_length);
-	m_avg_word_length += word_length;
-
 	return true;
 }
 
@@ -194,7 +227,7 @@ bool c_boggle_dictionary::set_legal_words_from_alphabetically_sorted_array(
 	const std::vector<std::string>& all_words)
 {
 	m_string_pool_size = calculate_string_pool_size_for_legal_words(all_words);
-	m_string_pool = new char[m_string_pool_size];
+	m_string_pool = tracked_new_array<char>(_memory_tag_dictionary, m_string_pool_size);
 	if (!m_string_pool)
 	{
 		output_error("Failed to allocate enough memory for dictionary string pool");
@@ -261,6 +294,92 @@ bool c_boggle_dictionary::set_legal_words_from_alphabetically_sorted_array(
 	return true;
 }
 
+bool c_boggle_dictionary::has_legal_words(
+	const std::vector<std::string>& all_words) const
+{
+	if (m_trie_only)
+		return false;
+
+	uint32_t word_index = 0;
+	for (auto& word_string : all_words)
+	{
+		// as add_word would have skipped it
+		if (word_string.length() < k_shortest_acceptable_word_length ||
+			word_string.length() > k_longest_acceptable_word_length ||
+			!std::all_of(word_string.begin(), word_string.end(), boggle_grid_char_is_valid_character))
+		{
+			continue;
+		}
+
+		if (word_index == m_words_count)
+			return false;
+
+		auto& word = m_words[word_index++];
+		if (word.get_length() != word_string.length())
+			return false;
+
+		const char* string = get_string(word);
+		for (size_t char_index = 0; char_index < word_string.length(); char_index++)
+		{
+			if (string[char_index] != boggle_grid_char_character_to_lower(word_string[char_index]))
+				return false;
+		}
+	}
+
+	return word_index == m_words_count;
+}
+
+bool c_boggle_dictionary::set_legal_words_from_sorted_string_pool(
+	char* string_pool,
+	const uint32_t string_pool_size,
+	const uint32_t* word_string_pool_offsets,
+	const uint32_t words_count)
+{
+	delete_words_memory();
+
+	m_string_pool = string_pool;
+	m_string_pool_size = string_pool_size;
+
+	allocate_words_array(words_count);
+	if (!m_words)
+	{
+		output_error("Failed to allocate enough memory for dictionary words");
+		delete_words_memory();
+		return false;
+	}
+
+	// the words are packed back to back, so each one ends where the next begins
+#pragma omp parallel for
+	for (int word_index = 0; word_index < static_cast<int>(words_count); word_index++)
+	{
+		uint32_t word_string_pool_offset = word_string_pool_offsets[word_index];
+		uint32_t word_string_pool_end = static_cast<uint32_t>(word_index + 1) < words_count
+			? word_string_pool_offsets[word_index + 1]
+			: string_pool_size;
+		assert(word_string_pool_offset < word_string_pool_end);
+
+		initialize_word(m_words[word_index], word_string_pool_offset,
+			word_string_pool_end - word_string_pool_offset - 1);
+	}
+	m_words_count = words_count;
+
+	m_shortest_word_length = k_longest_acceptable_word_length;
+	m_longest_word_length = 0;
+	m_avg_word_length = 0;
+	m_root_chars_word_lengths.fill({ s_boggle_dictionary_word::k_max_length, 0 });
+	for (uint32_t word_index = 0; word_index < m_words_count; word_index++)
+	{
+		accumulate_word_lengths(m_words[word_index]);
+	}
+
+	if (m_words_count > 0)
+	{
+		m_avg_word_length /= m_words_count;
+	}
+
+	return true;
+}
+
 const char* c_boggle_dictionary::get_string(
 	const s_boggle_dictionary_word& word) const
 {
@@ -282,7 +401,7 @@ bool  c_boggle_dictionary::valid_word_pointer(
 const s_boggle_dictionary_word* c_boggle_dictionary::get_word(
 	const int word_index) const
 {
-	return static_cast<uint32_t>(word_index) < m_words_count
+	return m_words != nullptr && static_cast<uint32_t>(word_index) < m_words_count
 		? m_words + word_index
 		: nullptr;
 }
@@ -305,12 +424,37 @@ const s_boggle_dictionary_word* c_boggle_dictionary::end_words() const
 	return m_words + m_words_count;
 }
 
+void c_boggle_dictionary::get_root_char_word_range(
+	const boggle_grid_char_t grid_char,
+	uint32_t& out_first_word_index,
+	uint32_t& out_word_count) const
+{
+	auto starts_before_grid_char = [this](const s_boggle_dictionary_word& word, const boggle_grid_char_t grid_char)
+	{
+		return boggle_grid_char_from_character(get_string(word)[0]) < grid_char;
+	};
+	auto starts_after_grid_char = [this](const boggle_grid_char_t grid_char, const s_boggle_dictionary_word& word)
+	{
+		return grid_char < boggle_grid_char_from_character(get_string(word)[0]);
+	};
+
+	auto first_word = std::lower_bound(begin_words(), end_words(), grid_char, starts_before_grid_char);
+	auto end_word = std::upper_bound(first_word, end_words(), grid_char, starts_after_grid_char);
+
+	out_first_word_index = static_cast<uint32_t>(first_word - begin_words());
+	out_word_count = static_cast<uint32_t>(end_word - first_word);
+}
+
 bool c_boggle_dictionary::write_to_file(
 	_iobuf* file) const
 {
 	if (!file)
 		return false;
 
+	// there are no words to write
+	if (m_trie_only)
+		return false;
+
 	uint32_t file_signature = k_file_data_signature;
 	if (1 != fwrite(&file_signature, sizeof file_signature, 1, file))
 		return false;
@@ -328,11 +472,15 @@ bool c_boggle_dictionary::write_to_file(
 
 	if (1 != fwrite(&m_string_pool_size, sizeof m_string_pool_size, 1, file))
 		return false;
+	if (!fwrite_alignment_padding(file))
+		return false;
 	if (m_string_pool_size != fwrite(m_string_pool, sizeof m_string_pool[0], m_string_pool_size, file))
 		return false;
 
 	if (1 != fwrite(&m_words_count, sizeof m_words_count, 1, file))
 		return false;
+	if (!fwrite_alignment_padding(file))
+		return false;
 	if (m_words_count != fwrite(m_words, sizeof m_words[0], m_words_count, file))
 		return false;
 
@@ -343,7 +491,8 @@ bool c_boggle_dictionary::write_to_file(
 }
 
 bool c_boggle_dictionary::read_from_file(
-	_iobuf* file)
+	_iobuf* file,
+	const bool trie_only)
 {
 	if (!file)
 		return false;
@@ -369,33 +518,115 @@ bool c_boggle_dictionary::read_from_file(
 	if (1 != fread(&m_avg_word_length, sizeof m_avg_word_length, 1, file))
 		return false;
 
-	if (1 != fread(&m_string_pool_size, sizeof m_string_pool_size, 1, file))
+	uint32_t string_pool_size;
+	if (1 != fread(&string_pool_size, sizeof string_pool_size, 1, file))
 		return false;
 
-	m_string_pool = new char[m_string_pool_size];
-	if (!m_string_pool)
-	{
+	if (!fseek_past_alignment_padding(file))
 		return false;
+	if (trie_only)
+	{
+		if (0 != _fseeki64(file, string_pool_size, SEEK_CUR))
+			return false;
 	}
+	else
+	{
+		m_string_pool_size = string_pool_size;
+		m_string_pool = tracked_new_array<char>(_memory_tag_dictionary, m_string_pool_size);
+		if (!m_string_pool)
+		{
+			return false;
+		}
 
-	if (m_string_pool_size != fread(m_string_pool, sizeof m_string_pool[0], m_string_pool_size, file))
-		return false;
+		if (m_string_pool_size != fread(m_string_pool, sizeof m_string_pool[0], m_string_pool_size, file))
+			return false;
+	}
 
 	if (1 != fread(&m_words_count, sizeof m_words_count, 1, file))
 		return false;
 
-	allocate_words_array(m_words_count);
-	if (!m_words)
-	{
+	if (!fseek_past_alignment_padding(file))
 		return false;
+	if (trie_only)
+	{
+		if (0 != _fseeki64(file, static_cast<int64_t>(sizeof(s_boggle_dictionary_word)) * m_words_count, SEEK_CUR))
+			return false;
 	}
+	else
+	{
+		allocate_words_array(m_words_count);
+		if (!m_words)
+		{
+			return false;
+		}
 
-	if (m_words_count != fread(m_words, sizeof m_words[0], m_words_count, file))
-		return false;
+		if (m_words_count != fread(m_words, sizeof m_words[0], m_words_count, file))
+			return false;
+	}
 
 	if (m_root_chars_word_lengths.size() != fread(m_root_chars_word_lengths.data(), sizeof m_root_chars_word_lengths[0], m_root_chars_word_lengths.size(), file))
 		return false;
 
+	m_trie_only = trie_only;
+
+	return true;
+}
+
+bool c_boggle_dictionary::read_from_memory(
+	c_memory_reader& reader,
+	const bool trie_only)
+{
+	uint32_t file_signature;
+	if (!reader.read(file_signature))
+		return false;
+
+	uint32_t file_version;
+	if (!reader.read(file_version))
+		return false;
+
+	if (file_signature != k_file_data_signature ||
+		file_version != k_file_data_version)
+		return false;
+
+	delete_words_memory();
+
+	if (!reader.read(m_shortest_word_length))
+		return false;
+	if (!reader.read(m_longest_word_length))
+		return false;
+	if (!reader.read(m_avg_word_length))
+		return false;
+
+	uint32_t string_pool_size;
+	if (!reader.read(string_pool_size))
+		return false;
+
+	auto string_pool = reader.read_array_in_place<char>(string_pool_size);
+	if (!string_pool)
+		return false;
+
+	uint32_t words_count;
+	if (!reader.read(words_count))
+		return false;
+
+	auto words = reader.read_array_in_place<s_boggle_dictionary_word>(words_count);
+	if (!words)
+		return false;
+
+	if (!reader.read(m_root_chars_word_lengths))
+		return false;
+
+	m_words_count = words_count;
+	m_trie_only = trie_only;
+	if (!trie_only)
+	{
+		// the memory is never written to, it's only non-const for the sake of the owning case
+		m_owns_words_memory = false;
+		m_string_pool_size = string_pool_size;
+		m_string_pool = const_cast<char*>(string_pool);
+		m_words = const_cast<s_boggle_dictionary_word*>(words);
+	}
+
 	return true;
 }
 
@@ -9,6 +9,7 @@
 struct _iobuf;
 
 struct s_boggle_dictionary_word;
+class c_memory_reader;
 
 class c_boggle_dictionary
 {
@@ -18,8 +19,13 @@ public:
 		k_shortest_acceptable_word_length = 3,
 		k_longest_acceptable_word_length = std::numeric_limits<int8_t>::max(),
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+		// the words' grid char flags are wider, so files aren't interchangeable with the default alphabet
+		k_file_data_signature = 'dicx',
+#else
 		k_file_data_signature = 'dict',
-		k_file_data_version = 1,
+#endif
+		k_file_data_version = 3,
 	};
 
 	struct s_root_char_word_lengths
@@ -42,6 +48,12 @@ private:
 	std::array<s_root_char_word_lengths, k_number_of_boggle_grid_characters>
 		m_root_chars_word_lengths;
 
+	// false when the string pool and words point into memory we don't own, e.g. a mapped file
+	bool m_owns_words_memory;
+	// only the counts and lengths were loaded, the string pool and words were skipped. The words
+	// only exist as paths through the dictionary's trie
+	bool m_trie_only;
+
 private:
 	static uint32_t calculate_string_pool_size_for_legal_words(
 		const std::vector<std::string>& all_words);
@@ -52,6 +64,15 @@ private:
 
 	void delete_words_memory();
 
+	// fills in the word for a string already lower cased in the string pool
+	void initialize_word(
+		s_boggle_dictionary_word& word,
+		const uint32_t word_string_pool_offset,
+		const uint32_t word_length) const;
+
+	void accumulate_word_lengths(
+		const s_boggle_dictionary_word& word);
+
 	bool add_word(
 		const std::string& word_string,
 		uint32_t& word_string_pool_offset);
@@ -66,6 +87,21 @@ public:
 		// alphabetically-sorted array of legal words
 		const std::vector<std::string>& all_words);
 
+	// would set_legal_words_from_alphabetically_sorted_array have given us exactly these words?
+	// Words it would have skipped, e.g. too short ones, are skipped here too
+	bool has_legal_words(
+		const std::vector<std::string>& all_words) const;
+
+	// takes ownership of a string pool, allocated with tracked_new_array(_memory_tag_dictionary), of
+	// alphabetically sorted, unique, lower case and already validated words packed back to back,
+	// each with its terminator. Saves the std::string per word that
+	// set_legal_words_from_alphabetically_sorted_array needs
+	bool set_legal_words_from_sorted_string_pool(
+		char* string_pool,
+		const uint32_t string_pool_size,
+		const uint32_t* word_string_pool_offsets,
+		const uint32_t words_count);
+
 	const char* get_string(
 		const s_boggle_dictionary_word& word) const;
 
@@ -82,6 +118,12 @@ public:
 
 	const s_boggle_dictionary_word* end_words() const;
 
+	// range of the (alphabetically sorted) words which start with the given grid char
+	void get_root_char_word_range(
+		const boggle_grid_char_t grid_char,
+		uint32_t& out_first_word_index,
+		uint32_t& out_word_count) const;
+
 	uint32_t get_shortest_word_length() const
 	{
 		return m_shortest_word_length;
@@ -118,10 +160,24 @@ public:
 		return m_words_count;
 	}
 
+	// when true, there are no word strings and tries can't be built from this dictionary
+	bool is_trie_only() const
+	{
+		return m_trie_only;
+	}
+
 	bool write_to_file(
 		_iobuf* file) const;
 
+	// when trie_only, the string pool and words are skipped
 	bool read_from_file(
-		_iobuf* file);
+		_iobuf* file,
+		const bool trie_only = false);
+
+	// reads what write_to_file wrote, but the string pool and words are used in place, so the
+	// memory must outlive the dictionary
+	bool read_from_memory(
+		c_memory_reader& reader,
+		const bool trie_only = false);
 };
 
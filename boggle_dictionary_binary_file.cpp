@@ -0,0 +1,409 @@
+#include <precompile.h>
+#include <boggle_dictionary_binary_file.h>
+
+#include <crc32c.h>
+#include <memory_mapped_file.h>
+
+static_assert(sizeof(s_boggle_dictionary_binary_file_section) == 0x20,
+	"Unexpected s_boggle_dictionary_binary_file_section size");
+
+struct s_boggle_dictionary_binary_file_header_v1
+{
+	enum
+	{
+		k_signature = 'bdic',
+		k_version = 1,
+	};
+
+	uint32_t signature;
+	uint32_t version;
+
+	struct
+	{
+		int32_t offset;
+		int32_t length;
+	}dictionary, dictionary_trie;
+};
+static_assert(sizeof(s_boggle_dictionary_binary_file_header_v1) == 0x18,
+	"Unexpected s_boggle_dictionary_binary_file_header_v1 size");
+
+struct s_boggle_dictionary_binary_file_header
+{
+	enum
+	{
+		k_version = 2,
+		k_byte_order_mark = 0x01020304,
+		k_byte_order_mark_swapped = 0x04030201,
+
+		k_section_alignment = 64,
+		k_max_section_count = 64,
+	};
+
+	// unlike a multi-character literal, these bytes don't depend on the compiler or byte order.
+	// The CR LF and EOF bytes catch files mangled by text mode transfers
+	static const std::array<uint8_t, 8> k_signature;
+
+	std::array<uint8_t, 8> signature;
+	uint32_t version;
+	// written in the writer's byte order, so a reader with a different byte order sees it swapped
+	uint32_t byte_order_mark;
+	uint32_t header_size;
+	uint32_t section_count;
+	uint64_t section_table_offset;
+	uint32_t section_table_crc32c;
+	uint32_t reserved[7];
+};
+static_assert(sizeof(s_boggle_dictionary_binary_file_header) == 0x40,
+	"Unexpected s_boggle_dictionary_binary_file_header size");
+static_assert(sizeof(s_boggle_dictionary_binary_file_header) >= sizeof(s_boggle_dictionary_binary_file_header_v1),
+	"Expected to be able to read a v1 header in place of a v2 header");
+
+const std::array<uint8_t, 8> s_boggle_dictionary_binary_file_header::k_signature =
+	{ 0x89, 'B', 'D', 'I', 'C', '\r', '\n', 0x1A };
+
+static bool read_v1_layout(
+	const s_boggle_dictionary_binary_file_header_v1& header,
+	s_boggle_dictionary_binary_file_layout& out_layout)
+{
+	if (header.signature != header.k_signature ||
+		header.version != header.k_version ||
+		header.dictionary.offset <= 0 ||
+		header.dictionary.length <= 0 ||
+		header.dictionary_trie.offset <= 0 ||
+		header.dictionary_trie.length <= 0)
+	{
+		output_error("binary dictionary file has an invalid header");
+		return false;
+	}
+
+	memset(&out_layout, 0, sizeof(out_layout));
+	out_layout.version = header.version;
+
+	auto& dictionary_section = out_layout.sections[_boggle_dictionary_binary_file_section_dictionary];
+	dictionary_section.type = _boggle_dictionary_binary_file_section_dictionary;
+	dictionary_section.offset = static_cast<uint64_t>(header.dictionary.offset);
+	dictionary_section.length = static_cast<uint64_t>(header.dictionary.length);
+
+	auto& dictionary_trie_section = out_layout.sections[_boggle_dictionary_binary_file_section_dictionary_trie];
+	dictionary_trie_section.type = _boggle_dictionary_binary_file_section_dictionary_trie;
+	dictionary_trie_section.offset = static_cast<uint64_t>(header.dictionary_trie.offset);
+	dictionary_trie_section.length = static_cast<uint64_t>(header.dictionary_trie.length);
+
+	return true;
+}
+
+static bool validate_v2_header(
+	const s_boggle_dictionary_binary_file_header& header,
+	const uint64_t file_size)
+{
+	if (header.byte_order_mark == header.k_byte_order_mark_swapped)
+	{
+		output_error("binary dictionary file was written by a machine with a different byte order");
+		return false;
+	}
+
+	if (header.version != header.k_version ||
+		header.byte_order_mark != header.k_byte_order_mark ||
+		header.header_size < sizeof(header) ||
+		header.section_count > header.k_max_section_count ||
+		header.section_table_offset < header.header_size ||
+		header.section_table_offset + (sizeof(s_boggle_dictionary_binary_file_section) * header.section_count) > file_size)
+	{
+		output_error("binary dictionary file has an invalid header");
+		return false;
+	}
+
+	return true;
+}
+
+template<
+	typename TComputeSectionChecksum>
+static bool read_v2_layout(
+	const s_boggle_dictionary_binary_file_header& header,
+	const std::vector<s_boggle_dictionary_binary_file_section>& section_table,
+	const uint64_t file_size,
+	const bool verify_checksums,
+	TComputeSectionChecksum compute_section_checksum,
+	s_boggle_dictionary_binary_file_layout& out_layout)
+{
+	if (header.section_table_crc32c != crc32c(section_table.data(), sizeof(section_table[0]) * section_table.size()))
+	{
+		output_error("binary dictionary file's section table is corrupt");
+		return false;
+	}
+
+	memset(&out_layout, 0, sizeof(out_layout));
+	out_layout.version = header.version;
+
+	for (auto& section : section_table)
+	{
+		if (section.offset % header.k_section_alignment != 0 ||
+			section.offset < header.header_size ||
+			section.length > file_size ||
+			section.offset > file_size - section.length)
+		{
+			output_error("binary dictionary file has an invalid section %u",
+				section.type);
+			return false;
+		}
+
+		if (section.type >= k_number_of_boggle_dictionary_binary_file_section_types)
+		{
+			if (test_bit(section.flags, _boggle_dictionary_binary_file_section_optional_bit))
+				continue;
+
+			output_error("binary dictionary file requires unsupported section %u",
+				section.type);
+			return false;
+		}
+
+		auto& layout_section = out_layout.sections[section.type];
+		if (layout_section.length != 0)
+		{
+			output_error("binary dictionary file has a duplicate section %u",
+				section.type);
+			return false;
+		}
+
+		if (verify_checksums)
+		{
+			uint32_t checksum;
+			if (!compute_section_checksum(section, checksum) ||
+				checksum != section.crc32c)
+			{
+				output_error("binary dictionary file's section %u is corrupt",
+					section.type);
+				return false;
+			}
+		}
+
+		layout_section = section;
+	}
+
+	for (auto& layout_section : out_layout.sections)
+	{
+		if (layout_section.length == 0)
+		{
+			output_error("binary dictionary file is missing a required section");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool compute_file_range_checksum(
+	_iobuf* file,
+	const uint64_t offset,
+	uint64_t length,
+	uint32_t& out_checksum)
+{
+	if (0 != _fseeki64(file, static_cast<int64_t>(offset), SEEK_SET))
+		return false;
+
+	std::vector<uint8_t> buffer(64 * 1024);
+	out_checksum = 0;
+	while (length > 0)
+	{
+		size_t chunk_length = static_cast<size_t>(std::min<uint64_t>(length, buffer.size()));
+		if (chunk_length != fread(buffer.data(), sizeof buffer[0], chunk_length, file))
+			return false;
+
+		out_checksum = crc32c(buffer.data(), chunk_length, out_checksum);
+		length -= chunk_length;
+	}
+
+	return true;
+}
+
+bool compute_boggle_dictionary_binary_file_section_checksum(
+	_iobuf* file,
+	const s_boggle_dictionary_binary_file_section& section,
+	uint32_t& out_checksum)
+{
+	return compute_file_range_checksum(file, section.offset, section.length, out_checksum);
+}
+
+bool read_boggle_dictionary_binary_file_layout(
+	_iobuf* file,
+	const bool verify_checksums,
+	s_boggle_dictionary_binary_file_layout& out_layout)
+{
+	if (!file)
+		return false;
+
+	if (0 != _fseeki64(file, 0, SEEK_END))
+		return false;
+	int64_t file_size = _ftelli64(file);
+	if (file_size < 0 ||
+		0 != _fseeki64(file, 0, SEEK_SET))
+		return false;
+
+	s_boggle_dictionary_binary_file_header header;
+	if (1 != fread(&header, sizeof header, 1, file))
+	{
+		output_error("binary dictionary file is too small to be valid");
+		return false;
+	}
+
+	if (header.signature != header.k_signature)
+		return read_v1_layout(reinterpret_cast<const s_boggle_dictionary_binary_file_header_v1&>(header), out_layout);
+
+	if (!validate_v2_header(header, static_cast<uint64_t>(file_size)))
+		return false;
+
+	std::vector<s_boggle_dictionary_binary_file_section> section_table(header.section_count);
+	if (0 != _fseeki64(file, static_cast<int64_t>(header.section_table_offset), SEEK_SET) ||
+		section_table.size() != fread(section_table.data(), sizeof section_table[0], section_table.size(), file))
+	{
+		output_error("binary dictionary file failed to read the section table");
+		return false;
+	}
+
+	auto compute_section_checksum = [file](const s_boggle_dictionary_binary_file_section& section, uint32_t& out_checksum)
+	{
+		return compute_file_range_checksum(file, section.offset, section.length, out_checksum);
+	};
+
+	return read_v2_layout(header, section_table, static_cast<uint64_t>(file_size), verify_checksums,
+		compute_section_checksum, out_layout);
+}
+
+bool read_boggle_dictionary_binary_file_layout(
+	c_memory_reader& reader,
+	const bool verify_checksums,
+	s_boggle_dictionary_binary_file_layout& out_layout)
+{
+	if (!reader.seek(0))
+		return false;
+
+	s_boggle_dictionary_binary_file_header header;
+	if (!reader.read(header))
+	{
+		output_error("binary dictionary file is too small to be valid");
+		return false;
+	}
+
+	if (header.signature != header.k_signature)
+		return read_v1_layout(reinterpret_cast<const s_boggle_dictionary_binary_file_header_v1&>(header), out_layout);
+
+	if (!validate_v2_header(header, reader.get_size()))
+		return false;
+
+	std::vector<s_boggle_dictionary_binary_file_section> section_table(header.section_count);
+	if (!reader.seek(static_cast<size_t>(header.section_table_offset)) ||
+		!reader.read(section_table.data(), sizeof section_table[0] * section_table.size()))
+	{
+		output_error("binary dictionary file failed to read the section table");
+		return false;
+	}
+
+	auto compute_section_checksum = [&reader](const s_boggle_dictionary_binary_file_section& section, uint32_t& out_checksum)
+	{
+		out_checksum = crc32c(reader.get_data() + section.offset, static_cast<size_t>(section.length));
+		return true;
+	};
+
+	return read_v2_layout(header, section_table, reader.get_size(), verify_checksums,
+		compute_section_checksum, out_layout);
+}
+
+c_boggle_dictionary_binary_file_writer::c_boggle_dictionary_binary_file_writer(
+	_iobuf* file,
+	const uint32_t max_section_count)
+	: m_file(file)
+	, m_max_section_count(max_section_count)
+	, m_sections()
+{
+	assert(file != nullptr);
+	assert(max_section_count <= s_boggle_dictionary_binary_file_header::k_max_section_count);
+	m_sections.reserve(max_section_count);
+}
+
+bool c_boggle_dictionary_binary_file_writer::begin()
+{
+	// leave room for the header and section table, which are filled in by end()
+	s_boggle_dictionary_binary_file_header header = {};
+	if (1 != fwrite(&header, sizeof header, 1, m_file))
+		return false;
+
+	s_boggle_dictionary_binary_file_section section = {};
+	for (uint32_t section_index = 0; section_index < m_max_section_count; section_index++)
+	{
+		if (1 != fwrite(&section, sizeof section, 1, m_file))
+			return false;
+	}
+
+	return true;
+}
+
+bool c_boggle_dictionary_binary_file_writer::begin_section(
+	const e_boggle_dictionary_binary_file_section_type type,
+	const uint32_t flags)
+{
+	if (m_sections.size() == m_max_section_count)
+	{
+		output_error("binary dictionary file writer has no room for section %u",
+			type);
+		return false;
+	}
+
+	if (!fwrite_alignment_padding(m_file, s_boggle_dictionary_binary_file_header::k_section_alignment))
+		return false;
+
+	int64_t offset = _ftelli64(m_file);
+	if (offset < 0)
+		return false;
+
+	s_boggle_dictionary_binary_file_section section = {};
+	section.type = type;
+	section.flags = flags;
+	section.offset = static_cast<uint64_t>(offset);
+	m_sections.push_back(section);
+
+	return true;
+}
+
+bool c_boggle_dictionary_binary_file_writer::end_section()
+{
+	assert(!m_sections.empty());
+
+	int64_t offset = _ftelli64(m_file);
+	if (offset < 0)
+		return false;
+
+	auto& section = m_sections.back();
+	section.length = static_cast<uint64_t>(offset) - section.offset;
+
+	return true;
+}
+
+bool c_boggle_dictionary_binary_file_writer::end()
+{
+	// read back what was written to checksum it, rather than threading the checksum through
+	// every write the blobs make
+	for (auto& section : m_sections)
+	{
+		if (!compute_file_range_checksum(m_file, section.offset, section.length, section.crc32c))
+			return false;
+	}
+
+	s_boggle_dictionary_binary_file_header header = {};
+	header.signature = header.k_signature;
+	header.version = header.k_version;
+	header.byte_order_mark = header.k_byte_order_mark;
+	header.header_size = sizeof header;
+	header.section_count = static_cast<uint32_t>(m_sections.size());
+	header.section_table_offset = sizeof header;
+	header.section_table_crc32c = crc32c(m_sections.data(), sizeof m_sections[0] * m_sections.size());
+
+	if (0 != _fseeki64(m_file, 0, SEEK_SET))
+		return false;
+
+	if (1 != fwrite(&header, sizeof header, 1, m_file))
+		return false;
+	if (m_sections.size() != fwrite(m_sections.data(), sizeof m_sections[0], m_sections.size(), m_file))
+		return false;
+
+	return true;
+}
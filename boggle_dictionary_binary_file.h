@@ -0,0 +1,89 @@
+#pragma once
+
+#include <inttypes.h>
+#include <array>
+#include <vector>
+
+struct _iobuf;
+
+class c_memory_reader;
+
+// Binary dictionary files start with a header and a table of sections. Every section starts
+// 64 byte aligned and has a CRC-32C of its contents, and readers skip optional sections they
+// don't know about. Version 1 files only had a header with the offsets of the two blobs.
+
+enum e_boggle_dictionary_binary_file_section_type : uint32_t
+{
+	_boggle_dictionary_binary_file_section_dictionary,
+	_boggle_dictionary_binary_file_section_dictionary_trie,
+
+	k_number_of_boggle_dictionary_binary_file_section_types,
+};
+
+enum e_boggle_dictionary_binary_file_section_flags : uint32_t
+{
+	// readers which don't know the section's type can ignore it instead of failing to load
+	_boggle_dictionary_binary_file_section_optional_bit,
+};
+
+struct s_boggle_dictionary_binary_file_section
+{
+	// e_boggle_dictionary_binary_file_section_type
+	uint32_t type;
+	// e_boggle_dictionary_binary_file_section_flags
+	uint32_t flags;
+	// from the start of the file
+	uint64_t offset;
+	uint64_t length;
+	uint32_t crc32c;
+	uint32_t reserved;
+};
+
+// where each known section lives, whichever version of the file it came from
+struct s_boggle_dictionary_binary_file_layout
+{
+	uint32_t version;
+	std::array<s_boggle_dictionary_binary_file_section, k_number_of_boggle_dictionary_binary_file_section_types> sections;
+};
+
+// Reads and validates the header and section table of a v1 or v2 file. Section checksums are
+// only verified if asked, as it means reading every section
+bool read_boggle_dictionary_binary_file_layout(
+	_iobuf* file,
+	const bool verify_checksums,
+	s_boggle_dictionary_binary_file_layout& out_layout);
+
+bool read_boggle_dictionary_binary_file_layout(
+	c_memory_reader& reader,
+	const bool verify_checksums,
+	s_boggle_dictionary_binary_file_layout& out_layout);
+
+// CRC-32C of the section's contents, as stored in the section table of v2 files
+bool compute_boggle_dictionary_binary_file_section_checksum(
+	_iobuf* file,
+	const s_boggle_dictionary_binary_file_section& section,
+	uint32_t& out_checksum);
+
+// Writes a v2 file. The header and section table are only filled in by end(), once the
+// length and checksum of every section is known
+class c_boggle_dictionary_binary_file_writer
+{
+	_iobuf* m_file;
+	uint32_t m_max_section_count;
+	std::vector<s_boggle_dictionary_binary_file_section> m_sections;
+
+public:
+	c_boggle_dictionary_binary_file_writer(
+		_iobuf* file,
+		const uint32_t max_section_count);
+
+	bool begin();
+
+	bool begin_section(
+		const e_boggle_dictionary_binary_file_section_type type,
+		const uint32_t flags = 0);
+
+	bool end_section();
+
+	bool end();
+};
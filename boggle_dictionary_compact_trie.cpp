@@ -3,67 +3,130 @@
 
 #include <boggle_dictionary.h>
 #include <boggle_dictionary_trie.h>
+#include <boggle_dictionary_word.h>
+#include <memory_mapped_file.h>
+#include <tracked_memory.h>
 
-static_assert(alignof(s_boggle_dictionary_compact_trie_node) == 0x4,
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+static_assert(alignof(s_boggle_dictionary_compact_trie_node) == 0x8,
 	"Unexpected s_boggle_dictionary_compact_trie_node alignment");
 static_assert(sizeof(s_boggle_dictionary_compact_trie_node) == 0x10,
 	"Unexpected s_boggle_dictionary_compact_trie_node size");
+#else
+static_assert(alignof(s_boggle_dictionary_compact_trie_node) == 0x4,
+	"Unexpected s_boggle_dictionary_compact_trie_node alignment");
+static_assert(sizeof(s_boggle_dictionary_compact_trie_node) == 0x8,
+	"Unexpected s_boggle_dictionary_compact_trie_node size");
+#endif
 
 void s_boggle_dictionary_compact_trie_node::initialize(
 	const s_boggle_dictionary_trie_node* src)
 {
-	private_flags = 0;
-	child_node_indices_offset = -1;
-	valid_child_node_indices_flags = src->valid_child_node_indices_flags;
-	completed_word_index = src->completed_word_index;
-
-	set_grid_char(src->grid_char);
-	set_parent_node_index(k_invalid_relative_node_index);
+	private_flags = src->valid_child_node_indices_flags;
+	SET_BOGGLE_GRID_CHAR_FLAG(private_flags, _private_flags_completes_word_bit, src->completed_word_index >= 0);
+	first_child_relative_node_index = k_invalid_relative_node_index;
 }
 
 c_boggle_dictionary_compact_trie::c_boggle_dictionary_compact_trie()
-	: m_source_dictionary(nullptr)
-	, m_grid_chars_on_grid(0)
-	, m_word_count(0)
-	, m_nodes_count(0)
-	, m_child_node_indices_count(0)
+	: m_nodes_count(0)
 	, m_root_indices_actual_count(0)
 	, m_nodes(nullptr)
-	, m_child_node_indices(nullptr)
+	, m_completed_word_indices(nullptr)
+	, m_subtree_grid_chars(nullptr)
+	, m_subtree_word_lengths(nullptr)
+	, m_owns_nodes_memory(true)
+	, m_source_dictionary()
+	, m_grid_chars_on_grid(0)
+	, m_word_count(0)
 {
 	m_root_indices.fill(-1);
 }
 
 c_boggle_dictionary_compact_trie::c_boggle_dictionary_compact_trie(
 	const c_boggle_dictionary_trie& source_trie)
-	: m_source_dictionary(source_trie.get_dictionary())
-	, m_grid_chars_on_grid(source_trie.get_occuring_grid_chars_flags())
-	, m_word_count(source_trie.get_word_count())
-	, m_nodes_count(0)
-	, m_child_node_indices_count(0)
+	: m_nodes_count(0)
 	, m_root_indices_actual_count(0)
 	, m_nodes(nullptr)
-	, m_child_node_indices(nullptr)
+	, m_completed_word_indices(nullptr)
+	, m_subtree_grid_chars(nullptr)
+	, m_subtree_word_lengths(nullptr)
+	, m_owns_nodes_memory(true)
+	, m_source_dictionary(source_trie.get_source_dictionary())
+	, m_grid_chars_on_grid(source_trie.get_occuring_grid_chars_flags())
+	, m_word_count(source_trie.get_word_count())
 {
 	m_root_indices.fill(-1);
 }
 
+bool c_boggle_dictionary_compact_trie::allocate_nodes_memory()
+{
+	assert(m_nodes == nullptr);
+	assert(m_owns_nodes_memory);
+
+	m_nodes = tracked_new_array<s_boggle_dictionary_compact_trie_node>(_memory_tag_dictionary_compact_trie, m_nodes_count);
+	if (!m_nodes)
+	{
+		output_error("c_boggle_dictionary_compact_trie failed to allocate nodes");
+		return false;
+	}
+
+	m_completed_word_indices = tracked_new_array<int>(_memory_tag_dictionary_compact_trie, m_nodes_count);
+	if (!m_completed_word_indices)
+	{
+		output_error("c_boggle_dictionary_compact_trie failed to allocate completed word indices");
+		return false;
+	}
+
+	m_subtree_grid_chars = tracked_new_array<s_boggle_dictionary_compact_trie_node_subtree_grid_chars>(_memory_tag_dictionary_compact_trie, m_nodes_count);
+	if (!m_subtree_grid_chars)
+	{
+		output_error("c_boggle_dictionary_compact_trie failed to allocate subtree grid chars");
+		return false;
+	}
+
+	m_subtree_word_lengths = tracked_new_array<s_boggle_dictionary_compact_trie_node_subtree_word_lengths>(_memory_tag_dictionary_compact_trie, m_nodes_count);
+	if (!m_subtree_word_lengths)
+	{
+		output_error("c_boggle_dictionary_compact_trie failed to allocate subtree word lengths");
+		return false;
+	}
+
+	return true;
+}
+
 void c_boggle_dictionary_compact_trie::delete_nodes_memory()
 {
 	if (m_nodes)
 	{
-		delete[] m_nodes;
+		if (m_owns_nodes_memory)
+			tracked_delete_array(_memory_tag_dictionary_compact_trie, m_nodes);
 		m_nodes_count = 0;
 		m_nodes = nullptr;
 	}
 
-	if (m_child_node_indices)
+	if (m_completed_word_indices)
+	{
+		if (m_owns_nodes_memory)
+			tracked_delete_array(_memory_tag_dictionary_compact_trie, m_completed_word_indices);
+		m_completed_word_indices = nullptr;
+	}
+
+	if (m_subtree_grid_chars)
+	{
+		if (m_owns_nodes_memory)
+			tracked_delete_array(_memory_tag_dictionary_compact_trie, m_subtree_grid_chars);
+		m_subtree_grid_chars = nullptr;
+	}
+
+	if (m_subtree_word_lengths)
 	{
-		delete[] m_child_node_indices;
-		m_child_node_indices_count = 0;
-		m_child_node_indices = nullptr;
+		if (m_owns_nodes_memory)
+			tracked_delete_array(_memory_tag_dictionary_compact_trie, m_subtree_word_lengths);
+		m_subtree_word_lengths = nullptr;
 	}
 
+	m_owns_nodes_memory = true;
+
 	if (m_root_indices_actual_count > 0)
 	{
 		m_root_indices_actual_count = 0;
@@ -79,42 +142,24 @@ c_boggle_dictionary_compact_trie::~c_boggle_dictionary_compact_trie()
 size_t c_boggle_dictionary_compact_trie::estimate_total_memory_used() const
 {
 	size_t estimated_total_memory_used = sizeof(*this);
-	// #NOTE not include m_source_dictionary since we don't own its memory
+	// #NOTE not include m_source_dictionary since it's shared, and counted with its owner
 	estimated_total_memory_used += sizeof(m_nodes[0]) * m_nodes_count;
-	estimated_total_memory_used += sizeof(m_child_node_indices[0]) * m_child_node_indices_count;
+	estimated_total_memory_used += sizeof(m_completed_word_indices[0]) * m_nodes_count;
+	estimated_total_memory_used += sizeof(m_subtree_grid_chars[0]) * m_nodes_count;
+	estimated_total_memory_used += sizeof(m_subtree_word_lengths[0]) * m_nodes_count;
 	return estimated_total_memory_used;
 }
 
-size_t c_boggle_dictionary_compact_trie::g_debug_largest_relative_parent_node_index = 0;
-s_boggle_dictionary_compact_trie_node::relative_node_index_t c_boggle_dictionary_compact_trie::get_relative_parent_node_index(
-	const s_boggle_dictionary_compact_trie_node* this_node,
-	const s_boggle_dictionary_compact_trie_node* parent_node)
-{
-	if (this_node == nullptr || parent_node == nullptr)
-		return s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index;
-
-	assert(this_node>parent_node);
-	size_t raw_relative_index = this_node - parent_node;
-	assert(raw_relative_index>s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index);
-	assert(raw_relative_index <= std::numeric_limits<relative_node_index_t>::max());
-
-#if _DEBUG
-	g_debug_largest_relative_parent_node_index = std::max(raw_relative_index, g_debug_largest_relative_parent_node_index);
-#endif
-
-	return static_cast<relative_node_index_t>(raw_relative_index);
-}
-
 size_t c_boggle_dictionary_compact_trie::g_debug_largest_relative_child_node_index = 0;
 s_boggle_dictionary_compact_trie_node::relative_node_index_t c_boggle_dictionary_compact_trie::get_relative_child_node_index(
-	const s_boggle_dictionary_compact_trie_node* this_node,
-	const s_boggle_dictionary_compact_trie_node* child_node)
+	const int node_index,
+	const int child_node_index)
 {
-	if (this_node == nullptr || child_node == nullptr)
+	if (node_index == -1 || child_node_index == -1)
 		return s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index;
 
-	assert(child_node>this_node);
-	size_t raw_relative_index = child_node - this_node;
+	assert(child_node_index>node_index);
+	size_t raw_relative_index = static_cast<size_t>(child_node_index - node_index);
 	assert(raw_relative_index>s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index);
 	assert(raw_relative_index <= std::numeric_limits<relative_node_index_t>::max());
 
@@ -139,14 +184,6 @@ int c_boggle_dictionary_compact_trie::get_index_of_node(
 		: -1;
 }
 
-s_boggle_dictionary_compact_trie_node* c_boggle_dictionary_compact_trie::get_node(
-	const int node_index)
-{
-	assert(node_index >= 0);
-	assert(static_cast<uint32_t>(node_index)<m_nodes_count);
-	return &(m_nodes[node_index]);
-}
-
 const s_boggle_dictionary_compact_trie_node* c_boggle_dictionary_compact_trie::get_node(
 	const int node_index) const
 {
@@ -158,7 +195,7 @@ const s_boggle_dictionary_compact_trie_node* c_boggle_dictionary_compact_trie::g
 bool c_boggle_dictionary_compact_trie::build(
 	const c_boggle_dictionary_trie& source_trie)
 {
-	auto nodes_count_limit = static_cast<size_t>(std::numeric_limits<s_boggle_dictionary_compact_trie_node::child_node_indices_offset_t>::max());
+	auto nodes_count_limit = static_cast<size_t>(std::numeric_limits<int>::max());
 	if (source_trie.get_node_count() > nodes_count_limit)
 	{
 		output_error("dictionary_trie has too many nodes than compact_trie supports: %" PRIuPTR " > %" PRIu64,
@@ -167,73 +204,426 @@ bool c_boggle_dictionary_compact_trie::build(
 		return false;
 	}
 
+	// we may be rebuilt, e.g. from another trie
+	delete_nodes_memory();
+
+	m_source_dictionary = source_trie.get_source_dictionary();
+	m_grid_chars_on_grid = source_trie.get_occuring_grid_chars_flags();
+	m_word_count = source_trie.get_word_count();
 	m_nodes_count = static_cast<uint32_t>(source_trie.get_node_count());
-	m_nodes = new s_boggle_dictionary_compact_trie_node[m_nodes_count];
-	if (!m_nodes)
+	if (!allocate_nodes_memory())
+		return false;
+
+	struct s_pending_node
 	{
-		output_error("c_boggle_dictionary_compact_trie failed to allocate nodes");
+		int src_node_index;
+		int node_index;
+	};
+
+	// Nodes are re-laid out depth first, with each node's children emitted as one contiguous block
+	// of siblings. Each root's subtree ends up as one contiguous range of nodes
+	tracked_vector_t<s_pending_node, _memory_tag_dictionary_trie_builder> pending_nodes;
+	pending_nodes.reserve(source_trie.get_dictionary()->get_longest_word_length() * k_number_of_boggle_grid_characters);
+
+	int next_node_index = 0;
+	auto emit_node = [&](const int src_node_index) -> int
+	{
+		int node_index = next_node_index++;
+		auto src_node = source_trie.get_node(src_node_index);
+		m_nodes[node_index].initialize(src_node);
+		m_completed_word_indices[node_index] = src_node->completed_word_index;
+		return node_index;
+	};
+
+	m_root_indices_actual_count = 0;
+	for (boggle_grid_char_t root_grid_char = 0; root_grid_char < k_number_of_boggle_grid_characters; root_grid_char++)
+	{
+		int src_root_node_index = source_trie.get_root_indices()[root_grid_char];
+		if (src_root_node_index == -1)
+			continue;
+
+		m_root_indices[root_grid_char] = emit_node(src_root_node_index);
+		m_root_indices_actual_count++;
+
+		pending_nodes.push_back({ src_root_node_index, m_root_indices[root_grid_char] });
+		while (!pending_nodes.empty())
+		{
+			auto pending_node = pending_nodes.back();
+			pending_nodes.pop_back();
+
+			auto src_node = source_trie.get_node(pending_node.src_node_index);
+			if (src_node->get_immediate_child_count() == 0)
+				continue;
+
+			int first_child_node_index = next_node_index;
+			m_nodes[pending_node.node_index].first_child_relative_node_index =
+				get_relative_child_node_index(pending_node.node_index, first_child_node_index);
+
+			auto first_child_grid_char = src_node->get_first_grid_char();
+			auto last_child_grid_char = src_node->get_last_grid_char();
+			for (auto child_grid_char = first_child_grid_char; child_grid_char <= last_child_grid_char; child_grid_char++)
+			{
+				if (src_node->contains_immediate_child_grid_char(child_grid_char))
+					emit_node(src_node->child_node_indices[child_grid_char]);
+			}
+
+			// queue the children in reverse so the first child's subtree is laid out closest to its siblings
+			for (auto child_grid_char = last_child_grid_char; child_grid_char >= first_child_grid_char; child_grid_char--)
+			{
+				if (!src_node->contains_immediate_child_grid_char(child_grid_char))
+					continue;
+
+				int child_node_index = first_child_node_index +
+					m_nodes[pending_node.node_index].get_child_rank_unsafe(child_grid_char);
+				pending_nodes.push_back({ src_node->child_node_indices[child_grid_char], child_node_index });
+			}
+		}
+	}
+
+	assert(static_cast<uint32_t>(next_node_index) == m_nodes_count);
+
+	build_subtree_summaries();
+
+	return true;
+}
+
+bool c_boggle_dictionary_compact_trie::build(
+	std::shared_ptr<const c_boggle_dictionary> source_dictionary,
+	const boggle_grid_char_flags_t grid_chars_on_grid)
+{
+	assert(source_dictionary != nullptr);
+
+	if (source_dictionary->is_trie_only())
+	{
+		output_error("c_boggle_dictionary_compact_trie can't build from a trie-only dictionary");
 		return false;
 	}
 
-	m_root_indices = source_trie.get_root_indices();
+	delete_nodes_memory();
+
+	m_source_dictionary = source_dictionary;
+	m_grid_chars_on_grid = grid_chars_on_grid;
+	m_word_count = 0;
+
+#if 1 // #NOTE streaming build, disable to run in reference mode
+	// The words are sorted, so each root grid char's subtree comes from an independent range of
+	// words. The first pass counts each root's nodes so they can all be streamed in parallel
+	// straight into their own range of the final arrays
+	std::array<uint32_t, k_number_of_boggle_grid_characters> root_first_word_indices;
+	std::array<uint32_t, k_number_of_boggle_grid_characters> root_word_counts;
+	std::array<uint32_t, k_number_of_boggle_grid_characters> root_node_counts;
+
+#pragma omp parallel for schedule(dynamic, 1)
+	for (int root_grid_char = 0; root_grid_char < k_number_of_boggle_grid_characters; root_grid_char++)
+	{
+		root_first_word_indices[root_grid_char] = 0;
+		root_word_counts[root_grid_char] = 0;
+		root_node_counts[root_grid_char] = 0;
+		if (!test_bit(grid_chars_on_grid, root_grid_char))
+			continue;
+
+		source_dictionary->get_root_char_word_range(static_cast<boggle_grid_char_t>(root_grid_char),
+			root_first_word_indices[root_grid_char], root_word_counts[root_grid_char]);
 
-	std::vector<s_boggle_dictionary_compact_trie_node::relative_node_index_t> temp_child_node_indices(m_nodes_count);
+		root_node_counts[root_grid_char] = count_streaming_build_nodes(root_first_word_indices[root_grid_char], root_word_counts[root_grid_char]);
+	}
 
-	for (int node_index = 0, nodes_count = static_cast<int>(m_nodes_count)
-		; node_index < nodes_count
-		; node_index++)
+	std::array<uint32_t, k_number_of_boggle_grid_characters> root_first_node_indices;
+	size_t nodes_count = 0;
+	for (int root_grid_char = 0; root_grid_char < k_number_of_boggle_grid_characters; root_grid_char++)
 	{
-		auto src_node = source_trie.get_node(node_index);
-		auto node = get_node(node_index);
-		node->initialize(src_node);
+		root_first_node_indices[root_grid_char] = static_cast<uint32_t>(nodes_count);
+		nodes_count += root_node_counts[root_grid_char];
+	}
+
+	auto nodes_count_limit = static_cast<size_t>(std::numeric_limits<int>::max());
+	if (nodes_count > nodes_count_limit)
+	{
+		output_error("dictionary has too many nodes than compact_trie supports: %" PRIuPTR " > %" PRIu64,
+			nodes_count,
+			nodes_count_limit);
+		return false;
+	}
+
+	m_nodes_count = static_cast<uint32_t>(nodes_count);
+	if (!allocate_nodes_memory())
+		return false;
 
-		auto parent_node = try_get_node(src_node->parent_node_index);
-		node->set_parent_node_index(get_relative_parent_node_index(node, parent_node));
+	uint32_t word_count = 0;
 
-		int child_count = static_cast<int>(src_node->get_immediate_child_count());
-		if (child_count == 0)
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:word_count)
+	for (int root_grid_char = 0; root_grid_char < k_number_of_boggle_grid_characters; root_grid_char++)
+	{
+		if (root_node_counts[root_grid_char] == 0)
 			continue;
 
-		auto first_child_grid_char = src_node->get_first_grid_char();
-		auto last_child_grid_char = src_node->get_last_grid_char();
+		build_streaming(root_first_word_indices[root_grid_char], root_word_counts[root_grid_char],
+			root_first_node_indices[root_grid_char], root_node_counts[root_grid_char],
+			word_count);
+	}
 
-		node->child_node_indices_offset = static_cast<s_boggle_dictionary_compact_trie_node::child_node_indices_offset_t>(temp_child_node_indices.size());
-		assert(static_cast<size_t>(node->child_node_indices_offset) == temp_child_node_indices.size());
+	m_word_count = word_count;
+	m_root_indices_actual_count = 0;
+	for (int root_index : m_root_indices)
+	{
+		if (root_index != -1)
+			m_root_indices_actual_count++;
+	}
 
-		for (int x = 0, child_indices_to_copy = (last_child_grid_char - first_child_grid_char) + 1
-			; x < child_indices_to_copy
-			; x++)
-		{
-			int child_node_index = src_node->child_node_indices[first_child_grid_char + x];
-			auto child_node = try_get_node(child_node_index);
+	return true;
+#else
+	c_boggle_dictionary_trie dictionary_trie(source_dictionary,
+		grid_chars_on_grid);
+
+	if (!dictionary_trie.build())
+		return false;
+
+	m_word_count = dictionary_trie.get_word_count();
+
+	return build(dictionary_trie);
+#endif
+}
+
+uint32_t c_boggle_dictionary_compact_trie::count_streaming_build_nodes(
+	const uint32_t first_word_index,
+	const uint32_t word_count) const
+{
+	uint32_t node_count = 0;
+
+	const char* prev_word_string = nullptr;
+	auto words = m_source_dictionary->begin_words();
+	for (uint32_t word_index = first_word_index; word_index < first_word_index + word_count; word_index++)
+	{
+		auto& word = words[word_index];
+		if (!TEST_FLAGS(m_grid_chars_on_grid, word.grid_chars_in_word_flags))
+			continue;
+
+		// every letter beyond the prefix shared with the previous word is a new node
+		const char* word_string = word.get_string(m_source_dictionary.get());
+		uint32_t prefix_length = prev_word_string != nullptr
+			? c_boggle_dictionary_trie::get_matching_prefix_string_length(prev_word_string, word_string)
+			: 0;
+
+		node_count += word.get_length() - prefix_length;
+		prev_word_string = word_string;
+	}
 
-			temp_child_node_indices.push_back(get_relative_child_node_index(node, child_node));
+	return node_count;
+}
+
+// A node whose subtree is complete, waiting for its parent to close so it can be emitted along
+// with its siblings
+struct s_streaming_build_closed_node
+{
+	boggle_grid_char_t grid_char;
+	int completed_word_index;
+	boggle_grid_char_flags_t child_grid_chars_flags;
+	// post-order index of the node's first child, -1 when this is a leaf
+	int first_child_post_order_index;
+	s_boggle_dictionary_compact_trie_node_subtree_grid_chars subtree_grid_chars;
+	s_boggle_dictionary_compact_trie_node_subtree_word_lengths subtree_word_lengths;
+
+	void initialize(
+		const boggle_grid_char_t grid_char)
+	{
+		this->grid_char = grid_char;
+		completed_word_index = -1;
+		child_grid_chars_flags = 0;
+		first_child_post_order_index = -1;
+		subtree_grid_chars.occuring_grid_chars_flags = 0;
+		subtree_grid_chars.required_grid_chars_flags = k_all_boggle_grid_chars_flags;
+		subtree_word_lengths.shortest_word_length = std::numeric_limits<uint8_t>::max();
+		subtree_word_lengths.longest_word_length = 0;
+	}
+
+	void add_to_subtree(
+		const s_streaming_build_closed_node& child)
+	{
+		subtree_grid_chars.occuring_grid_chars_flags |= child.subtree_grid_chars.occuring_grid_chars_flags;
+		subtree_grid_chars.required_grid_chars_flags &= child.subtree_grid_chars.required_grid_chars_flags;
+		subtree_word_lengths.shortest_word_length =
+			std::min(subtree_word_lengths.shortest_word_length, child.subtree_word_lengths.shortest_word_length);
+		subtree_word_lengths.longest_word_length =
+			std::max(subtree_word_lengths.longest_word_length, child.subtree_word_lengths.longest_word_length);
+	}
+};
+
+// A prefix of the current word, which later words may still add children to
+struct s_streaming_build_open_node
+{
+	s_streaming_build_closed_node node;
+	uint32_t closed_children_count;
+	std::array<s_streaming_build_closed_node, k_number_of_boggle_grid_characters> closed_children;
+};
+
+void c_boggle_dictionary_compact_trie::build_streaming(
+	const uint32_t first_word_index,
+	const uint32_t word_count,
+	const uint32_t first_node_index,
+	const uint32_t node_count,
+	uint32_t& in_out_word_count)
+{
+	// Nodes are emitted post-order: once a prefix closes (the next word no longer shares it) its
+	// children are all known, and get emitted as one contiguous block of siblings. Post-order
+	// indices are mirrored onto the node range, so parents still end up before their children
+	auto get_node_index_from_post_order_index = [first_node_index, node_count](const uint32_t post_order_index) -> uint32_t
+	{
+		assert(post_order_index < node_count);
+		return first_node_index + (node_count - 1 - post_order_index);
+	};
+
+	uint32_t next_post_order_index = 0;
+	auto emit_children = [&](s_streaming_build_open_node& open_node)
+	{
+		// emitted last to first, so once mirrored the block is in grid char order
+		for (uint32_t child_rank = open_node.closed_children_count; child_rank-- > 0; )
+		{
+			auto& closed_child = open_node.closed_children[child_rank];
+			uint32_t post_order_index = next_post_order_index++;
+			uint32_t node_index = get_node_index_from_post_order_index(post_order_index);
+
+			auto& node = m_nodes[node_index];
+			node.private_flags = closed_child.child_grid_chars_flags;
+			SET_BOGGLE_GRID_CHAR_FLAG(node.private_flags, s_boggle_dictionary_compact_trie_node::_private_flags_completes_word_bit,
+				closed_child.completed_word_index >= 0);
+			node.first_child_relative_node_index = closed_child.first_child_post_order_index != -1
+				? static_cast<relative_node_index_t>(post_order_index - closed_child.first_child_post_order_index)
+				: s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index;
+
+			m_completed_word_indices[node_index] = closed_child.completed_word_index;
+			m_subtree_grid_chars[node_index] = closed_child.subtree_grid_chars;
+			m_subtree_word_lengths[node_index] = closed_child.subtree_word_lengths;
 		}
+
+		if (open_node.closed_children_count > 0)
+			open_node.node.first_child_post_order_index = static_cast<int>(next_post_order_index - 1);
+	};
+
+	// the bottom open node is a stand-in parent for the root nodes
+	tracked_vector_t<s_streaming_build_open_node, _memory_tag_dictionary_trie_builder> open_nodes(m_source_dictionary->get_longest_word_length() + 1);
+	uint32_t open_nodes_count = 0;
+	auto open_node = [&](const boggle_grid_char_t grid_char)
+	{
+		auto& open_node = open_nodes[open_nodes_count++];
+		open_node.node.initialize(grid_char);
+		open_node.closed_children_count = 0;
+	};
+	auto close_node = [&]()
+	{
+		assert(open_nodes_count > 1);
+		auto& open_node = open_nodes[--open_nodes_count];
+		emit_children(open_node);
+
+		auto& parent_open_node = open_nodes[open_nodes_count - 1];
+		parent_open_node.closed_children[parent_open_node.closed_children_count++] = open_node.node;
+		parent_open_node.node.child_grid_chars_flags |= BOGGLE_GRID_CHAR_FLAG(open_node.node.grid_char);
+		parent_open_node.node.add_to_subtree(open_node.node);
+	};
+
+	open_node(k_invalid_boggle_grid_char);
+
+	const char* prev_word_string = nullptr;
+	auto words = m_source_dictionary->begin_words();
+	for (uint32_t word_index = first_word_index; word_index < first_word_index + word_count; word_index++)
+	{
+		auto& word = words[word_index];
+		if (!TEST_FLAGS(m_grid_chars_on_grid, word.grid_chars_in_word_flags))
+			continue;
+
+		const char* word_string = word.get_string(m_source_dictionary.get());
+		uint32_t prefix_length = prev_word_string != nullptr
+			? c_boggle_dictionary_trie::get_matching_prefix_string_length(prev_word_string, word_string)
+			: 0;
+		// words are sorted and unique, so the previous word can't extend beyond the shared prefix
+		assert(prefix_length < word.get_length());
+
+		while (open_nodes_count - 1 > prefix_length)
+			close_node();
+
+		for (uint32_t letter_index = prefix_length; letter_index < word.get_length(); letter_index++)
+			open_node(boggle_grid_char_from_character(word_string[letter_index]));
+
+		auto& word_node = open_nodes[open_nodes_count - 1].node;
+		word_node.completed_word_index = static_cast<int>(word_index);
+		word_node.subtree_grid_chars.occuring_grid_chars_flags |= word.grid_chars_in_word_flags;
+		word_node.subtree_grid_chars.required_grid_chars_flags &= word.grid_chars_in_word_flags;
+		// words are sorted, so none of the node's children have been added yet
+		word_node.subtree_word_lengths.shortest_word_length = static_cast<uint8_t>(word.get_length());
+		word_node.subtree_word_lengths.longest_word_length = static_cast<uint8_t>(word.get_length());
+		in_out_word_count++;
+
+		prev_word_string = word_string;
 	}
 
-	m_child_node_indices_count = static_cast<uint32_t>(temp_child_node_indices.size());
-	m_child_node_indices = new s_boggle_dictionary_compact_trie_node::relative_node_index_t[m_child_node_indices_count];
-	if (!m_child_node_indices)
+	while (open_nodes_count > 1)
+		close_node();
+
+	auto& roots_parent_open_node = open_nodes[0];
+	emit_children(roots_parent_open_node);
+	assert(next_post_order_index == node_count);
+
+	for (uint32_t root_rank = 0; root_rank < roots_parent_open_node.closed_children_count; root_rank++)
 	{
-		output_error("c_boggle_dictionary_compact_trie failed to allocate child node indices");
-		return false;
+		uint32_t root_post_order_index = roots_parent_open_node.node.first_child_post_order_index - root_rank;
+		m_root_indices[roots_parent_open_node.closed_children[root_rank].grid_char] =
+			static_cast<int>(get_node_index_from_post_order_index(root_post_order_index));
 	}
+}
+
+void c_boggle_dictionary_compact_trie::build_subtree_summaries()
+{
+	// children are always laid out beyond their parent, so walking the nodes backwards
+	// visits every child before the parent that needs to gather its summary
+	for (int node_index = static_cast<int>(m_nodes_count) - 1; node_index >= 0; node_index--)
+	{
+		auto node = get_node(node_index);
+		auto& subtree_grid_chars = m_subtree_grid_chars[node_index];
+		subtree_grid_chars.occuring_grid_chars_flags = 0;
+		subtree_grid_chars.required_grid_chars_flags = k_all_boggle_grid_chars_flags;
+		auto& subtree_word_lengths = m_subtree_word_lengths[node_index];
+		subtree_word_lengths.shortest_word_length = std::numeric_limits<uint8_t>::max();
+		subtree_word_lengths.longest_word_length = 0;
+
+		if (node->completes_word())
+		{
+			auto word = m_source_dictionary->get_word(m_completed_word_indices[node_index]);
+			assert(word != nullptr);
+
+			subtree_grid_chars.occuring_grid_chars_flags |= word->grid_chars_in_word_flags;
+			subtree_grid_chars.required_grid_chars_flags &= word->grid_chars_in_word_flags;
+			subtree_word_lengths.shortest_word_length = static_cast<uint8_t>(word->get_length());
+			subtree_word_lengths.longest_word_length = static_cast<uint8_t>(word->get_length());
+		}
+
+		for (uint32_t child_rank = 0, child_count = node->get_immediate_child_count()
+			; child_rank < child_count
+			; child_rank++)
+		{
+			int child_node_index = node_index + node->first_child_relative_node_index + child_rank;
+			auto& child_subtree_grid_chars = m_subtree_grid_chars[child_node_index];
 
-	memcpy(m_child_node_indices, temp_child_node_indices.data(),
-		sizeof(m_child_node_indices[0]) * m_child_node_indices_count);
+			subtree_grid_chars.occuring_grid_chars_flags |= child_subtree_grid_chars.occuring_grid_chars_flags;
+			subtree_grid_chars.required_grid_chars_flags &= child_subtree_grid_chars.required_grid_chars_flags;
 
-	return true;
+			auto& child_subtree_word_lengths = m_subtree_word_lengths[child_node_index];
+			subtree_word_lengths.shortest_word_length =
+				std::min(subtree_word_lengths.shortest_word_length, child_subtree_word_lengths.shortest_word_length);
+			subtree_word_lengths.longest_word_length =
+				std::max(subtree_word_lengths.longest_word_length, child_subtree_word_lengths.longest_word_length);
+		}
+	}
 }
 
 void c_boggle_dictionary_compact_trie::dump(
 	std::vector<std::string>& all_words,
 	std::vector<char>& chars,
-	const s_boggle_dictionary_compact_trie_node* node) const
+	const s_boggle_dictionary_compact_trie_node* node,
+	const boggle_grid_char_t grid_char) const
 {
-	const char* grid_char_string = boggle_grid_char_to_string(node->get_grid_char());
+	const char* grid_char_string = boggle_grid_char_to_string(grid_char);
 	chars.push_back(grid_char_string[0]);
 
-	if (node->completed_word_index != -1)
+	if (node->completes_word())
 	{
 		chars.push_back('\0');
 		std::string word(chars.data());
@@ -245,12 +635,22 @@ void c_boggle_dictionary_compact_trie::dump(
 		; iter.next()
 		; )
 	{
-		dump(all_words, chars, iter.get_child_node());
+		dump(all_words, chars, iter.get_child_node(), iter.get_child_grid_char());
 	}
 
 	chars.pop_back();
 }
 
+bool c_boggle_dictionary_compact_trie::has_same_nodes(
+	const c_boggle_dictionary_compact_trie& other) const
+{
+	// the subtree summaries are derived from the nodes and words, so needn't be compared
+	return m_nodes_count == other.m_nodes_count &&
+		m_root_indices == other.m_root_indices &&
+		memcmp(m_nodes, other.m_nodes, sizeof(m_nodes[0]) * m_nodes_count) == 0 &&
+		memcmp(m_completed_word_indices, other.m_completed_word_indices, sizeof(m_completed_word_indices[0]) * m_nodes_count) == 0;
+}
+
 void c_boggle_dictionary_compact_trie::dump(
 	std::vector<std::string>& all_words) const
 {
@@ -260,90 +660,65 @@ void c_boggle_dictionary_compact_trie::dump(
 	// We'll at most end up adding the longest_word_length in chars, plus the null terminator,
 	// so front load the allocation here to avoid reallocations and maintain more consistent memory usage
 	chars.reserve(m_source_dictionary->get_longest_word_length() + 1);
-	for (int root_node_index : m_root_indices)
+	for (boggle_grid_char_t root_grid_char = 0; root_grid_char < k_number_of_boggle_grid_characters; root_grid_char++)
 	{
+		int root_node_index = m_root_indices[root_grid_char];
 		if (root_node_index == -1)
 			continue;
 
-		dump(all_words, chars, get_node(root_node_index));
+		dump(all_words, chars, get_node(root_node_index), root_grid_char);
 		chars.clear();
 	}
 }
 
-const s_boggle_dictionary_compact_trie_node::relative_node_index_t* c_boggle_dictionary_compact_trie::get_child_nodes_pointer(
-	const s_boggle_dictionary_compact_trie_node* node) const
-{
-	assert(node != nullptr);
-
-	if (node->child_node_indices_offset == -1)
-		return nullptr;
-
-	return m_child_node_indices + node->child_node_indices_offset;
-}
-
 int c_boggle_dictionary_compact_trie::get_child_node_index(
-	const s_boggle_dictionary_compact_trie_node* node,
-	const boggle_grid_char_t grid_char)
+	const int node_index,
+	const boggle_grid_char_t grid_char) const
 {
-	auto child_node_indices_pointer = get_child_nodes_pointer(node);
-	if (child_node_indices_pointer == nullptr || !node->contains_immediate_child_grid_char(grid_char))
+	auto node = get_node(node_index);
+	if (!node->contains_immediate_child_grid_char(grid_char))
 		return -1;
 
-	auto first_child_grid_char = node->get_first_grid_char();
-	int child_node_index_offset = grid_char - first_child_grid_char;
-
-	auto relative_child_node_index = child_node_indices_pointer[child_node_index_offset];
-
-	int node_index = get_index_of_node_unsafe(node);
-	int child_node_index = node_index + relative_child_node_index;
+	int child_node_index = node_index + node->first_child_relative_node_index;
+	child_node_index += node->get_child_rank_unsafe(grid_char);
 	return child_node_index;
 }
 
-void c_boggle_dictionary_compact_trie::revert_runtime_changes()
+int c_boggle_dictionary_compact_trie::get_child_node_index(
+	const s_boggle_dictionary_compact_trie_node* node,
+	const boggle_grid_char_t grid_char) const
 {
-	for (uint32_t x = 0; x < m_nodes_count; x++)
-	{
-		auto& node = m_nodes[x];
-
-		node.set_word_found(false);
-	}
+	return get_child_node_index(get_index_of_node_unsafe(node), grid_char);
 }
 
 c_boggle_dictionary_compact_trie_node_child_nodes_iterator::c_boggle_dictionary_compact_trie_node_child_nodes_iterator(
 	const c_boggle_dictionary_compact_trie* trie,
 	const s_boggle_dictionary_compact_trie_node* node)
-	: m_node(node)
 {
 	assert(trie != nullptr);
 	assert(node != nullptr);
-	m_child_nodes_indices_pointer = trie->get_child_nodes_pointer(m_node);
-	m_first_child_grid_char = node->get_first_grid_char();
-	m_last_child_grid_char = node->get_last_grid_char();
+	m_first_child_node = node->first_child_relative_node_index != s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index
+		? node + node->first_child_relative_node_index
+		: nullptr;
+	m_remaining_child_grid_chars_flags = node->get_valid_child_grid_chars_flags();
 	m_child_grid_char = k_invalid_boggle_grid_char;
-	m_child_node_index = s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index;
+	m_child_rank = std::numeric_limits<uint32_t>::max();
 }
 
 bool c_boggle_dictionary_compact_trie_node_child_nodes_iterator::next()
 {
-	if (!m_child_nodes_indices_pointer)
-		return false;
-
-	if (m_child_grid_char == k_invalid_boggle_grid_char)
-		m_child_grid_char = m_node->get_first_grid_char();
-
-	while (m_child_grid_char <= m_last_child_grid_char)
+	if (!m_first_child_node || m_remaining_child_grid_chars_flags == 0)
 	{
-		int child_node_index_offset = m_child_grid_char++ - m_first_child_grid_char;
-
-		m_child_node_index = m_child_nodes_indices_pointer[child_node_index_offset];
-		if (m_child_node_index != s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index)
-		{
-			return true;
-		}
+		m_child_grid_char = k_invalid_boggle_grid_char;
+		return false;
 	}
 
-	m_child_grid_char = m_last_child_grid_char + 1;
-	return false;
+	m_child_grid_char = static_cast<boggle_grid_char_t>(index_of_lowest_bit_set(m_remaining_child_grid_chars_flags));
+	// clear the lowest set bit, which is the child we're now visiting
+	m_remaining_child_grid_chars_flags &= m_remaining_child_grid_chars_flags - 1;
+	m_child_rank++;
+
+	return true;
 }
 
 bool c_boggle_dictionary_compact_trie::write_to_file(
@@ -362,8 +737,6 @@ bool c_boggle_dictionary_compact_trie::write_to_file(
 
 	if (1 != fwrite(&m_nodes_count, sizeof m_nodes_count, 1, file))
 		return false;
-	if (1 != fwrite(&m_child_node_indices_count, sizeof m_child_node_indices_count, 1, file))
-		return false;
 	if (1 != fwrite(&m_root_indices_actual_count, sizeof m_root_indices_actual_count, 1, file))
 		return false;
 
@@ -376,9 +749,21 @@ bool c_boggle_dictionary_compact_trie::write_to_file(
 	if (1 != fwrite(&m_word_count, sizeof m_word_count, 1, file))
 		return false;
 
+	if (!fwrite_alignment_padding(file))
+		return false;
 	if (m_nodes_count != fwrite(m_nodes, sizeof m_nodes[0], m_nodes_count, file))
 		return false;
-	if (m_child_node_indices_count != fwrite(m_child_node_indices, sizeof m_child_node_indices[0], m_child_node_indices_count, file))
+	if (!fwrite_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fwrite(m_completed_word_indices, sizeof m_completed_word_indices[0], m_nodes_count, file))
+		return false;
+	if (!fwrite_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fwrite(m_subtree_grid_chars, sizeof m_subtree_grid_chars[0], m_nodes_count, file))
+		return false;
+	if (!fwrite_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fwrite(m_subtree_word_lengths, sizeof m_subtree_word_lengths[0], m_nodes_count, file))
 		return false;
 
 	return true;
@@ -386,7 +771,7 @@ bool c_boggle_dictionary_compact_trie::write_to_file(
 
 bool c_boggle_dictionary_compact_trie::read_from_file(
 	_iobuf* file,
-	const c_boggle_dictionary* source_dictionary)
+	std::shared_ptr<const c_boggle_dictionary> source_dictionary)
 {
 	if (!file)
 		return false;
@@ -407,12 +792,10 @@ bool c_boggle_dictionary_compact_trie::read_from_file(
 		return false;
 
 	delete_nodes_memory();
-	m_source_dictionary = source_dictionary;
+	m_source_dictionary = std::move(source_dictionary);
 
 	if (1 != fread(&m_nodes_count, sizeof m_nodes_count, 1, file))
 		return false;
-	if (1 != fread(&m_child_node_indices_count, sizeof m_child_node_indices_count, 1, file))
-		return false;
 	if (1 != fread(&m_root_indices_actual_count, sizeof m_root_indices_actual_count, 1, file))
 		return false;
 
@@ -428,23 +811,84 @@ bool c_boggle_dictionary_compact_trie::read_from_file(
 	if (m_word_count != m_source_dictionary->get_words_count())
 		return false;
 
-	m_nodes = new s_boggle_dictionary_compact_trie_node[m_nodes_count];
-	if (!m_nodes)
-	{
+	if (!allocate_nodes_memory())
 		return false;
-	}
 
-	m_child_node_indices = new s_boggle_dictionary_compact_trie_node::relative_node_index_t[m_child_node_indices_count];
-	if (!m_child_node_indices)
-	{
+	if (!fseek_past_alignment_padding(file))
 		return false;
-	}
-
 	if (m_nodes_count != fread(m_nodes, sizeof m_nodes[0], m_nodes_count, file))
 		return false;
-	if (m_child_node_indices_count != fread(m_child_node_indices, sizeof m_child_node_indices[0], m_child_node_indices_count, file))
+	if (!fseek_past_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fread(m_completed_word_indices, sizeof m_completed_word_indices[0], m_nodes_count, file))
+		return false;
+	if (!fseek_past_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fread(m_subtree_grid_chars, sizeof m_subtree_grid_chars[0], m_nodes_count, file))
+		return false;
+	if (!fseek_past_alignment_padding(file))
+		return false;
+	if (m_nodes_count != fread(m_subtree_word_lengths, sizeof m_subtree_word_lengths[0], m_nodes_count, file))
+		return false;
+
+	return true;
+}
+
+bool c_boggle_dictionary_compact_trie::read_from_memory(
+	c_memory_reader& reader,
+	std::shared_ptr<const c_boggle_dictionary> source_dictionary)
+{
+	if (!source_dictionary)
+		return false;
+
+	uint32_t file_signature;
+	if (!reader.read(file_signature))
+		return false;
+
+	uint32_t file_version;
+	if (!reader.read(file_version))
+		return false;
+
+	if (file_signature != k_file_data_signature ||
+		file_version != k_file_data_version)
 		return false;
 
+	delete_nodes_memory();
+	m_source_dictionary = std::move(source_dictionary);
+
+	uint32_t nodes_count;
+	if (!reader.read(nodes_count))
+		return false;
+	if (!reader.read(m_root_indices_actual_count))
+		return false;
+
+	if (!reader.read(m_root_indices))
+		return false;
+
+	if (!reader.read(m_grid_chars_on_grid))
+		return false;
+
+	if (!reader.read(m_word_count))
+		return false;
+
+	if (m_word_count != m_source_dictionary->get_words_count())
+		return false;
+
+	auto nodes = reader.read_array_in_place<s_boggle_dictionary_compact_trie_node>(nodes_count);
+	auto completed_word_indices = reader.read_array_in_place<int>(nodes_count);
+	auto subtree_grid_chars = reader.read_array_in_place<s_boggle_dictionary_compact_trie_node_subtree_grid_chars>(nodes_count);
+	auto subtree_word_lengths = reader.read_array_in_place<s_boggle_dictionary_compact_trie_node_subtree_word_lengths>(nodes_count);
+	if (!nodes || !completed_word_indices || !subtree_grid_chars || !subtree_word_lengths)
+		return false;
+
+	// the memory is never written to, it's only non-const for the sake of the owning case
+	m_owns_nodes_memory = false;
+	m_nodes_count = nodes_count;
+	m_nodes = const_cast<s_boggle_dictionary_compact_trie_node*>(nodes);
+	m_completed_word_indices = const_cast<int*>(completed_word_indices);
+	m_subtree_grid_chars = const_cast<s_boggle_dictionary_compact_trie_node_subtree_grid_chars*>(subtree_grid_chars);
+	m_subtree_word_lengths = const_cast<s_boggle_dictionary_compact_trie_node_subtree_word_lengths*>(subtree_word_lengths);
+
 	return true;
 }
 
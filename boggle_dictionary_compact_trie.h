@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -10,48 +11,78 @@ struct _iobuf;
 
 class c_boggle_dictionary;
 class c_boggle_dictionary_trie;
+class c_memory_reader;
 
 class c_boggle_dictionary_compact_trie
 {
 	enum
 	{
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+		// the nodes are wider, so files aren't interchangeable with the default alphabet
+		k_file_data_signature = 'trix',
+#else
 		k_file_data_signature = 'trie',
-		k_file_data_version = 1,
+#endif
+		k_file_data_version = 5,
 	};
 
 	typedef s_boggle_dictionary_compact_trie_node::relative_node_index_t relative_node_index_t;
 
 	uint32_t m_nodes_count;
-	uint32_t m_child_node_indices_count;
 	uint32_t m_root_indices_actual_count;
 	s_boggle_dictionary_compact_trie_node* m_nodes;
-	relative_node_index_t* m_child_node_indices;
+	// cold data, parallel to m_nodes: index of the dictionary word each node completes, else -1
+	int* m_completed_word_indices;
+	// cold data, parallel to m_nodes
+	s_boggle_dictionary_compact_trie_node_subtree_grid_chars* m_subtree_grid_chars;
+	// cold data, parallel to m_nodes
+	s_boggle_dictionary_compact_trie_node_subtree_word_lengths* m_subtree_word_lengths;
 	std::array<int, k_number_of_boggle_grid_characters> m_root_indices;
+	// false when the nodes and their parallel arrays point into memory we don't own, e.g. a mapped file
+	bool m_owns_nodes_memory;
 
-	const c_boggle_dictionary* m_source_dictionary;
+	// shared, so the words we complete stay valid as long as we do, even once the dictionary is
+	// replaced, e.g. for filtered tries still in use after a hot-swap
+	std::shared_ptr<const c_boggle_dictionary> m_source_dictionary;
 	boggle_grid_char_flags_t m_grid_chars_on_grid;
 	uint32_t m_word_count;
 
 private:
-	static size_t g_debug_largest_relative_parent_node_index;
-	relative_node_index_t get_relative_parent_node_index(
-		const s_boggle_dictionary_compact_trie_node* this_node,
-		const s_boggle_dictionary_compact_trie_node* parent_node);
-
 	static size_t g_debug_largest_relative_child_node_index;
 	relative_node_index_t get_relative_child_node_index(
-		const s_boggle_dictionary_compact_trie_node* this_node,
-		const s_boggle_dictionary_compact_trie_node* child_node);
+		const int node_index,
+		const int child_node_index);
 
 	void dump(
 		std::vector<std::string>& all_words,
 		std::vector<char>& chars,
-		const s_boggle_dictionary_compact_trie_node* node) const;
+		const s_boggle_dictionary_compact_trie_node* node,
+		const boggle_grid_char_t grid_char) const;
+
+	// fills in each node's subtree grid chars and word lengths from its word and children
+	void build_subtree_summaries();
+
+	// number of nodes build_streaming will emit for the words in the given range
+	uint32_t count_streaming_build_nodes(
+		const uint32_t first_word_index,
+		const uint32_t word_count) const;
+
+	// Builds the nodes of the words in the given range, in a single pass over the sorted words,
+	// into the given range of nodes
+	void build_streaming(
+		const uint32_t first_word_index,
+		const uint32_t word_count,
+		const uint32_t first_node_index,
+		const uint32_t node_count,
+		uint32_t& in_out_word_count);
+
+	// allocates the nodes and their parallel arrays, for m_nodes_count nodes
+	bool allocate_nodes_memory();
 
 	void delete_nodes_memory();
 
 public:
-	// for binary file purposes only
+	// for binary file purposes, or building straight from a dictionary
 	c_boggle_dictionary_compact_trie();
 
 	c_boggle_dictionary_compact_trie(
@@ -66,8 +97,6 @@ public:
 	int get_index_of_node(
 		const s_boggle_dictionary_compact_trie_node* node) const;
 
-	s_boggle_dictionary_compact_trie_node* get_node(
-		const int node_index);
 	const s_boggle_dictionary_compact_trie_node* get_node(
 		const int node_index) const;
 
@@ -82,19 +111,68 @@ public:
 	bool build(
 		const c_boggle_dictionary_trie& source_trie);
 
+	// builds straight from the sorted words of the dictionary, using only words made up of the
+	// given grid chars
+	bool build(
+		std::shared_ptr<const c_boggle_dictionary> source_dictionary,
+		const boggle_grid_char_flags_t grid_chars_on_grid);
+
 	void dump(
 		std::vector<std::string>& all_words) const;
 
-	const relative_node_index_t* get_child_nodes_pointer(
-		const s_boggle_dictionary_compact_trie_node* node) const;
+	// are the nodes, and the words they complete, byte for byte the same as the other trie's?
+	bool has_same_nodes(
+		const c_boggle_dictionary_compact_trie& other) const;
+
+	int get_child_node_index(
+		const int node_index,
+		const boggle_grid_char_t grid_char) const;
 
 	int get_child_node_index(
 		const s_boggle_dictionary_compact_trie_node* node,
-		const boggle_grid_char_t grid_char);
+		const boggle_grid_char_t grid_char) const;
 
-	void revert_runtime_changes();
+	int get_completed_word_index(
+		const int node_index) const
+	{
+		assert(static_cast<uint32_t>(node_index) < m_nodes_count);
+		return m_completed_word_indices[node_index];
+	}
+
+	const s_boggle_dictionary_compact_trie_node_subtree_grid_chars& get_subtree_grid_chars(
+		const int node_index) const
+	{
+		assert(static_cast<uint32_t>(node_index) < m_nodes_count);
+		return m_subtree_grid_chars[node_index];
+	}
+
+	const s_boggle_dictionary_compact_trie_node_subtree_word_lengths& get_subtree_word_lengths(
+		const int node_index) const
+	{
+		assert(static_cast<uint32_t>(node_index) < m_nodes_count);
+		return m_subtree_word_lengths[node_index];
+	}
+
+	// hints the cache to load what a solver reads on stepping into the node, its node and cold data.
+	// The subtree word lengths are only read by solves pruning with word length limits
+	void prefetch_node(
+		const int node_index,
+		const bool prefetch_subtree_word_lengths) const
+	{
+		assert(static_cast<uint32_t>(node_index) < m_nodes_count);
+		prefetch_for_read(&m_nodes[node_index]);
+		prefetch_for_read(&m_subtree_grid_chars[node_index]);
+		prefetch_for_read(&m_completed_word_indices[node_index]);
+		if (prefetch_subtree_word_lengths)
+			prefetch_for_read(&m_subtree_word_lengths[node_index]);
+	}
 
 	const c_boggle_dictionary* get_dictionary() const
+	{
+		return m_source_dictionary.get();
+	}
+
+	const std::shared_ptr<const c_boggle_dictionary>& get_source_dictionary() const
 	{
 		return m_source_dictionary;
 	}
@@ -129,17 +207,21 @@ public:
 
 	bool read_from_file(
 		_iobuf* file,
-		const c_boggle_dictionary* source_dictionary);
+		std::shared_ptr<const c_boggle_dictionary> source_dictionary);
+
+	// reads what write_to_file wrote, but the nodes and their parallel arrays are used in place,
+	// so the memory must outlive the trie
+	bool read_from_memory(
+		c_memory_reader& reader,
+		std::shared_ptr<const c_boggle_dictionary> source_dictionary);
 };
 
 class c_boggle_dictionary_compact_trie_node_child_nodes_iterator
 {
-	const s_boggle_dictionary_compact_trie_node* m_node;
-	const s_boggle_dictionary_compact_trie_node::relative_node_index_t* m_child_nodes_indices_pointer;
-	boggle_grid_char_t m_first_child_grid_char;
-	boggle_grid_char_t m_last_child_grid_char;
+	const s_boggle_dictionary_compact_trie_node* m_first_child_node;
+	boggle_grid_char_flags_t m_remaining_child_grid_chars_flags;
 	boggle_grid_char_t m_child_grid_char;
-	s_boggle_dictionary_compact_trie_node::relative_node_index_t m_child_node_index;
+	uint32_t m_child_rank;
 
 public:
 	c_boggle_dictionary_compact_trie_node_child_nodes_iterator(
@@ -155,9 +237,8 @@ public:
 
 	const s_boggle_dictionary_compact_trie_node* get_child_node() const
 	{
-		return m_child_node_index != s_boggle_dictionary_compact_trie_node::k_invalid_relative_node_index
-			? (m_node + m_child_node_index)
+		return m_child_grid_char != k_invalid_boggle_grid_char
+			? (m_first_child_node + m_child_rank)
 			: nullptr;
 	}
 };
-
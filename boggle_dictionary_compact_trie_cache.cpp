@@ -0,0 +1,112 @@
+#include <precompile.h>
+#include <boggle_dictionary_compact_trie_cache.h>
+
+#include <boggle_dictionary_compact_trie.h>
+#include <boggle_resident_dictionary.h>
+
+c_boggle_dictionary_compact_trie_cache::c_boggle_dictionary_compact_trie_cache(
+	const std::shared_ptr<const c_boggle_resident_dictionary>& source_resident_dictionary,
+	const size_t memory_budget)
+	: m_source_dictionary(source_resident_dictionary, source_resident_dictionary->get_dictionary())
+	, m_memory_budget(memory_budget)
+	, m_mutex()
+	, m_entries()
+	, m_entries_lookup()
+	, m_statistics()
+{
+	assert(m_source_dictionary != nullptr);
+}
+
+void c_boggle_dictionary_compact_trie_cache::evict_entries_over_budget()
+{
+	// never evict the most recently used entry, even if it alone is over budget
+	while (m_statistics.total_memory_used > m_memory_budget && m_entries.size() > 1)
+	{
+		auto& entry = m_entries.back();
+
+		m_statistics.total_memory_used -= entry.memory_used;
+		m_statistics.eviction_count++;
+		m_entries_lookup.erase(entry.grid_chars_flags);
+		m_entries.pop_back();
+	}
+
+	m_statistics.entry_count = static_cast<uint32_t>(m_entries.size());
+}
+
+std::shared_ptr<const c_boggle_dictionary_compact_trie> c_boggle_dictionary_compact_trie_cache::get_or_build(
+	const boggle_grid_char_flags_t grid_chars_flags)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto lookup = m_entries_lookup.find(grid_chars_flags);
+		if (lookup != m_entries_lookup.end())
+		{
+			m_statistics.hit_count++;
+			m_entries.splice(m_entries.begin(), m_entries, lookup->second);
+			return lookup->second->trie;
+		}
+
+		m_statistics.miss_count++;
+	}
+
+	// build without holding the lock, so other threads can still hit the cache in the meantime
+	auto trie = std::make_shared<c_boggle_dictionary_compact_trie>();
+	if (!trie->build(m_source_dictionary, grid_chars_flags))
+	{
+		output_error("dictionary trie cache failed to build trie for grid chars %016" PRIx64,
+			static_cast<uint64_t>(grid_chars_flags));
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// another thread may have built the same trie while we were
+	auto lookup = m_entries_lookup.find(grid_chars_flags);
+	if (lookup != m_entries_lookup.end())
+	{
+		m_entries.splice(m_entries.begin(), m_entries, lookup->second);
+		return lookup->second->trie;
+	}
+
+	m_entries.push_front({ grid_chars_flags, trie, trie->estimate_total_memory_used() });
+	m_entries_lookup[grid_chars_flags] = m_entries.begin();
+	m_statistics.total_memory_used += m_entries.front().memory_used;
+
+	evict_entries_over_budget();
+
+	return trie;
+}
+
+void c_boggle_dictionary_compact_trie_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries_lookup.clear();
+	m_entries.clear();
+	m_statistics.total_memory_used = 0;
+	m_statistics.entry_count = 0;
+}
+
+c_boggle_dictionary_compact_trie_cache::s_statistics c_boggle_dictionary_compact_trie_cache::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_statistics;
+}
+
+size_t c_boggle_dictionary_compact_trie_cache::get_memory_budget() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_memory_budget;
+}
+
+void c_boggle_dictionary_compact_trie_cache::set_memory_budget(
+	const size_t memory_budget)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_memory_budget = memory_budget;
+	evict_entries_over_budget();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <inttypes.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <boggle_grid_char.h>
+
+class c_boggle_dictionary;
+class c_boggle_dictionary_compact_trie;
+class c_boggle_resident_dictionary;
+
+// Bounded, least-recently-used cache of compact tries which only contain the words that can be
+// made from a given set of grid chars. Lookups are safe to make from multiple threads, and tries
+// are handed out as shared pointers so they stay alive while in use, even after being evicted.
+// The cache and its tries share ownership of the resident dictionary they're built from, so
+// that stays alive too, even once it's been replaced.
+
+class c_boggle_dictionary_compact_trie_cache
+{
+public:
+	enum : size_t
+	{
+		k_default_memory_budget = 256 * 1024 * 1024,
+	};
+
+	struct s_statistics
+	{
+		uint64_t hit_count;
+		uint64_t miss_count;
+		uint64_t eviction_count;
+		uint32_t entry_count;
+		size_t total_memory_used;
+	};
+
+private:
+	struct s_entry
+	{
+		boggle_grid_char_flags_t grid_chars_flags;
+		std::shared_ptr<const c_boggle_dictionary_compact_trie> trie;
+		size_t memory_used;
+	};
+	typedef std::list<s_entry> entries_t;
+
+	// aliases the resident dictionary, so sharing it keeps the whole resident dictionary alive
+	std::shared_ptr<const c_boggle_dictionary> m_source_dictionary;
+	size_t m_memory_budget;
+
+	mutable std::mutex m_mutex;
+	// ordered from most to least recently used
+	entries_t m_entries;
+	std::unordered_map<boggle_grid_char_flags_t, entries_t::iterator> m_entries_lookup;
+	s_statistics m_statistics;
+
+private:
+	// assumes m_mutex is held
+	void evict_entries_over_budget();
+
+public:
+	c_boggle_dictionary_compact_trie_cache(
+		const std::shared_ptr<const c_boggle_resident_dictionary>& source_resident_dictionary,
+		const size_t memory_budget = k_default_memory_budget);
+
+	// returns nullptr if the trie wasn't cached and failed to build
+	std::shared_ptr<const c_boggle_dictionary_compact_trie> get_or_build(
+		const boggle_grid_char_flags_t grid_chars_flags);
+
+	void clear();
+
+	s_statistics get_statistics() const;
+
+	const c_boggle_dictionary* get_dictionary() const
+	{
+		return m_source_dictionary.get();
+	}
+
+	size_t get_memory_budget() const;
+
+	void set_memory_budget(
+		const size_t memory_budget);
+};
@@ -8,144 +8,130 @@
 struct s_boggle_dictionary_trie_node;
 class c_boggle_dictionary_compact_trie;
 
+// The hot representation of a trie node, which is all the solver touches while walking the trie.
+// A node's children are stored contiguously, in grid char order, so a child is located by
+// ranking its grid char within the child flags instead of through a per-node child index table.
+// Cold data (the index of the word a node completes) lives in side arrays owned by the trie.
 struct s_boggle_dictionary_compact_trie_node
 {
 	enum
 	{
-		_private_flags_word_found_bit,
-		k_number_of_private_flags,
-
-		// english.txt contains 400+ words that result in 112878 nodes the last time
-		// this comment was updated. Meaning we only need 17 bits to represent an
-		// unsigned relative index. Using 18 just to try and handle anything crazy Bungie throws at this
-		k_relative_node_index_bit_count = 18,
-		k_relative_node_index_shift = k_number_of_private_flags,
-		k_relative_node_index_bit_mask = MASK(k_relative_node_index_bit_count),
-
-		k_private_flags_grid_char_shift = 24,
-		k_private_flags_grid_char_mask = MASK(k_number_of_boggle_grid_characters),
+		// the low bits of private_flags are the bitvector of valid child grid chars
+		_private_flags_completes_word_bit = k_number_of_boggle_grid_characters,
+		k_number_of_private_flags_bits,
 	};
 
-	// parent is always >=1 more nodes behind 'this'
 	// children are always >=1 more nodes beyond 'this'
 	typedef uint32_t relative_node_index_t;
-	typedef uint32_t raw_relative_node_index_t;
-	typedef raw_relative_node_index_t private_flags_t;
+	// as wide as the grid char flags, so 64-bit with the extended alphabet
+	typedef boggle_grid_char_flags_t private_flags_t;
 	static const relative_node_index_t k_invalid_relative_node_index = 0;
-
-	typedef int32_t child_node_indices_offset_t;
+	static constexpr private_flags_t k_private_flags_child_grid_chars_mask = k_all_boggle_grid_chars_flags;
 
 	static_assert(
-		(BIT_COUNT(private_flags_t)-k_private_flags_grid_char_shift) >= BIT_COUNT(boggle_grid_char_t),
-		"Cannot encode grid_char into private flags!");
+		k_number_of_private_flags_bits <= BIT_COUNT(private_flags_t),
+		"Cannot encode child grid chars and flags into private flags!");
 
 	private_flags_t private_flags;
-	child_node_indices_offset_t child_node_indices_offset;
-	boggle_grid_char_flags_t valid_child_node_indices_flags;
-	int completed_word_index;
+	// relative index of the first child node, k_invalid_relative_node_index when this is a leaf
+	relative_node_index_t first_child_relative_node_index;
 
 	void initialize(
 		const s_boggle_dictionary_trie_node* src);
 
-	bool is_word_found() const
-	{
-		return test_bit(private_flags, _private_flags_word_found_bit);
-	}
-
-	void set_word_found(
-		const bool found)
-	{
-		if (completed_word_index >= 0)
-		{
-			SET_FLAG(private_flags, _private_flags_word_found_bit, found);
-		}
-	}
-
-	raw_relative_node_index_t get_parent_node_index() const
+	boggle_grid_char_flags_t get_valid_child_grid_chars_flags() const
 	{
-		private_flags_t parent_node_index_bits = private_flags;
-		parent_node_index_bits >>= k_relative_node_index_shift;
-		parent_node_index_bits &= k_relative_node_index_bit_mask;
-		return static_cast<raw_relative_node_index_t>(parent_node_index_bits);
+		return static_cast<boggle_grid_char_flags_t>(private_flags & k_private_flags_child_grid_chars_mask);
 	}
 
-	void set_parent_node_index(
-		const raw_relative_node_index_t parent_node_index)
+	bool completes_word() const
 	{
-		// less-than-OR-equal because 0 is the invalid sentinel, not the max value
-		assert(parent_node_index<=k_relative_node_index_bit_mask ||
-			!"try to increase k_relative_node_index_bit_count");
-
-		private_flags_t parent_node_index_bits = parent_node_index;
-		parent_node_index_bits &= k_relative_node_index_bit_mask;
-		parent_node_index_bits <<= k_relative_node_index_shift;
-		this->private_flags |= parent_node_index_bits;
+		return test_bit(private_flags, _private_flags_completes_word_bit);
 	}
 
-	boggle_grid_char_t get_grid_char() const
+	bool is_leaf() const
 	{
-		private_flags_t grid_char_bits = private_flags;
-		grid_char_bits >>= k_private_flags_grid_char_shift;
-		grid_char_bits &= k_private_flags_grid_char_mask;
-		return static_cast<boggle_grid_char_t>(grid_char_bits);
+		return get_valid_child_grid_chars_flags() == 0;
 	}
 
-	void set_grid_char(
-		const boggle_grid_char_t grid_char)
+	uint32_t get_immediate_child_count() const
 	{
-		private_flags_t grid_char_bits = grid_char;
-		grid_char_bits &= k_private_flags_grid_char_mask;
-		grid_char_bits <<= k_private_flags_grid_char_shift;
-		this->private_flags |= grid_char_bits;
+		return count_number_of_1s_bits(get_valid_child_grid_chars_flags());
 	}
 
-	// parent is always >=1 more nodes behind 'this'
-	s_boggle_dictionary_compact_trie_node* get_parent_node()
+	bool contains_immediate_child_grid_char(
+		const boggle_grid_char_t grid_char) const
 	{
-		auto parent_node_index = get_parent_node_index();
-		return parent_node_index != k_invalid_relative_node_index
-			? (this - parent_node_index)
-			: nullptr;
+		return grid_char != k_invalid_boggle_grid_char
+			&& test_bit(private_flags, grid_char);
 	}
 
-	const s_boggle_dictionary_compact_trie_node* get_parent_node() const
+	// Offset of the grid char's child from the first child node. Doesn't verify the child exists
+	uint32_t get_child_rank_unsafe(
+		const boggle_grid_char_t grid_char) const
 	{
-		auto parent_node_index = get_parent_node_index();
-		return parent_node_index != k_invalid_relative_node_index
-			? (this - parent_node_index)
-			: nullptr;
+		return count_number_of_1s_bits(private_flags & BOGGLE_GRID_CHAR_FLAGS_MASK(grid_char));
 	}
 
-	bool is_root() const
+	boggle_grid_char_t get_first_grid_char() const
 	{
-		return get_parent_node_index() == k_invalid_relative_node_index;
+		return static_cast<boggle_grid_char_t>(index_of_lowest_bit_set(get_valid_child_grid_chars_flags()));
 	}
 
-	bool is_leaf() const
+	boggle_grid_char_t get_last_grid_char() const
 	{
-		return valid_child_node_indices_flags == 0;
+		return static_cast<boggle_grid_char_t>(index_of_highest_bit_set(get_valid_child_grid_chars_flags()));
 	}
+};
 
-	uint32_t get_immediate_child_count() const
+// Cold data summarizing the words completed at or below a node, so solvers can prune subtrees
+// which can't be completed with the grid chars that occur on a given board
+struct s_boggle_dictionary_compact_trie_node_subtree_grid_chars
+{
+	// union of the grid chars in every word at or below the node
+	boggle_grid_char_flags_t occuring_grid_chars_flags;
+	// intersection of the grid chars in every word at or below the node
+	boggle_grid_char_flags_t required_grid_chars_flags;
+
+	// false when no word at or below the node can be completed with the given grid chars
+	bool can_complete_word_with(
+		const boggle_grid_char_flags_t grid_chars_flags) const
 	{
-		return count_number_of_1s_bits(valid_child_node_indices_flags);
+		return TEST_FLAGS(grid_chars_flags, required_grid_chars_flags);
 	}
 
-	bool contains_immediate_child_grid_char(
-		const boggle_grid_char_t grid_char) const
+	// can every word at or below the node be completed with the given grid chars?
+	bool can_complete_all_words_with(
+		const boggle_grid_char_flags_t grid_chars_flags) const
 	{
-		return grid_char != k_invalid_boggle_grid_char
-			&& test_bit(valid_child_node_indices_flags, grid_char);
+		return TEST_FLAGS(grid_chars_flags, occuring_grid_chars_flags);
 	}
+};
 
-	boggle_grid_char_t get_first_grid_char() const
+// Cold data bounding the lengths of the words completed at or below a node, so solvers can prune
+// subtrees whose words are all too short or too long for a solve's word length limits
+struct s_boggle_dictionary_compact_trie_node_subtree_word_lengths
+{
+	// in chars, so a 'qu' cell counts as two. A node's own word, if it completes one, is the
+	// shortest at or below it
+	uint8_t shortest_word_length;
+	uint8_t longest_word_length;
+
+	// false when no word at or below the node can be within the given lengths
+	bool can_complete_word_within(
+		const uint32_t shortest_acceptable_word_length,
+		const uint32_t longest_acceptable_word_length) const
 	{
-		return static_cast<boggle_grid_char_t>(index_of_lowest_bit_set(valid_child_node_indices_flags));
+		return shortest_word_length <= longest_acceptable_word_length &&
+			longest_word_length >= shortest_acceptable_word_length;
 	}
 
-	boggle_grid_char_t get_last_grid_char() const
+	// is every word at or below the node within the given lengths?
+	bool are_all_words_within(
+		const uint32_t shortest_acceptable_word_length,
+		const uint32_t longest_acceptable_word_length) const
 	{
-		return static_cast<boggle_grid_char_t>(index_of_highest_bit_set(valid_child_node_indices_flags));
+		return shortest_word_length >= shortest_acceptable_word_length &&
+			longest_word_length <= longest_acceptable_word_length;
 	}
 };
-
@@ -0,0 +1,210 @@
+#include <precompile.h>
+#include <boggle_dictionary_registry.h>
+
+#include <unordered_set>
+
+#include <boggle_dictionary.h>
+#include <trie_boggle_board_solver.h>
+#include <utilities.h>
+
+c_boggle_dictionary_registry::c_boggle_dictionary_registry()
+	: m_mutex()
+	, m_dictionaries()
+	, m_dictionaries_by_content()
+{
+}
+
+c_boggle_dictionary_registry::resident_dictionary_t c_boggle_dictionary_registry::find_by_content(
+	const s_boggle_resident_dictionary_content_key& content_key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto lookup = m_dictionaries_by_content.find(content_key);
+	if (lookup == m_dictionaries_by_content.end())
+		return nullptr;
+
+	resident_dictionary_t resident_dictionary = lookup->second.lock();
+	if (!resident_dictionary)
+		m_dictionaries_by_content.erase(lookup);
+
+	return resident_dictionary;
+}
+
+bool c_boggle_dictionary_registry::add(
+	const char* id,
+	resident_dictionary_t resident_dictionary)
+{
+	s_boggle_resident_dictionary_content_key content_key = resident_dictionary->get_content_key();
+
+	for (;;)
+	{
+		// another thread may have made the same dictionary resident while we were. Comparing the
+		// contents is done without holding the lock, so solves aren't held up
+		resident_dictionary_t existing_dictionary = find_by_content(content_key);
+		bool share_existing_dictionary = existing_dictionary &&
+			existing_dictionary->has_same_content(*resident_dictionary);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// and may have done so while we were comparing, in which case compare with that one instead
+		auto lookup = m_dictionaries_by_content.find(content_key);
+		if ((lookup != m_dictionaries_by_content.end() ? lookup->second.lock() : nullptr) != existing_dictionary)
+			continue;
+
+		if (share_existing_dictionary)
+		{
+			resident_dictionary = std::move(existing_dictionary);
+		}
+		// #NOTE when the key collides with a different dictionary's, that one keeps the key and ours is
+		// only shared through its id
+		else if (!existing_dictionary)
+		{
+			m_dictionaries_by_content[content_key] = resident_dictionary;
+		}
+
+		m_dictionaries[id] = std::move(resident_dictionary);
+		return true;
+	}
+}
+
+bool c_boggle_dictionary_registry::try_add_by_words(
+	const char* id,
+	const std::vector<std::string>& all_words)
+{
+	resident_dictionary_t resident_dictionary = find_by_content(c_boggle_resident_dictionary::compute_content_key(all_words));
+	// the key only checksums the words, so make sure they really are the same before sharing
+	if (!resident_dictionary ||
+		!resident_dictionary->get_dictionary()->has_legal_words(all_words))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_dictionaries[id] = std::move(resident_dictionary);
+	return true;
+}
+
+bool c_boggle_dictionary_registry::add_from_alphabetically_sorted_array(
+	const char* id,
+	const std::vector<std::string>& all_words)
+{
+	if (!id || *id == '\0')
+	{
+		output_error("add_from_alphabetically_sorted_array passed null or empty id");
+		return false;
+	}
+
+	if (try_add_by_words(id, all_words))
+		return true;
+
+	// build without holding the lock, so solves with other dictionaries aren't held up
+	resident_dictionary_t resident_dictionary = c_boggle_resident_dictionary::create_from_alphabetically_sorted_array(all_words);
+	if (!resident_dictionary)
+	{
+		output_error("add_from_alphabetically_sorted_array failed to build dictionary: %s",
+			id);
+		return false;
+	}
+
+	return add(id, std::move(resident_dictionary));
+}
+
+bool c_boggle_dictionary_registry::add_from_binary_file(
+	const char* id,
+	const char* filename,
+	const s_boggle_resident_dictionary_binary_file_options& options)
+{
+	if (!id || *id == '\0')
+	{
+		output_error("add_from_binary_file passed null or empty id");
+		return false;
+	}
+
+	// a file's content key only checksums its sections, so it's loaded (cheaply, when mapped) to
+	// compare its words with any resident dictionary with the same key, see add
+	resident_dictionary_t resident_dictionary = c_boggle_resident_dictionary::create_from_binary_file(filename, options);
+	if (!resident_dictionary)
+	{
+		output_error("add_from_binary_file failed to load dictionary: %s",
+			id);
+		return false;
+	}
+
+	return add(id, std::move(resident_dictionary));
+}
+
+bool c_boggle_dictionary_registry::remove(
+	const char* id)
+{
+	if (!id)
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// the dictionary itself goes away once the last solve using it finishes
+	return m_dictionaries.erase(id) > 0;
+}
+
+c_boggle_dictionary_registry::resident_dictionary_t c_boggle_dictionary_registry::find(
+	const char* id) const
+{
+	if (!id)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto lookup = m_dictionaries.find(id);
+	return lookup != m_dictionaries.end()
+		? lookup->second
+		: nullptr;
+}
+
+std::vector<std::string> c_boggle_dictionary_registry::get_ids() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<std::string> ids;
+	ids.reserve(m_dictionaries.size());
+	for (auto& entry : m_dictionaries)
+		ids.push_back(entry.first);
+
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+size_t c_boggle_dictionary_registry::estimate_total_memory_used() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::unordered_set<const c_boggle_resident_dictionary*> counted_dictionaries;
+	size_t estimated_total_memory_used = sizeof(*this);
+	for (auto& entry : m_dictionaries)
+	{
+		if (counted_dictionaries.insert(entry.second.get()).second)
+			estimated_total_memory_used += entry.second->estimate_total_memory_used();
+	}
+
+	return estimated_total_memory_used;
+}
+
+bool c_boggle_dictionary_registry::solve_board(
+	const char* id,
+	c_boggle_solve_context& context,
+	std::vector<std::string>* found_words,
+	const int board_width,
+	const int board_height,
+	const char* board_letters) const
+{
+	resident_dictionary_t resident_dictionary = find(id);
+	if (!resident_dictionary)
+	{
+		output_error("solve_board called with an unregistered dictionary: %s",
+			id ? id : "(null)");
+		return false;
+	}
+
+	// solved on the caller's context, so concurrent solves don't share any solving state, and once
+	// it has grown to fit this doesn't allocate
+	return solve_boggle_board(*resident_dictionary, context, found_words, board_width, board_height, board_letters);
+}
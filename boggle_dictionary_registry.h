@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boggle_resident_dictionary.h>
+
+class c_boggle_solve_context;
+
+// Several resident dictionaries, e.g. English, tournament and kid-safe word lists, kept loaded at
+// once and named by id. Dictionaries are immutable and reference counted, so removing or
+// replacing one never pulls it out from under a board being solved with it. Adding the same
+// words or binary file under another id shares the dictionary that's already resident instead
+// of loading a second copy. Safe to use from multiple threads.
+
+class c_boggle_dictionary_registry
+{
+	typedef std::shared_ptr<const c_boggle_resident_dictionary> resident_dictionary_t;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, resident_dictionary_t> m_dictionaries;
+	// every resident dictionary still alive, whether or not it's still registered under any id
+	std::map<s_boggle_resident_dictionary_content_key, std::weak_ptr<const c_boggle_resident_dictionary>>
+		m_dictionaries_by_content;
+
+private:
+	// a dictionary with the same key may still have different content, should the checksums collide
+	resident_dictionary_t find_by_content(
+		const s_boggle_resident_dictionary_content_key& content_key);
+
+	// registers the dictionary under the id, unless an identical one became resident in the
+	// meantime, in which case that one is registered and the given one discarded
+	bool add(
+		const char* id,
+		resident_dictionary_t resident_dictionary);
+
+	// registers the already resident dictionary made from the same words under the id, if any
+	bool try_add_by_words(
+		const char* id,
+		const std::vector<std::string>& all_words);
+
+public:
+	c_boggle_dictionary_registry();
+
+	// ids are replaced if they're already registered
+	bool add_from_alphabetically_sorted_array(
+		const char* id,
+		const std::vector<std::string>& all_words);
+
+	bool add_from_binary_file(
+		const char* id,
+		const char* filename,
+		const s_boggle_resident_dictionary_binary_file_options& options);
+
+	bool remove(
+		const char* id);
+
+	// returns nullptr if no dictionary is registered under the id
+	resident_dictionary_t find(
+		const char* id) const;
+
+	std::vector<std::string> get_ids() const;
+
+	// memory used by the registered dictionaries, counting shared ones once
+	size_t estimate_total_memory_used() const;
+
+	// find all words on the specified board using the dictionary registered under the id, leaving
+	// them in context.get_found_words() (and appending them to found_words, if given). Boards can
+	// be solved concurrently, with the same or different dictionaries, each on its own context.
+	// The context's found words are only valid while the dictionary is resident, so hold on to it
+	// with find to keep them past removing the id
+	bool solve_board(
+		const char* id,
+		c_boggle_solve_context& context,
+		std::vector<std::string>* found_words,
+		const int board_width,
+		const int board_height,
+		const char* board_letters) const;
+};
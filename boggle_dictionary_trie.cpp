@@ -4,8 +4,13 @@
 #include <boggle_dictionary.h>
 #include <boggle_dictionary_word.h>
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+static_assert(sizeof(s_boggle_dictionary_trie_node) == 0xB8,
+	"Unexpected s_boggle_dictionary_trie_node size");
+#else
 static_assert(sizeof(s_boggle_dictionary_trie_node) == 0x78,
 	"Unexpected s_boggle_dictionary_trie_node size");
+#endif
 
 void s_boggle_dictionary_trie_node::initialize(
 	const boggle_grid_char_t grid_char)
@@ -18,22 +23,21 @@ void s_boggle_dictionary_trie_node::initialize(
 }
 
 c_boggle_dictionary_trie::c_boggle_dictionary_trie(
-	const c_boggle_dictionary* source_dictionary,
+	std::shared_ptr<const c_boggle_dictionary> source_dictionary,
 	const boggle_grid_char_flags_t grid_chars_on_grid)
-	: m_source_dictionary(source_dictionary)
+	: m_source_dictionary(std::move(source_dictionary))
 	, m_grid_chars_on_grid(grid_chars_on_grid)
 	, m_root_indices_actual_count(0)
 	, m_nodes()
 	, m_word_count(0)
 {
 	m_root_indices.fill(-1);
-	m_nodes.reserve(estimated_node_count(source_dictionary->get_words_count(), source_dictionary->get_average_word_length()));
 }
 
 size_t c_boggle_dictionary_trie::estimate_total_memory_used() const
 {
 	size_t estimated_total_memory_used = sizeof(*this);
-	// #NOTE not include m_source_dictionary since we don't own its memory
+	// #NOTE not include m_source_dictionary since it's shared, and counted with its owner
 	estimated_total_memory_used += sizeof(m_nodes[0]) * m_nodes.capacity();
 	return estimated_total_memory_used;
 }
@@ -107,11 +111,11 @@ void c_boggle_dictionary_trie::add_word(
 
 	int starting_node_index = -1;
 	uint32_t letter_index = 0;
-	const char* curr_word_string = word.get_string(m_source_dictionary);
+	const char* curr_word_string = word.get_string(m_source_dictionary.get());
 #if 1 // #NOTE optimized adding, disable to run in reference mode
 	if (add_state.prev_word != nullptr)
 	{
-		const char* prev_word_string = add_state.prev_word->get_string(m_source_dictionary);
+		const char* prev_word_string = add_state.prev_word->get_string(m_source_dictionary.get());
 		uint32_t prefix_length = get_matching_prefix_string_length(prev_word_string, curr_word_string);
 		if (prefix_length == 0)
 		{
@@ -194,14 +198,18 @@ const s_boggle_dictionary_trie_node* c_boggle_dictionary_trie::get_node(
 	return &(m_nodes[node_index]);
 }
 
-bool c_boggle_dictionary_trie::build()
+void c_boggle_dictionary_trie::add_words(
+	const uint32_t first_word_index,
+	const uint32_t word_count)
 {
+	m_nodes.reserve(estimated_node_count(word_count, m_source_dictionary->get_average_word_length()));
+
 	s_add_word_state add_state;
 	add_state.prev_word = nullptr;
 	add_state.prev_word_last_node_index = -1;
 
 	auto words = m_source_dictionary->begin_words();
-	for (uint32_t word_index = 0; word_index < m_source_dictionary->get_words_count(); word_index++)
+	for (uint32_t word_index = first_word_index; word_index < first_word_index + word_count; word_index++)
 	{
 		add_word(add_state,
 			words[word_index], word_index);
@@ -210,6 +218,25 @@ bool c_boggle_dictionary_trie::build()
 	// don't bother doing this anymore, worst case with english dictionary the nodes memory is VERY large
 	// and so we'll just end up adding to the app memory high water mark by
 	//m_nodes.shrink_to_fit();
+}
+
+bool c_boggle_dictionary_trie::build()
+{
+	add_words(0, m_source_dictionary->get_words_count());
+
+	return true;
+}
+
+bool c_boggle_dictionary_trie::build(
+	const boggle_grid_char_t root_grid_char)
+{
+	if (root_grid_char == k_invalid_boggle_grid_char)
+		return false;
+
+	uint32_t first_word_index, word_count;
+	m_source_dictionary->get_root_char_word_range(root_grid_char, first_word_index, word_count);
+
+	add_words(first_word_index, word_count);
 
 	return true;
 }
@@ -313,7 +340,7 @@ void c_boggle_dictionary_trie::set_node_child(
 	if (child_node_index != -1)
 	{
 		node->child_node_indices[grid_char] = child_node_index;
-		SET_FLAG(node->valid_child_node_indices_flags, grid_char, true);
+		SET_BOGGLE_GRID_CHAR_FLAG(node->valid_child_node_indices_flags, grid_char, true);
 
 		auto child_node = get_node(child_node_index);
 		assert(child_node->parent_node_index == -1);
@@ -322,7 +349,7 @@ void c_boggle_dictionary_trie::set_node_child(
 	else
 	{
 		node->child_node_indices[grid_char] = -1;
-		SET_FLAG(node->valid_child_node_indices_flags, grid_char, false);
+		SET_BOGGLE_GRID_CHAR_FLAG(node->valid_child_node_indices_flags, grid_char, false);
 	}
 }
 
@@ -330,14 +357,21 @@ int c_boggle_dictionary_trie::get_or_add_child_node_index(
 	const int node_index,
 	const boggle_grid_char_t grid_char)
 {
-	if (grid_char == k_invalid_boggle_grid_char ||
+	if (grid_char == k_invalid_boggle_grid_char)
+		return -1;
+
+	auto node = get_node(node_index);
+
+	// a 'u' following a 'q' is handled by the solver's 'qu' special case, so it doesn't need to be on the grid
+	bool is_u_after_q =
+		grid_char == k_boggle_grid_char_special_case_u &&
+		node->grid_char == k_boggle_grid_char_special_case_q;
+	if (!is_u_after_q &&
 		!test_bit(m_grid_chars_on_grid, grid_char))
 	{
 		return -1;
 	}
 
-	auto node = get_node(node_index);
-
 	int child_node_index = node->child_node_indices[grid_char];
 	if (child_node_index == -1)
 	{
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <boggle_dictionary_trie_node.h>
+#include <tracked_memory.h>
 
 struct _iobuf;
 
@@ -22,11 +24,11 @@ class c_boggle_dictionary_trie
 		int prev_word_last_node_index;
 	};
 
-	const c_boggle_dictionary* m_source_dictionary;
+	std::shared_ptr<const c_boggle_dictionary> m_source_dictionary;
 	const boggle_grid_char_flags_t m_grid_chars_on_grid;
 	uint32_t m_root_indices_actual_count;
 	std::array<int, k_number_of_boggle_grid_characters> m_root_indices;
-	std::vector<s_boggle_dictionary_trie_node> m_nodes;
+	tracked_vector_t<s_boggle_dictionary_trie_node, _memory_tag_dictionary_trie_builder> m_nodes;
 	uint32_t m_word_count;
 
 private:
@@ -43,6 +45,10 @@ private:
 		const s_boggle_dictionary_word& word,
 		const size_t word_index);
 
+	void add_words(
+		const uint32_t first_word_index,
+		const uint32_t word_count);
+
 	int add_node(
 		const boggle_grid_char_t grid_char);
 
@@ -66,7 +72,7 @@ private:
 
 public:
 	c_boggle_dictionary_trie(
-		const c_boggle_dictionary* source_dictionary,
+		std::shared_ptr<const c_boggle_dictionary> source_dictionary,
 		const boggle_grid_char_flags_t grid_chars_on_grid);
 
 	size_t estimate_total_memory_used() const;
@@ -77,6 +83,10 @@ public:
 
 	bool build();
 
+	// only builds the subtree of the given root grid char
+	bool build(
+		const boggle_grid_char_t root_grid_char);
+
 	void dump(
 		std::vector<std::string>& all_words) const;
 
@@ -100,6 +110,11 @@ public:
 		const boggle_grid_char_t grid_char);
 
 	const c_boggle_dictionary* get_dictionary() const
+	{
+		return m_source_dictionary.get();
+	}
+
+	const std::shared_ptr<const c_boggle_dictionary>& get_source_dictionary() const
 	{
 		return m_source_dictionary;
 	}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+#include <bit_vectors.h>
+#include <boggle_dictionary.h>
+#include <boggle_dictionary_word.h>
+
+// The words found on a board, left as a bit per dictionary word rather than made into strings.
+// Reusing one from board to board doesn't allocate once it's grown to the dictionary's size
+
+struct s_boggle_found_words
+{
+	// the dictionary the bits index into
+	const c_boggle_dictionary* dictionary;
+	// set for each word found, so in dictionary (alphabetical) order
+	std::vector<uint32_t> flags;
+	uint32_t count;
+	// trie-only dictionaries have no word strings, so their found words are named here instead,
+	// in the same order as flags. Packed back to back, each with its terminator, so reusing one
+	// doesn't allocate a string per word
+	std::vector<char> words_from_paths_chars;
+	std::vector<uint32_t> words_from_paths_offsets;
+};
+
+// calls word_callback(word_index, string, length) for each found word, in dictionary order. Stops
+// scanning the bits once the last found word has been seen
+template<
+	typename TWordCallback>
+void for_each_boggle_found_word(
+	const s_boggle_found_words& found_words,
+	const TWordCallback& word_callback)
+{
+	const c_boggle_dictionary* dictionary = found_words.dictionary;
+	uint32_t words_count = dictionary->get_words_count();
+	uint32_t found_word_number = 0;
+
+	for ( c_bit_vector_dword_bit_filtered_iterator iter(found_words.flags.data(), words_count)
+		; found_word_number < found_words.count && iter.next()
+		; found_word_number++)
+	{
+		uint32_t word_index = iter.get_bit_index();
+		if (dictionary->is_trie_only())
+		{
+			uint32_t word_offset = found_words.words_from_paths_offsets[found_word_number];
+			uint32_t word_end = found_word_number + 1 < found_words.count
+				? found_words.words_from_paths_offsets[found_word_number + 1]
+				: static_cast<uint32_t>(found_words.words_from_paths_chars.size());
+			word_callback(word_index, &found_words.words_from_paths_chars[word_offset], word_end - word_offset - 1);
+		}
+		else
+		{
+			auto word = dictionary->get_word(static_cast<int>(word_index));
+			word_callback(word_index, dictionary->get_string(*word), word->get_length());
+		}
+	}
+}
@@ -2,9 +2,15 @@
 #include <boggle_grid.h>
 
 #include <boggle_grid_cell.h>
+#include <tracked_memory.h>
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+static_assert(sizeof(s_boggle_grid_cell) == 0x10,
+	"Unexpected s_boggle_grid_cell size");
+#else
 static_assert(sizeof(s_boggle_grid_cell) == 0x8,
 	"Unexpected s_boggle_grid_cell size");
+#endif
 
 // #TODO MSVC++ is generating dynamic initializers for these when using numeric_limits, which are constexpr, instead of literals via C MAX macros :|
 const boggle_grid_cell_axis_index_t k_invalid_boggle_grid_cell_axis_index = std::numeric_limits<boggle_grid_cell_axis_index_t>::max();
@@ -40,7 +46,7 @@ void s_boggle_grid_cell::build_neighbor_chars_data(
 		if (neighbor_cell == nullptr)
 			continue;
 
-		SET_FLAG(neighbor_grid_chars_flags, neighbor_cell->grid_char, true);
+		SET_BOGGLE_GRID_CHAR_FLAG(neighbor_grid_chars_flags, neighbor_cell->grid_char, true);
 	}
 }
 
@@ -73,7 +79,10 @@ c_boggle_grid::c_boggle_grid(
 	: m_dimensions({width, height})
 	, m_occuring_grid_chars_flags(0)
 	, m_cell_count(0)
+	, m_qu_cell_count(0)
+	, m_cell_capacity(0)
 	, m_cells(nullptr)
+	, m_cells_built(false)
 {
 }
 
@@ -81,8 +90,9 @@ c_boggle_grid::~c_boggle_grid()
 {
 	if (m_cells)
 	{
-		delete[] m_cells;
+		tracked_delete_array(_memory_tag_grid, m_cells);
 		m_cell_count = 0;
+		m_cell_capacity = 0;
 		m_cells = nullptr;
 	}
 }
@@ -90,18 +100,41 @@ c_boggle_grid::~c_boggle_grid()
 size_t c_boggle_grid::estimate_total_memory_used() const
 {
 	size_t estimated_total_memory_used = sizeof(*this);
-	estimated_total_memory_used += sizeof(m_cells[0]) + m_cell_count;
+	estimated_total_memory_used += sizeof(m_cells[0]) * m_cell_capacity;
 	return estimated_total_memory_used;
 }
 
+void c_boggle_grid::resize(
+	const int width,
+	const int height)
+{
+	if (width == m_dimensions.x && height == m_dimensions.y)
+		return;
+
+	m_dimensions = { width, height };
+	m_cells_built = false;
+}
+
 bool c_boggle_grid::build_cells_for_row_major_order()
 {
-	m_cell_count = static_cast<size_t>(m_dimensions.x * m_dimensions.y);
-	m_cells = new s_boggle_grid_cell[m_cell_count];
-	if (!m_cells)
+	// the neighbors only depend on the dimensions, so they carry over from the last board
+	if (m_cells_built)
+		return true;
+
+	m_cell_count = static_cast<uint32_t>(m_dimensions.x * m_dimensions.y);
+	if (m_cell_count > m_cell_capacity)
 	{
-		output_error("Failed to allocate enough memory for grid cells");
-		return false;
+		tracked_delete_array(_memory_tag_grid, m_cells);
+		m_cell_capacity = 0;
+
+		m_cells = tracked_new_array<s_boggle_grid_cell>(_memory_tag_grid, m_cell_count);
+		if (!m_cells)
+		{
+			output_error("Failed to allocate enough memory for grid cells");
+			m_cell_count = 0;
+			return false;
+		}
+		m_cell_capacity = m_cell_count;
 	}
 
 	uint32_t index = 0;
@@ -118,6 +151,7 @@ bool c_boggle_grid::build_cells_for_row_major_order()
 		}
 	}
 
+	m_cells_built = true;
 	return true;
 }
 
@@ -170,6 +204,9 @@ bool c_boggle_grid::set_grid_characters(
 	if (!build_cells_for_row_major_order())
 		return false;
 
+	m_occuring_grid_chars_flags = 0;
+	m_qu_cell_count = 0;
+
 	size_t board_letters_size = 0;
 	for ( uint32_t letter_index = 0, cell_index = 0
 		; board_letters[letter_index] != '\0' && board_letters_size <= m_cell_count
@@ -192,7 +229,9 @@ bool c_boggle_grid::set_grid_characters(
 		}
 
 		cell.grid_char = grid_char;
-		SET_FLAG(m_occuring_grid_chars_flags, grid_char, true);
+		SET_BOGGLE_GRID_CHAR_FLAG(m_occuring_grid_chars_flags, grid_char, true);
+		if (grid_char == k_boggle_grid_char_special_case_q)
+			m_qu_cell_count++;
 	}
 
 	if (board_letters_size != m_cell_count)
@@ -9,7 +9,13 @@ class c_boggle_grid
 	s_point2d m_dimensions;
 	boggle_grid_char_flags_t m_occuring_grid_chars_flags;
 	uint32_t m_cell_count;
+	// 'q' cells spell "qu", so each adds an extra char to the words through it
+	uint32_t m_qu_cell_count;
+	// cells allocated, which may be more than the current dimensions need after a resize
+	uint32_t m_cell_capacity;
 	s_boggle_grid_cell* m_cells;
+	// are the cells' positions and neighbors built for the current dimensions?
+	bool m_cells_built;
 
 private:
 	bool build_cells_for_row_major_order();
@@ -27,6 +33,12 @@ public:
 
 	size_t estimate_total_memory_used() const;
 
+	// reshapes the grid for another board, ahead of set_grid_characters. The cells are only
+	// reallocated when there are more of them than any earlier board needed
+	void resize(
+		const int width,
+		const int height);
+
 	bool set_grid_characters(
 		const char* board_letters);
 
@@ -64,6 +76,12 @@ public:
 		return m_cell_count;
 	}
 
+	// the longest word a path through every cell could spell, in chars
+	uint32_t get_longest_possible_word_length() const
+	{
+		return m_cell_count + m_qu_cell_count;
+	}
+
 	s_boggle_grid_cell* begin_cells()
 	{
 		return m_cells;
@@ -23,6 +23,32 @@ void fill_boggle_grid_char_frequencies_with_english_stats();
 // private globals
 static bool boggle_grid_char_definitions_initialized;
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+// Latin-1 lower case letters used by our Spanish, German and Nordic word lists, in ascending
+// order so words sort in the same order as their grid chars
+static const uint8_t k_boggle_grid_char_extended_letters[] =
+{
+	0xDF, // ß
+	0xE1, // á
+	0xE4, // ä
+	0xE5, // å
+	0xE6, // æ
+	0xE9, // é
+	0xED, // í
+	0xF1, // ñ
+	0xF3, // ó
+	0xF6, // ö
+	0xF8, // ø
+	0xFA, // ú
+	0xFC, // ü
+};
+static_assert(_countof(k_boggle_grid_char_extended_letters) == k_boggle_grid_char_extended_letter_count,
+	"k_boggle_grid_char_extended_letter_count needs to be updated");
+#endif
+
+// decoded characters which have no single byte form
+static const char k_unrepresentable_character = static_cast<char>(0xFF);
+
 
 // Traits for how characters are represented in our Boggle board models
 struct boggle_grid_char_definitions
@@ -35,7 +61,8 @@ struct boggle_grid_char_definitions
 
 	typedef char character_string_t[k_character_string_size];
 
-	static std::array<boggle_grid_char_t, CHAR_MAX>
+	// indexed by the character's unsigned value
+	static std::array<boggle_grid_char_t, UCHAR_MAX + 1>
 		k_ascii_char_to_grid_char_table;
 	static std::array<character_string_t, k_number_of_boggle_grid_characters>
 		k_grid_char_to_ascii_string_table;
@@ -51,7 +78,7 @@ struct boggle_grid_char_definitions
 		character_string[0] = character;
 		character_string[1] = '\0';
 
-		k_ascii_char_to_grid_char_table[character] = grid_char_index_cursor;
+		k_ascii_char_to_grid_char_table[static_cast<uint8_t>(character)] = grid_char_index_cursor;
 
 		ascii_string_table_index++;
 		grid_char_index_cursor++;
@@ -70,7 +97,7 @@ struct boggle_grid_char_definitions
 	}
 };
 
-std::array<boggle_grid_char_t, CHAR_MAX>
+std::array<boggle_grid_char_t, UCHAR_MAX + 1>
 	boggle_grid_char_definitions::k_ascii_char_to_grid_char_table;
 std::array<boggle_grid_char_definitions::character_string_t, k_number_of_boggle_grid_characters>
 	boggle_grid_char_definitions::k_grid_char_to_ascii_string_table;
@@ -98,6 +125,15 @@ void boggle_grid_char_definitions_initialize()
 		k_boggle_grid_char_lower_case_letter_start,
 		k_boggle_grid_char_lower_case_letter_end);
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	for (uint8_t extended_letter : k_boggle_grid_char_extended_letters)
+	{
+		boggle_grid_char_definitions::add_character(
+			ascii_string_table_index, grid_char_index_cursor,
+			static_cast<char>(extended_letter));
+	}
+#endif
+
 	boggle_grid_char_definitions_initialized = true;
 
 	k_boggle_grid_char_special_case_q = boggle_grid_char_from_character('q');
@@ -135,7 +171,7 @@ bool boggle_grid_char_is_valid_character(
 		return true;
 	}
 
-	char char_lower_case = tolower(character);
+	char char_lower_case = boggle_grid_char_character_to_lower(character);
 
 	if (char_lower_case >= k_boggle_grid_char_lower_case_letter_start &&
 		char_lower_case <= k_boggle_grid_char_lower_case_letter_end)
@@ -143,9 +179,140 @@ bool boggle_grid_char_is_valid_character(
 		return true;
 	}
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	if (std::binary_search(std::begin(k_boggle_grid_char_extended_letters), std::end(k_boggle_grid_char_extended_letters),
+		static_cast<uint8_t>(char_lower_case)))
+	{
+		return true;
+	}
+#endif
+
 	return false;
 }
 
+char boggle_grid_char_character_to_lower(
+	const char character)
+{
+	uint8_t byte = static_cast<uint8_t>(character);
+
+	if (byte >= 'A' && byte <= 'Z')
+		return static_cast<char>(byte + ('a' - 'A'));
+
+	// Latin-1's upper case letters are 0x20 below their lower case forms, except for the
+	// multiplication sign and ß, which has no upper case form
+	if (byte >= 0xC0 && byte <= 0xDE && byte != 0xD7)
+		return static_cast<char>(byte + 0x20);
+
+	return character;
+}
+
+size_t boggle_grid_char_character_from_utf8(
+	const char* utf8,
+	char& out_character)
+{
+	auto bytes = reinterpret_cast<const uint8_t*>(utf8);
+	if (bytes[0] == 0)
+		return 0;
+
+	if (bytes[0] < 0x80)
+	{
+		out_character = boggle_grid_char_character_to_lower(static_cast<char>(bytes[0]));
+		return 1;
+	}
+
+	size_t sequence_length =
+		(bytes[0] & 0xE0) == 0xC0 ? 2 :
+		(bytes[0] & 0xF0) == 0xE0 ? 3 :
+		(bytes[0] & 0xF8) == 0xF0 ? 4 :
+		1; // stray continuation byte, or not UTF-8 at all
+
+	uint32_t code_point = sequence_length > 1
+		? bytes[0] & (0x7F >> sequence_length)
+		: UINT32_MAX;
+	for (size_t byte_index = 1; byte_index < sequence_length; byte_index++)
+	{
+		if ((bytes[byte_index] & 0xC0) != 0x80)
+		{
+			// truncated sequence, consume what we have of it
+			sequence_length = byte_index;
+			code_point = UINT32_MAX;
+			break;
+		}
+
+		code_point = (code_point << 6) | (bytes[byte_index] & 0x3F);
+	}
+
+	out_character = code_point <= UCHAR_MAX
+		? boggle_grid_char_character_to_lower(static_cast<char>(code_point))
+		: k_unrepresentable_character;
+	return sequence_length;
+}
+
+void boggle_grid_char_character_to_utf8(
+	const char character,
+	std::string& out_utf8)
+{
+	uint8_t byte = static_cast<uint8_t>(character);
+
+	if (byte < 0x80)
+	{
+		out_utf8.push_back(character);
+		return;
+	}
+
+	out_utf8.push_back(static_cast<char>(0xC0 | (byte >> 6)));
+	out_utf8.push_back(static_cast<char>(0x80 | (byte & 0x3F)));
+}
+
+void boggle_grid_char_string_from_utf8(
+	const char* utf8,
+	std::string& out_string)
+{
+	out_string.clear();
+
+	char character;
+	for (size_t sequence_length; (sequence_length = boggle_grid_char_character_from_utf8(utf8, character)) != 0; utf8 += sequence_length)
+	{
+		out_string.push_back(character);
+	}
+}
+
+void boggle_grid_char_string_to_utf8(
+	const char* string,
+	std::string& out_utf8)
+{
+	out_utf8.clear();
+
+	for (; *string != '\0'; string++)
+	{
+		boggle_grid_char_character_to_utf8(*string, out_utf8);
+	}
+}
+
+size_t boggle_grid_char_string_to_utf8(
+	const char* string,
+	const size_t length,
+	char* out_utf8)
+{
+	char* utf8 = out_utf8;
+
+	for (size_t char_index = 0; char_index < length; char_index++)
+	{
+		uint8_t byte = static_cast<uint8_t>(string[char_index]);
+		if (byte < 0x80)
+		{
+			*utf8++ = static_cast<char>(byte);
+		}
+		else
+		{
+			*utf8++ = static_cast<char>(0xC0 | (byte >> 6));
+			*utf8++ = static_cast<char>(0x80 | (byte & 0x3F));
+		}
+	}
+
+	return static_cast<size_t>(utf8 - out_utf8);
+}
+
 const char* boggle_grid_char_to_string(
 	const boggle_grid_char_t grid_char_index)
 {
@@ -164,9 +331,7 @@ boggle_grid_char_t boggle_grid_char_from_character(
 {
 	assert(boggle_grid_char_definitions_initialized);
 
-	char lower_case_char = tolower(character);
-
-	boggle_grid_char_t grid_char_index = boggle_grid_char_definitions::k_ascii_char_to_grid_char_table[character];
+	boggle_grid_char_t grid_char_index = boggle_grid_char_definitions::k_ascii_char_to_grid_char_table[static_cast<uint8_t>(character)];
 
 	return grid_char_index;
 }
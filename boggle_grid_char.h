@@ -2,9 +2,19 @@
 
 #include <inttypes.h>
 #include <array>
+#include <string>
 
 #include <utilities.h>
 
+// #NOTE enable to support alphabets beyond the 26 lower case ASCII letters, e.g. for Spanish,
+// German and Nordic word lists. Grid char flags become 64-bit, and so do trie nodes, so it's a
+// build option rather than something English boards should pay for.
+// Extended letters are a single Latin-1 byte wherever grid chars are strings (dictionary words,
+// board letters, found words). Text files are UTF-8, and are converted as they're read and written
+#ifndef BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	#define BOGGLE_GRID_CHAR_EXTENDED_ALPHABET 0
+#endif
+
 enum e_boggle_grid_char_constants
 {
 	k_boggle_grid_char_lower_case_letter_start = 'a',
@@ -12,8 +22,18 @@ enum e_boggle_grid_char_constants
 	k_boggle_grid_char_lower_case_letter_count =
 		(k_boggle_grid_char_lower_case_letter_end - k_boggle_grid_char_lower_case_letter_start) + 1,
 
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	// see k_boggle_grid_char_extended_letters
+	k_boggle_grid_char_extended_letter_count = 13,
+#else
+	k_boggle_grid_char_extended_letter_count = 0,
+#endif
+
 	k_number_of_boggle_grid_characters =
-		k_boggle_grid_char_lower_case_letter_count,
+		k_boggle_grid_char_lower_case_letter_count + k_boggle_grid_char_extended_letter_count,
+
+	// in bytes, as every character a grid char can be is ASCII or Latin-1
+	k_boggle_grid_char_longest_utf8_length = 2,
 };
 
 // Represents the ID of a character that can appear in the grid.
@@ -23,13 +43,27 @@ typedef int8_t boggle_grid_char_t;
 // each bit in this bitvector marks whether that grid character is on or off for the flag's uses
 // E.g., we'd want a lightweight bitvector representing which characters actually appear in our
 // input grid. So characters that don't appear would have their ID-bit set to zero.
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+typedef uint64_t boggle_grid_char_flags_t;
+#else
 typedef uint32_t boggle_grid_char_flags_t;
+#endif
+
+#define BOGGLE_GRID_CHAR_FLAG(grid_char) (static_cast<boggle_grid_char_flags_t>(1) << (grid_char))
+#define SET_BOGGLE_GRID_CHAR_FLAG(f, grid_char, v) ((v) ? ((f)|=BOGGLE_GRID_CHAR_FLAG(grid_char)) : ((f)&=~BOGGLE_GRID_CHAR_FLAG(grid_char)))
+// flags of every grid char below the given count
+#define BOGGLE_GRID_CHAR_FLAGS_MASK(count) ( BOGGLE_GRID_CHAR_FLAG(count) - 1 )
+
+// flags of every possible grid char
+constexpr boggle_grid_char_flags_t k_all_boggle_grid_chars_flags =
+	BOGGLE_GRID_CHAR_FLAGS_MASK(k_number_of_boggle_grid_characters);
 
 static_assert(
 	std::numeric_limits<boggle_grid_char_t>::max() >= k_number_of_boggle_grid_characters,
 	"boggle_grid_char_t cannot map to all possible grid characters");
+// strictly greater, so there's always room for at least one more flag (see s_boggle_dictionary_compact_trie_node)
 static_assert(
-	BIT_COUNT(boggle_grid_char_flags_t) >= k_number_of_boggle_grid_characters,
+	BIT_COUNT(boggle_grid_char_flags_t) > k_number_of_boggle_grid_characters,
 	"boggle_grid_char_flags_t cannot represent a bitvector of all possible grid characters");
 
 // Invalid ID that maps to no character
@@ -52,6 +86,40 @@ bool boggle_grid_char_is_valid_character(
 	// assumed printable character
 	const char character);
 
+// lower cases ASCII and Latin-1 letters
+char boggle_grid_char_character_to_lower(
+	const char character);
+
+// Decodes the next character of a UTF-8 string, lower cased, into the single byte grid chars are
+// named with. Returns how many bytes were consumed, 0 at the end of the string. Characters which
+// can't be represented come out as a 0xFF byte, which is never a valid grid char's character
+size_t boggle_grid_char_character_from_utf8(
+	const char* utf8,
+	char& out_character);
+
+// Appends the UTF-8 form of a character, as named by boggle_grid_char_to_string
+void boggle_grid_char_character_to_utf8(
+	const char character,
+	std::string& out_utf8);
+
+// decodes a whole UTF-8 string with boggle_grid_char_character_from_utf8
+void boggle_grid_char_string_from_utf8(
+	const char* utf8,
+	std::string& out_string);
+
+// encodes a whole string with boggle_grid_char_character_to_utf8
+void boggle_grid_char_string_to_utf8(
+	const char* string,
+	std::string& out_utf8);
+
+// encodes length chars of the string in place, for writers formatting straight into their buffers.
+// out_utf8 needs room for length * k_boggle_grid_char_longest_utf8_length bytes. Returns the
+// number of bytes written
+size_t boggle_grid_char_string_to_utf8(
+	const char* string,
+	const size_t length,
+	char* out_utf8);
+
 const char* boggle_grid_char_to_string(
 	const boggle_grid_char_t grid_char_index);
 
@@ -0,0 +1,175 @@
+#include <precompile.h>
+#include <boggle_merged_dictionary.h>
+
+#include <bit_vectors.h>
+#include <boggle_dictionary.h>
+#include <boggle_dictionary_word.h>
+#include <boggle_found_words.h>
+#include <boggle_resident_dictionary.h>
+#include <boggle_solve_context.h>
+#include <trie_boggle_board_solver.h>
+
+c_boggle_merged_dictionary::c_boggle_merged_dictionary()
+	: m_resident_dictionary()
+	, m_source_dictionaries_count(0)
+	, m_words_source_dictionaries_flags()
+{
+}
+
+std::shared_ptr<const c_boggle_merged_dictionary> c_boggle_merged_dictionary::create(
+	const std::vector<std::shared_ptr<const c_boggle_resident_dictionary>>& source_dictionaries)
+{
+	if (source_dictionaries.empty() || source_dictionaries.size() > k_max_source_dictionaries)
+	{
+		output_error("c_boggle_merged_dictionary::create given %d dictionaries, it can merge 1 to %d",
+			static_cast<int>(source_dictionaries.size()), static_cast<int>(k_max_source_dictionaries));
+		return nullptr;
+	}
+
+	std::vector<const c_boggle_dictionary*> dictionaries;
+	uint64_t string_pool_size_upper_bound = 0;
+	for (auto& source_dictionary : source_dictionaries)
+	{
+		auto dictionary = source_dictionary ? source_dictionary->get_dictionary() : nullptr;
+		if (!dictionary || dictionary->is_trie_only())
+		{
+			output_error("c_boggle_merged_dictionary::create given a null or trie-only dictionary");
+			return nullptr;
+		}
+
+		dictionaries.push_back(dictionary);
+		for (auto word = dictionary->begin_words(), end = dictionary->end_words(); word != end; ++word)
+		{
+			string_pool_size_upper_bound += word->get_length() + 1;
+		}
+	}
+
+	if (string_pool_size_upper_bound == 0 || string_pool_size_upper_bound > std::numeric_limits<uint32_t>::max())
+	{
+		output_error("c_boggle_merged_dictionary::create given dictionaries with no words, or too many");
+		return nullptr;
+	}
+
+	std::shared_ptr<c_boggle_merged_dictionary> merged_dictionary(new c_boggle_merged_dictionary);
+	merged_dictionary->m_source_dictionaries_count = static_cast<uint32_t>(dictionaries.size());
+
+	char* string_pool = tracked_new_array<char>(_memory_tag_dictionary, static_cast<size_t>(string_pool_size_upper_bound));
+	if (!string_pool)
+	{
+		output_error("c_boggle_merged_dictionary::create failed to allocate string pool");
+		return nullptr;
+	}
+	uint32_t string_pool_size = 0;
+	tracked_vector_t<uint32_t, _memory_tag_dictionary> word_string_pool_offsets;
+
+	// every dictionary's words are sorted, so merging them in order, with the words in more than
+	// one dictionary only added once, leaves the merged words sorted too
+	std::array<uint32_t, k_max_source_dictionaries> dictionaries_word_index;
+	dictionaries_word_index.fill(0);
+	while (true)
+	{
+		const char* lowest_word_string = nullptr;
+		uint32_t lowest_word_length = 0;
+		source_dictionaries_flags_t lowest_word_dictionaries_flags = 0;
+
+		for (uint32_t dictionary_index = 0; dictionary_index < dictionaries.size(); dictionary_index++)
+		{
+			auto dictionary = dictionaries[dictionary_index];
+			if (dictionaries_word_index[dictionary_index] == dictionary->get_words_count())
+				continue;
+
+			auto word = dictionary->get_word(static_cast<int>(dictionaries_word_index[dictionary_index]));
+			const char* word_string = dictionary->get_string(*word);
+
+			int compare = lowest_word_string ? strcmp(word_string, lowest_word_string) : -1;
+			if (compare < 0)
+			{
+				lowest_word_string = word_string;
+				lowest_word_length = word->get_length();
+				lowest_word_dictionaries_flags = 0;
+			}
+			if (compare <= 0)
+				SET_FLAG(lowest_word_dictionaries_flags, dictionary_index, true);
+		}
+
+		if (!lowest_word_string)
+			break;
+
+		word_string_pool_offsets.push_back(string_pool_size);
+		merged_dictionary->m_words_source_dictionaries_flags.push_back(lowest_word_dictionaries_flags);
+		memcpy(&string_pool[string_pool_size], lowest_word_string, lowest_word_length + 1);
+		string_pool_size += lowest_word_length + 1;
+
+		for (uint32_t dictionary_index = 0; dictionary_index < dictionaries.size(); dictionary_index++)
+		{
+			if (TEST_FLAG(lowest_word_dictionaries_flags, dictionary_index))
+				dictionaries_word_index[dictionary_index]++;
+		}
+	}
+
+	// takes ownership of the string pool, even on failure
+	merged_dictionary->m_resident_dictionary = c_boggle_resident_dictionary::create_from_sorted_string_pool(
+		string_pool, string_pool_size,
+		word_string_pool_offsets.data(), static_cast<uint32_t>(word_string_pool_offsets.size()));
+	if (!merged_dictionary->m_resident_dictionary)
+	{
+		output_error("c_boggle_merged_dictionary::create failed to create the merged dictionary");
+		return nullptr;
+	}
+
+	return merged_dictionary;
+}
+
+void c_boggle_merged_dictionary::split_found_words(
+	const s_boggle_found_words& found_words,
+	std::vector<s_boggle_found_words>& out_source_found_words) const
+{
+	auto dictionary = m_resident_dictionary->get_dictionary();
+	assert(found_words.dictionary == dictionary);
+
+	size_t found_words_flags_length = bit_vector_traits_dword::get_size_in_words(dictionary->get_words_count());
+
+	out_source_found_words.resize(m_source_dictionaries_count);
+	for (auto& source_found_words : out_source_found_words)
+	{
+		source_found_words.dictionary = dictionary;
+		source_found_words.flags.assign(found_words_flags_length, 0);
+		source_found_words.count = 0;
+		source_found_words.words_from_paths_chars.clear();
+		source_found_words.words_from_paths_offsets.clear();
+	}
+
+	for_each_boggle_found_word(found_words,
+		[this, &out_source_found_words](const uint32_t word_index, const char*, const uint32_t)
+		{
+			source_dictionaries_flags_t word_dictionaries_flags = m_words_source_dictionaries_flags[word_index];
+			assert(word_dictionaries_flags != 0);
+
+			for (int dictionary_index = index_of_lowest_bit_set(static_cast<uint32_t>(word_dictionaries_flags))
+				; dictionary_index != -1
+				; dictionary_index = index_of_lowest_bit_set(static_cast<uint32_t>(word_dictionaries_flags)))
+			{
+				SET_FLAG(word_dictionaries_flags, dictionary_index, false);
+
+				auto& source_found_words = out_source_found_words[dictionary_index];
+				BIT_VECTOR_SET_FLAG32(source_found_words.flags.data(), word_index, true);
+				source_found_words.count++;
+			}
+		});
+}
+
+bool c_boggle_merged_dictionary::solve_board(
+	c_boggle_solve_context& context,
+	const int board_width,
+	const int board_height,
+	const char* board_letters,
+	std::vector<s_boggle_found_words>& out_source_found_words) const
+{
+	// solved on the caller's context, so once it has grown to fit this doesn't allocate
+	if (!solve_boggle_board(*m_resident_dictionary, context, nullptr, board_width, board_height, board_letters))
+		return false;
+
+	split_found_words(context.get_found_words(), out_source_found_words);
+
+	return true;
+}
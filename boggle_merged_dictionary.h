@@ -0,0 +1,83 @@
+#pragma once
+
+#include <inttypes.h>
+#include <memory>
+#include <vector>
+
+#include <tracked_memory.h>
+#include <utilities.h>
+
+struct s_boggle_found_words;
+class c_boggle_resident_dictionary;
+class c_boggle_solve_context;
+
+// Several dictionaries, e.g. main, tournament and kids word lists, merged into one dictionary of
+// every word in any of them, with a bit per source dictionary for each word saying which of them
+// have it. A board is solved once against the merged dictionary's trie, and its found words then
+// split into each source dictionary's, instead of solving the board once per dictionary.
+// Immutable once created, so any number of solvers can share one.
+
+class c_boggle_merged_dictionary
+{
+public:
+	// bit n is set for words in source dictionary n
+	typedef uint8_t source_dictionaries_flags_t;
+
+	enum
+	{
+		k_max_source_dictionaries = BIT_COUNT(source_dictionaries_flags_t),
+	};
+
+private:
+	std::shared_ptr<const c_boggle_resident_dictionary> m_resident_dictionary;
+	uint32_t m_source_dictionaries_count;
+	// parallel to the merged dictionary's words
+	tracked_vector_t<source_dictionaries_flags_t, _memory_tag_dictionary> m_words_source_dictionaries_flags;
+
+private:
+	c_boggle_merged_dictionary();
+
+public:
+	c_boggle_merged_dictionary(const c_boggle_merged_dictionary&) = delete;
+	c_boggle_merged_dictionary& operator=(const c_boggle_merged_dictionary&) = delete;
+
+	// the source dictionaries need their word strings, so can't be trie-only. Returns nullptr on
+	// failure
+	static std::shared_ptr<const c_boggle_merged_dictionary> create(
+		const std::vector<std::shared_ptr<const c_boggle_resident_dictionary>>& source_dictionaries);
+
+	// the words of every source dictionary, to solve boards with, e.g. with
+	// c_boggle::set_resident_dictionary
+	const std::shared_ptr<const c_boggle_resident_dictionary>& get_resident_dictionary() const
+	{
+		return m_resident_dictionary;
+	}
+
+	uint32_t get_source_dictionaries_count() const
+	{
+		return m_source_dictionaries_count;
+	}
+
+	source_dictionaries_flags_t get_word_source_dictionaries_flags(
+		const uint32_t word_index) const
+	{
+		return m_words_source_dictionaries_flags[word_index];
+	}
+
+	// splits the words found on a board solved with the merged dictionary into the words found
+	// in each source dictionary, resizing out_source_found_words to one per source dictionary.
+	// Their word indices are still into the merged dictionary, so their strings come from it
+	void split_found_words(
+		const s_boggle_found_words& found_words,
+		std::vector<s_boggle_found_words>& out_source_found_words) const;
+
+	// finds all words on the specified board in one traversal of the merged trie, leaving each
+	// source dictionary's found words in out_source_found_words, see split_found_words. Only words
+	// within the context's word length limits are found
+	bool solve_board(
+		c_boggle_solve_context& context,
+		const int board_width,
+		const int board_height,
+		const char* board_letters,
+		std::vector<s_boggle_found_words>& out_source_found_words) const;
+};
@@ -0,0 +1,427 @@
+#include <precompile.h>
+#include <boggle_resident_dictionary.h>
+
+#include <boggle_dictionary.h>
+#include <boggle_dictionary_binary_file.h>
+#include <boggle_dictionary_compact_trie.h>
+#include <boggle_dictionary_word.h>
+#include <boggle_grid_char.h>
+#include <boggle_text_file_io.h>
+#include <crc32c.h>
+#include <memory_mapped_file.h>
+
+c_boggle_resident_dictionary::c_boggle_resident_dictionary()
+	: m_mapped_file()
+	, m_dictionary()
+	, m_dictionary_compact_trie()
+	, m_content_key()
+{
+}
+
+c_boggle_resident_dictionary::~c_boggle_resident_dictionary()
+{
+	// the dictionary and trie may point into the mapped file
+	m_dictionary_compact_trie.reset();
+	m_dictionary.reset();
+	m_mapped_file.reset();
+}
+
+s_boggle_resident_dictionary_content_key c_boggle_resident_dictionary::compute_content_key(
+	const std::vector<std::string>& all_words)
+{
+	s_boggle_resident_dictionary_content_key key = {};
+
+	for (auto& word : all_words)
+	{
+		// including the terminator, so word boundaries are part of the checksum
+		key.checksum = crc32c(word.c_str(), word.size() + 1, key.checksum);
+		key.length += word.size() + 1;
+	}
+
+	return key;
+}
+
+s_boggle_resident_dictionary_content_key c_boggle_resident_dictionary::compute_content_key(
+	const c_boggle_dictionary& dictionary)
+{
+	s_boggle_resident_dictionary_content_key key = {};
+
+	for (auto word = dictionary.begin_words(), end = dictionary.end_words(); word != end; ++word)
+	{
+		key.checksum = crc32c(dictionary.get_string(*word), word->get_length() + 1, key.checksum);
+		key.length += word->get_length() + 1;
+	}
+
+	return key;
+}
+
+bool c_boggle_resident_dictionary::build_dictionary_trie()
+{
+	m_dictionary_compact_trie.reset(new c_boggle_dictionary_compact_trie);
+	return m_dictionary_compact_trie->build(m_dictionary,
+		k_all_boggle_grid_chars_flags);
+}
+
+bool c_boggle_resident_dictionary::compute_binary_file_content_key(
+	const char* filename,
+	const s_boggle_resident_dictionary_binary_file_options& options,
+	s_boggle_resident_dictionary_content_key& out_key)
+{
+	FILE* file;
+	if (fopen_s(&file, filename, "rb") != 0)
+	{
+		output_error("compute_binary_file_content_key failed to open file: %s",
+			filename);
+		return false;
+	}
+
+	bool success = false;
+	do
+	{
+		s_boggle_dictionary_binary_file_layout layout;
+		if (!read_boggle_dictionary_binary_file_layout(file, false, layout))
+		{
+			output_error("compute_binary_file_content_key file is invalid or corrupt: %s",
+				filename);
+			break;
+		}
+
+		out_key = {};
+		SET_FLAG(out_key.flags, s_boggle_resident_dictionary_content_key::_from_binary_file_bit, true);
+		SET_FLAG(out_key.flags, s_boggle_resident_dictionary_content_key::_trie_only_bit, options.trie_only);
+
+		success = true;
+		for (auto& section : layout.sections)
+		{
+			uint32_t section_checksum = section.crc32c;
+			// version 1 files don't store checksums
+			if (layout.version < 2 &&
+				!compute_boggle_dictionary_binary_file_section_checksum(file, section, section_checksum))
+			{
+				output_error("compute_binary_file_content_key failed to read section: %s",
+					filename);
+				success = false;
+				break;
+			}
+
+			out_key.checksum = crc32c(&section_checksum, sizeof section_checksum, out_key.checksum);
+			out_key.length += section.length;
+		}
+	} while (false);
+
+	fclose(file);
+
+	return success;
+}
+
+std::shared_ptr<const c_boggle_resident_dictionary> c_boggle_resident_dictionary::create_from_alphabetically_sorted_array(
+	const std::vector<std::string>& all_words)
+{
+	std::shared_ptr<c_boggle_resident_dictionary> resident_dictionary(new c_boggle_resident_dictionary);
+	resident_dictionary->m_content_key = compute_content_key(all_words);
+
+	resident_dictionary->m_dictionary.reset(new c_boggle_dictionary);
+	if (!resident_dictionary->m_dictionary->set_legal_words_from_alphabetically_sorted_array(all_words))
+	{
+		output_error("create_from_alphabetically_sorted_array failed to add all_words to dictionary");
+		return nullptr;
+	}
+
+	if (!resident_dictionary->build_dictionary_trie())
+	{
+		output_error("create_from_alphabetically_sorted_array failed to build dictionary trie");
+		return nullptr;
+	}
+
+	return resident_dictionary;
+}
+
+std::shared_ptr<const c_boggle_resident_dictionary> c_boggle_resident_dictionary::create_from_sorted_string_pool(
+	char* string_pool,
+	const uint32_t string_pool_size,
+	const uint32_t* word_string_pool_offsets,
+	const uint32_t words_count)
+{
+	std::shared_ptr<c_boggle_resident_dictionary> resident_dictionary(new c_boggle_resident_dictionary);
+
+	resident_dictionary->m_dictionary.reset(new c_boggle_dictionary);
+	if (!resident_dictionary->m_dictionary->set_legal_words_from_sorted_string_pool(string_pool, string_pool_size,
+		word_string_pool_offsets, words_count))
+	{
+		output_error("create_from_sorted_string_pool failed to add words to dictionary");
+		return nullptr;
+	}
+
+	resident_dictionary->m_content_key = compute_content_key(*resident_dictionary->m_dictionary);
+
+	if (!resident_dictionary->build_dictionary_trie())
+	{
+		output_error("create_from_sorted_string_pool failed to build dictionary trie");
+		return nullptr;
+	}
+
+	return resident_dictionary;
+}
+
+std::shared_ptr<const c_boggle_resident_dictionary> c_boggle_resident_dictionary::create_from_text_file(
+	const char* filename)
+{
+	if (!filename || *filename == '\0')
+	{
+		output_error("create_from_text_file passed null or empty filename");
+		return nullptr;
+	}
+
+	std::shared_ptr<c_boggle_resident_dictionary> resident_dictionary(new c_boggle_resident_dictionary);
+
+	resident_dictionary->m_dictionary.reset(new c_boggle_dictionary);
+	if (!read_boggle_dictionary_file_in_parallel(filename, *resident_dictionary->m_dictionary))
+	{
+		output_error("create_from_text_file failed to read dictionary: %s",
+			filename);
+		return nullptr;
+	}
+
+	resident_dictionary->m_content_key = compute_content_key(*resident_dictionary->m_dictionary);
+
+	if (!resident_dictionary->build_dictionary_trie())
+	{
+		output_error("create_from_text_file failed to build dictionary trie: %s",
+			filename);
+		return nullptr;
+	}
+
+	return resident_dictionary;
+}
+
+bool c_boggle_resident_dictionary::load_binary_file(
+	_iobuf* file,
+	const char* filename,
+	const s_boggle_resident_dictionary_binary_file_options& options)
+{
+	s_boggle_dictionary_binary_file_layout layout;
+	if (!read_boggle_dictionary_binary_file_layout(file, options.verify_checksums, layout))
+	{
+		output_error("load_binary_file file is invalid or corrupt: %s",
+			filename);
+		return false;
+	}
+
+	auto& dictionary_section = layout.sections[_boggle_dictionary_binary_file_section_dictionary];
+	if (0 != _fseeki64(file, static_cast<int64_t>(dictionary_section.offset), SEEK_SET))
+	{
+		output_error("load_binary_file failed to seek to dictionary blob: %s",
+			filename);
+		return false;
+	}
+
+	m_dictionary.reset(new c_boggle_dictionary);
+	if (!m_dictionary->read_from_file(file, options.trie_only))
+	{
+		output_error("load_binary_file failed to read dictionary blob: %s",
+			filename);
+		return false;
+	}
+
+	auto& dictionary_trie_section = layout.sections[_boggle_dictionary_binary_file_section_dictionary_trie];
+	if (0 != _fseeki64(file, static_cast<int64_t>(dictionary_trie_section.offset), SEEK_SET))
+	{
+		output_error("load_binary_file failed to seek to dictionary trie blob: %s",
+			filename);
+		return false;
+	}
+
+	m_dictionary_compact_trie.reset(new c_boggle_dictionary_compact_trie);
+	if (!m_dictionary_compact_trie->read_from_file(file, m_dictionary))
+	{
+		output_error("load_binary_file failed to read dictionary trie blob: %s",
+			filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool c_boggle_resident_dictionary::map_binary_file(
+	const char* filename,
+	const s_boggle_resident_dictionary_binary_file_options& options)
+{
+	m_mapped_file.reset(new c_memory_mapped_file);
+	if (!m_mapped_file->open(filename))
+	{
+		output_error("map_binary_file failed to map file: %s",
+			filename);
+		return false;
+	}
+
+	c_memory_reader reader(m_mapped_file->get_data(), m_mapped_file->get_size());
+
+	s_boggle_dictionary_binary_file_layout layout;
+	if (!read_boggle_dictionary_binary_file_layout(reader, options.verify_checksums, layout))
+	{
+		output_error("map_binary_file file is invalid or corrupt: %s",
+			filename);
+		return false;
+	}
+
+	m_dictionary.reset(new c_boggle_dictionary);
+	if (!reader.seek(static_cast<size_t>(layout.sections[_boggle_dictionary_binary_file_section_dictionary].offset)) ||
+		!m_dictionary->read_from_memory(reader, options.trie_only))
+	{
+		output_error("map_binary_file failed to read dictionary blob: %s",
+			filename);
+		return false;
+	}
+
+	m_dictionary_compact_trie.reset(new c_boggle_dictionary_compact_trie);
+	if (!reader.seek(static_cast<size_t>(layout.sections[_boggle_dictionary_binary_file_section_dictionary_trie].offset)) ||
+		!m_dictionary_compact_trie->read_from_memory(reader, m_dictionary))
+	{
+		output_error("map_binary_file failed to read dictionary trie blob: %s",
+			filename);
+		return false;
+	}
+
+	return true;
+}
+
+std::shared_ptr<const c_boggle_resident_dictionary> c_boggle_resident_dictionary::create_from_binary_file(
+	const char* filename,
+	const s_boggle_resident_dictionary_binary_file_options& options)
+{
+	if (!filename || *filename == '\0')
+	{
+		output_error("create_from_binary_file passed null or empty filename");
+		return nullptr;
+	}
+
+	std::shared_ptr<c_boggle_resident_dictionary> resident_dictionary(new c_boggle_resident_dictionary);
+	if (!compute_binary_file_content_key(filename, options, resident_dictionary->m_content_key))
+		return nullptr;
+
+	if (options.map_file)
+	{
+		if (!resident_dictionary->map_binary_file(filename, options))
+			return nullptr;
+	}
+	else
+	{
+		FILE* file;
+		if (fopen_s(&file, filename, "rb") != 0)
+		{
+			output_error("create_from_binary_file failed to open file: %s",
+				filename);
+			return nullptr;
+		}
+
+		bool success = resident_dictionary->load_binary_file(file, filename, options);
+		fclose(file);
+
+		if (!success)
+			return nullptr;
+	}
+
+	return resident_dictionary;
+}
+
+bool c_boggle_resident_dictionary::save_binary_file(
+	_iobuf* file,
+	const char* filename) const
+{
+	c_boggle_dictionary_binary_file_writer writer(file, k_number_of_boggle_dictionary_binary_file_section_types);
+	if (!writer.begin())
+		return false;
+
+	if (!writer.begin_section(_boggle_dictionary_binary_file_section_dictionary) ||
+		!m_dictionary->write_to_file(file) ||
+		!writer.end_section())
+	{
+		output_error("save_binary_file failed to write dictionary blob: %s",
+			filename);
+		return false;
+	}
+
+	if (!writer.begin_section(_boggle_dictionary_binary_file_section_dictionary_trie) ||
+		!m_dictionary_compact_trie->write_to_file(file) ||
+		!writer.end_section())
+	{
+		output_error("save_binary_file failed to write dictionary trie blob: %s",
+			filename);
+		return false;
+	}
+
+	if (!writer.end())
+	{
+		output_error("save_binary_file failed to finalize header: %s",
+			filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool c_boggle_resident_dictionary::save_binary_file(
+	const char* filename) const
+{
+	if (!filename || *filename == '\0')
+	{
+		output_error("save_binary_file passed null or empty filename");
+		return false;
+	}
+
+	if (m_dictionary->is_trie_only())
+	{
+		output_error("save_binary_file called with a trie-only dictionary");
+		return false;
+	}
+
+	FILE* file;
+	if (fopen_s(&file, filename, "w+b") != 0)
+	{
+		output_error("save_binary_file failed to open/create file: %s",
+			filename);
+		return false;
+	}
+
+	bool success = save_binary_file(file, filename);
+	fclose(file);
+
+	return success;
+}
+
+size_t c_boggle_resident_dictionary::estimate_total_memory_used() const
+{
+	size_t estimated_total_memory_used = sizeof(*this);
+	estimated_total_memory_used += m_dictionary->estimate_total_memory_used();
+	estimated_total_memory_used += m_dictionary_compact_trie->estimate_total_memory_used();
+	return estimated_total_memory_used;
+}
+
+bool c_boggle_resident_dictionary::has_same_content(
+	const c_boggle_resident_dictionary& other) const
+{
+	if (this == &other)
+		return true;
+
+	if (m_dictionary->is_trie_only() || other.m_dictionary->is_trie_only())
+	{
+		return m_dictionary->is_trie_only() == other.m_dictionary->is_trie_only() &&
+			m_dictionary_compact_trie->has_same_nodes(*other.m_dictionary_compact_trie);
+	}
+
+	if (m_dictionary->get_words_count() != other.m_dictionary->get_words_count())
+		return false;
+
+	for (uint32_t word_index = 0; word_index < m_dictionary->get_words_count(); word_index++)
+	{
+		auto word = m_dictionary->get_word(static_cast<int>(word_index));
+		auto other_word = other.m_dictionary->get_word(static_cast<int>(word_index));
+		if (word->get_length() != other_word->get_length() ||
+			memcmp(m_dictionary->get_string(*word), other.m_dictionary->get_string(*other_word), word->get_length()) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <inttypes.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct _iobuf;
+
+class c_boggle_dictionary;
+class c_boggle_dictionary_compact_trie;
+class c_memory_mapped_file;
+
+// Identifies the words a resident dictionary was made from, so identical word lists can share
+// one resident dictionary instead of each paying for their own
+struct s_boggle_resident_dictionary_content_key
+{
+	enum
+	{
+		// made from a binary file, checksum covers the file's sections rather than the words
+		_from_binary_file_bit,
+		// only the trie was loaded, see c_boggle_dictionary::is_trie_only
+		_trie_only_bit,
+	};
+
+	uint64_t length;
+	uint32_t checksum;
+	uint32_t flags;
+
+	bool operator<(
+		const s_boggle_resident_dictionary_content_key& other) const
+	{
+		if (length != other.length)
+			return length < other.length;
+		if (checksum != other.checksum)
+			return checksum < other.checksum;
+		return flags < other.flags;
+	}
+};
+
+struct s_boggle_resident_dictionary_binary_file_options
+{
+	// map the file and use it in place instead of copying it
+	bool map_file;
+	// verify the checksum of every section, which means reading the whole file up front
+	bool verify_checksums;
+	// skip the dictionary's string pool and words, see c_boggle_dictionary::is_trie_only
+	bool trie_only;
+};
+
+// A dictionary along with its full compact trie, and the mapped file they point into if any.
+// Immutable once created and handed out as a shared pointer, so any number of solvers (and
+// threads) can use the same one, and it lives until the last of them lets go of it.
+
+class c_boggle_resident_dictionary
+{
+	// when mapped from a binary file, the dictionary and trie point into this. Declared first so
+	// it's destroyed last
+	std::unique_ptr<c_memory_mapped_file> m_mapped_file;
+	// shared with our trie. Anything else keeping the dictionary alive should share ownership of
+	// us instead, as it may point into the mapped file
+	std::shared_ptr<c_boggle_dictionary> m_dictionary;
+	std::unique_ptr<c_boggle_dictionary_compact_trie> m_dictionary_compact_trie;
+	s_boggle_resident_dictionary_content_key m_content_key;
+
+private:
+	c_boggle_resident_dictionary();
+
+	bool build_dictionary_trie();
+
+	bool load_binary_file(
+		_iobuf* file,
+		const char* filename,
+		const s_boggle_resident_dictionary_binary_file_options& options);
+
+	bool map_binary_file(
+		const char* filename,
+		const s_boggle_resident_dictionary_binary_file_options& options);
+
+	bool save_binary_file(
+		_iobuf* file,
+		const char* filename) const;
+
+public:
+	~c_boggle_resident_dictionary();
+
+	c_boggle_resident_dictionary(const c_boggle_resident_dictionary&) = delete;
+	c_boggle_resident_dictionary& operator=(const c_boggle_resident_dictionary&) = delete;
+
+	static s_boggle_resident_dictionary_content_key compute_content_key(
+		const std::vector<std::string>& all_words);
+	// same key as for the array of the dictionary's words
+	static s_boggle_resident_dictionary_content_key compute_content_key(
+		const c_boggle_dictionary& dictionary);
+
+	// only reads the file's header and section table, unless it's a version 1 file whose sections
+	// have no stored checksums
+	static bool compute_binary_file_content_key(
+		const char* filename,
+		const s_boggle_resident_dictionary_binary_file_options& options,
+		s_boggle_resident_dictionary_content_key& out_key);
+
+	// returns nullptr on failure
+	static std::shared_ptr<const c_boggle_resident_dictionary> create_from_alphabetically_sorted_array(
+		const std::vector<std::string>& all_words);
+
+	// takes ownership of the string pool, as c_boggle_dictionary::set_legal_words_from_sorted_string_pool
+	// does. Returns nullptr on failure
+	static std::shared_ptr<const c_boggle_resident_dictionary> create_from_sorted_string_pool(
+		char* string_pool,
+		const uint32_t string_pool_size,
+		const uint32_t* word_string_pool_offsets,
+		const uint32_t words_count);
+
+	// reads a text file with read_boggle_dictionary_file_in_parallel. Returns nullptr on failure
+	static std::shared_ptr<const c_boggle_resident_dictionary> create_from_text_file(
+		const char* filename);
+
+	// returns nullptr on failure
+	static std::shared_ptr<const c_boggle_resident_dictionary> create_from_binary_file(
+		const char* filename,
+		const s_boggle_resident_dictionary_binary_file_options& options);
+
+	bool save_binary_file(
+		const char* filename) const;
+
+	size_t estimate_total_memory_used() const;
+
+	// content keys only checksum the words, so before sharing a dictionary with the same key, this
+	// confirms it really was made from the same words (or for trie-only ones, the same trie)
+	bool has_same_content(
+		const c_boggle_resident_dictionary& other) const;
+
+	const c_boggle_dictionary* get_dictionary() const
+	{
+		return m_dictionary.get();
+	}
+
+	const c_boggle_dictionary_compact_trie* get_dictionary_trie() const
+	{
+		return m_dictionary_compact_trie.get();
+	}
+
+	const s_boggle_resident_dictionary_content_key& get_content_key() const
+	{
+		return m_content_key;
+	}
+};
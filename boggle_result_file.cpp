@@ -0,0 +1,170 @@
+#include <precompile.h>
+#include <boggle_result_file.h>
+
+#include <boggle_board_batch_file.h>
+#include <boggle_dictionary.h>
+#include <boggle_found_words.h>
+#include <boggle_grid_char.h>
+#include <utilities.h>
+
+// enough for any one word along with its quotes and separator
+static const size_t k_longest_formatted_word_size =
+	(c_boggle_dictionary::k_longest_acceptable_word_length * k_boggle_grid_char_longest_utf8_length) + 4;
+
+// enough for a 64-bit value
+static const size_t k_longest_varint_size = 10;
+
+static size_t encode_varint(
+	uint64_t value,
+	uint8_t* out_bytes)
+{
+	size_t size = 0;
+	for (; value >= 0x80; value >>= 7)
+	{
+		out_bytes[size++] = static_cast<uint8_t>(value | 0x80);
+	}
+	out_bytes[size++] = static_cast<uint8_t>(value);
+
+	return size;
+}
+
+
+c_boggle_result_writer::c_boggle_result_writer()
+	: m_file()
+	, m_format(_boggle_result_file_format_text)
+	, m_boards_written(0)
+{
+}
+
+bool c_boggle_result_writer::open(
+	const char* filename,
+	const e_boggle_result_file_format format)
+{
+	close();
+
+	if (!m_file.open(filename))
+	{
+		output_error("failed to open/create result file: %s",
+			filename);
+		return false;
+	}
+
+	m_format = format;
+
+	if (m_format == _boggle_result_file_format_binary)
+	{
+		s_boggle_result_file_header header;
+		header.signature = k_boggle_result_file_signature;
+		header.version = k_boggle_result_file_version;
+		m_file.write(header);
+	}
+
+	return true;
+}
+
+bool c_boggle_result_writer::close()
+{
+	m_boards_written = 0;
+	return m_file.close();
+}
+
+bool c_boggle_result_writer::write_text_board(
+	const s_boggle_found_words& found_words)
+{
+	bool first_word = true;
+	for_each_boggle_found_word(found_words,
+		[this, &first_word](const uint32_t, const char* word_string, const uint32_t word_length)
+		{
+			auto formatted_word = reinterpret_cast<char*>(m_file.reserve(k_longest_formatted_word_size));
+			size_t formatted_word_size = 0;
+
+			if (!first_word)
+				formatted_word[formatted_word_size++] = ' ';
+			formatted_word_size += boggle_grid_char_string_to_utf8(word_string, word_length, formatted_word + formatted_word_size);
+
+			m_file.commit(formatted_word_size);
+			first_word = false;
+		});
+
+	return m_file.write('\n');
+}
+
+bool c_boggle_result_writer::write_json_lines_board(
+	const s_boggle_batch_board& board,
+	const s_boggle_found_words& found_words)
+{
+	char board_prefix[96];
+	int board_prefix_length = sprintf_s(board_prefix, sizeof board_prefix, "{\"board\":%" PRIu64 ",\"width\":%d,\"height\":%d,\"words\":[",
+		m_boards_written,
+		board.width, board.height);
+	m_file.write(board_prefix, board_prefix_length);
+
+	// words are only ever letters, so nothing needs escaping
+	bool first_word = true;
+	for_each_boggle_found_word(found_words,
+		[this, &first_word](const uint32_t, const char* word_string, const uint32_t word_length)
+		{
+			auto formatted_word = reinterpret_cast<char*>(m_file.reserve(k_longest_formatted_word_size));
+			size_t formatted_word_size = 0;
+
+			if (!first_word)
+				formatted_word[formatted_word_size++] = ',';
+			formatted_word[formatted_word_size++] = '"';
+			formatted_word_size += boggle_grid_char_string_to_utf8(word_string, word_length, formatted_word + formatted_word_size);
+			formatted_word[formatted_word_size++] = '"';
+
+			m_file.commit(formatted_word_size);
+			first_word = false;
+		});
+
+	static const char k_board_suffix[] = "]}\n";
+	return m_file.write(k_board_suffix, sizeof(k_board_suffix) - 1);
+}
+
+bool c_boggle_result_writer::write_binary_board(
+	const s_boggle_found_words& found_words)
+{
+	uint8_t* count_bytes = m_file.reserve(k_longest_varint_size);
+	m_file.commit(encode_varint(found_words.count, count_bytes));
+
+	uint32_t previous_word_index = 0;
+	for_each_boggle_found_word(found_words,
+		[this, &previous_word_index](const uint32_t word_index, const char*, const uint32_t)
+		{
+			uint8_t* word_index_bytes = m_file.reserve(k_longest_varint_size);
+			m_file.commit(encode_varint(word_index - previous_word_index, word_index_bytes));
+
+			previous_word_index = word_index;
+		});
+
+	return !m_file.has_failed();
+}
+
+bool c_boggle_result_writer::write_board(
+	const s_boggle_batch_board& board,
+	const s_boggle_found_words& found_words)
+{
+	if (!m_file.is_open())
+		return false;
+
+	bool success;
+	switch (m_format)
+	{
+	case _boggle_result_file_format_json_lines:
+		success = write_json_lines_board(board, found_words);
+		break;
+
+	case _boggle_result_file_format_binary:
+		success = write_binary_board(found_words);
+		break;
+
+	default:
+		success = write_text_board(found_words);
+		break;
+	}
+
+	if (success)
+		m_boards_written++;
+
+	return success;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include <double_buffered_file.h>
+
+struct s_boggle_batch_board;
+struct s_boggle_found_words;
+
+// The found words of many boards, written straight out of their found words bit vectors, so
+// they're already in dictionary (alphabetical) order and never sorted or made into strings.
+
+enum e_boggle_result_file_format
+{
+	// a line per board, its found words separated by spaces
+	_boggle_result_file_format_text,
+	// a JSON object per line, e.g. {"board":0,"width":4,"height":4,"words":["ant","tan"]}
+	_boggle_result_file_format_json_lines,
+	// a header, then per board its found words count and dictionary word indices. The count
+	// and the difference between each index and the previous one are LEB128 varints
+	_boggle_result_file_format_binary,
+
+	k_number_of_boggle_result_file_formats
+};
+
+enum
+{
+	k_boggle_result_file_signature = 'bres',
+	k_boggle_result_file_version = 1,
+};
+
+struct s_boggle_result_file_header
+{
+	uint32_t signature;
+	uint32_t version;
+};
+
+class c_boggle_result_writer
+{
+	c_double_buffered_file_writer m_file;
+	e_boggle_result_file_format m_format;
+	uint64_t m_boards_written;
+
+private:
+	bool write_text_board(
+		const s_boggle_found_words& found_words);
+
+	bool write_json_lines_board(
+		const s_boggle_batch_board& board,
+		const s_boggle_found_words& found_words);
+
+	bool write_binary_board(
+		const s_boggle_found_words& found_words);
+
+public:
+	c_boggle_result_writer();
+
+	bool open(
+		const char* filename,
+		const e_boggle_result_file_format format);
+
+	// false if any board's results couldn't be written
+	bool close();
+
+	bool write_board(
+		const s_boggle_batch_board& board,
+		const s_boggle_found_words& found_words);
+
+	uint64_t get_boards_written() const
+	{
+		return m_boards_written;
+	}
+
+	uint64_t get_bytes_written() const
+	{
+		return m_file.get_bytes_written();
+	}
+};
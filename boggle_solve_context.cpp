@@ -0,0 +1,67 @@
+#include <precompile.h>
+#include <boggle_solve_context.h>
+
+#include <bit_vectors.h>
+#include <boggle_dictionary.h>
+#include <boggle_visited_cells.h>
+
+c_boggle_solve_context::c_boggle_solve_context()
+	: m_grid(0, 0)
+	, m_threads_scratch()
+	, m_roots_found_words()
+	, m_found_words()
+	, m_shortest_word_length(c_boggle_dictionary::k_shortest_acceptable_word_length)
+	, m_longest_word_length(c_boggle_dictionary::k_longest_acceptable_word_length)
+	, m_visited_cells_path_min_cell_count(k_boggle_visited_cells_path_min_cell_count)
+	, m_interleave_walks(true)
+{
+	m_found_words.dictionary = nullptr;
+	m_found_words.count = 0;
+}
+
+bool c_boggle_solve_context::set_board(
+	const int board_width,
+	const int board_height,
+	const char* board_letters)
+{
+	m_grid.resize(board_width, board_height);
+
+	return m_grid.set_grid_characters(board_letters);
+}
+
+bool c_boggle_solve_context::set_word_length_limits(
+	const uint32_t shortest_word_length,
+	const uint32_t longest_word_length)
+{
+	if (shortest_word_length > longest_word_length)
+	{
+		output_error("c_boggle_solve_context::set_word_length_limits given shortest word length %u > longest %u",
+			shortest_word_length, longest_word_length);
+		return false;
+	}
+
+	m_shortest_word_length = shortest_word_length;
+	m_longest_word_length = longest_word_length;
+
+	return true;
+}
+
+void c_boggle_solve_context::prepare_threads_scratch(
+	const int thread_count,
+	const uint32_t longest_word_length,
+	const uint32_t walks_per_thread)
+{
+	if (m_threads_scratch.size() < static_cast<size_t>(thread_count))
+		m_threads_scratch.resize(thread_count);
+
+	// big grids track the visited cells on the path instead
+	size_t used_cells_flags_length = !is_tracking_visited_cells_with_path()
+		? bit_vector_traits_dword::get_size_in_words(m_grid.get_cell_count()) * walks_per_thread
+		: 0;
+	for (auto& thread_scratch : m_threads_scratch)
+	{
+		// neither shrinks, so a smaller board than the last doesn't free anything
+		thread_scratch.used_cells_flags.resize(used_cells_flags_length);
+		thread_scratch.trie_node_chars_path.reserve(longest_word_length);
+	}
+}
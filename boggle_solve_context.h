@@ -0,0 +1,152 @@
+#pragma once
+
+#include <inttypes.h>
+#include <array>
+#include <vector>
+
+#include <boggle_found_words.h>
+#include <boggle_grid.h>
+#include <boggle_grid_char.h>
+#include <tracked_memory.h>
+
+// Everything a solve needs besides the dictionary: the grid, each thread's scratch and the found
+// words. Callers keep a context from solve to solve, and as its buffers only ever grow to fit the
+// largest board (and dictionary) seen so far, once warmed up solving makes no heap allocations,
+// other than any found word strings asked for.
+// A context is only used by one solve at a time.
+
+// scratch for the roots solved on one thread
+struct s_boggle_solve_thread_scratch
+{
+	// for each interleaved walk, a bit per grid cell, set for the cells on its current path. Empty
+	// for grids big enough to track them with c_boggle_visited_cells_path instead
+	tracked_vector_t<uint32_t, _memory_tag_solver> used_cells_flags;
+	// for trie-only dictionaries, the chars of the trie nodes on the current path
+	tracked_vector_t<char, _memory_tag_solver> trie_node_chars_path;
+};
+
+// the words found by one root's solver, named from their paths, for trie-only dictionaries
+struct s_boggle_solve_root_found_words
+{
+	struct s_found_word
+	{
+		int word_index;
+		uint32_t chars_offset;
+		uint32_t length;
+	};
+
+	tracked_vector_t<s_found_word, _memory_tag_solver> words;
+	// each word's chars, back to back without terminators
+	tracked_vector_t<char, _memory_tag_solver> chars;
+};
+
+class c_boggle_solve_context
+{
+	c_boggle_grid m_grid;
+	// indexed by OpenMP thread number
+	std::vector<s_boggle_solve_thread_scratch> m_threads_scratch;
+	// each root's words are only ever found by that root's solver
+	std::array<s_boggle_solve_root_found_words, k_number_of_boggle_grid_characters> m_roots_found_words;
+	s_boggle_found_words m_found_words;
+	// words outside these lengths aren't found, see set_word_length_limits
+	uint32_t m_shortest_word_length;
+	uint32_t m_longest_word_length;
+	// see set_visited_cells_path_min_cell_count
+	uint32_t m_visited_cells_path_min_cell_count;
+	// see set_interleave_walks
+	bool m_interleave_walks;
+
+public:
+	c_boggle_solve_context();
+
+	c_boggle_solve_context(const c_boggle_solve_context&) = delete;
+	c_boggle_solve_context& operator=(const c_boggle_solve_context&) = delete;
+
+	// reuses the grid's cells when the board is no bigger than an earlier one. Returns false if
+	// the letters don't fit the board
+	bool set_board(
+		const int board_width,
+		const int board_height,
+		const char* board_letters);
+
+	// only words of shortest_word_length to longest_word_length chars (with 'qu' counting as two)
+	// are found by the solves given this context, e.g. for rules which only score words of 4 or
+	// more letters. The solver prunes the trie subtrees whose words are all out of bounds, rather
+	// than filtering the found words, and never looks for words longer than the board's cells
+	// (and 'qu's) could spell. Returns false if shortest_word_length > longest_word_length
+	bool set_word_length_limits(
+		const uint32_t shortest_word_length,
+		const uint32_t longest_word_length);
+
+	uint32_t get_shortest_word_length() const
+	{
+		return m_shortest_word_length;
+	}
+
+	uint32_t get_longest_word_length() const
+	{
+		return m_longest_word_length;
+	}
+
+	// boards of at least this many cells track the cells on each path with
+	// c_boggle_visited_cells_path rather than a bit vector per walk, e.g. 0 to always use the path.
+	// k_boggle_visited_cells_path_min_cell_count by default
+	void set_visited_cells_path_min_cell_count(
+		const uint32_t cell_count)
+	{
+		m_visited_cells_path_min_cell_count = cell_count;
+	}
+
+	bool is_tracking_visited_cells_with_path() const
+	{
+		return m_grid.get_cell_count() >= m_visited_cells_path_min_cell_count;
+	}
+
+	// when false, a root char's cells are searched one after another even on boards small enough
+	// to interleave their walks, e.g. to check both find the same words. True by default
+	void set_interleave_walks(
+		const bool interleave)
+	{
+		m_interleave_walks = interleave;
+	}
+
+	bool is_interleaving_walks() const
+	{
+		return m_interleave_walks;
+	}
+
+	// grows each thread's scratch to fit the current board, searched by walks_per_thread
+	// interleaved searches at once, and words of up to longest_word_length chars
+	void prepare_threads_scratch(
+		const int thread_count,
+		const uint32_t longest_word_length,
+		const uint32_t walks_per_thread);
+
+	s_boggle_solve_thread_scratch& get_thread_scratch(
+		const int thread_number)
+	{
+		return m_threads_scratch[thread_number];
+	}
+
+	s_boggle_solve_root_found_words& get_root_found_words(
+		const boggle_grid_char_t root_grid_char)
+	{
+		return m_roots_found_words[root_grid_char];
+	}
+
+	const c_boggle_grid& get_grid() const
+	{
+		return m_grid;
+	}
+
+	// the words found by the last solve_board given this context. Only valid while the dictionary
+	// they were found in is resident
+	s_boggle_found_words& get_found_words()
+	{
+		return m_found_words;
+	}
+	const s_boggle_found_words& get_found_words() const
+	{
+		return m_found_words;
+	}
+};
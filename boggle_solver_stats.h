@@ -0,0 +1,83 @@
+#pragma once
+
+#include <inttypes.h>
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include <boggle_grid_char.h>
+
+// #NOTE enable to have the trie solver count what it does on the hot path (nodes entered, trie
+// lookups, etc) and time each thread. Off by default, as even uncontended counters cost the
+// solver measurably; when off, BOGGLE_SOLVER_STAT statements aren't compiled at all
+#ifndef BOGGLE_SOLVER_STATS
+	#define BOGGLE_SOLVER_STATS 0
+#endif
+
+#if BOGGLE_SOLVER_STATS
+	#define BOGGLE_SOLVER_STAT(statement) statement
+#else
+	#define BOGGLE_SOLVER_STAT(statement)
+#endif
+
+// Counted by each root char's solver on its own, then added to the counters of the thread it ran
+// on once it's finished, so nothing is shared while solving.
+
+struct s_boggle_solver_counters
+{
+	// (trie node, grid cell) pairs the depth first search stepped into
+	uint64_t nodes_entered;
+	// neighbor cells looked at, including those off the board or already on the path
+	uint64_t neighbor_probes;
+	uint64_t trie_child_lookup_hits;
+	uint64_t trie_child_lookup_misses;
+	// extra lookups of a 'u' child made after a 'q'
+	uint64_t qu_probes;
+	// in trie nodes, the root being depth 1
+	uint32_t max_depth;
+	uint32_t words_found;
+
+	void clear()
+	{
+		*this = s_boggle_solver_counters();
+	}
+
+	void add(
+		const s_boggle_solver_counters& other)
+	{
+		nodes_entered += other.nodes_entered;
+		neighbor_probes += other.neighbor_probes;
+		trie_child_lookup_hits += other.trie_child_lookup_hits;
+		trie_child_lookup_misses += other.trie_child_lookup_misses;
+		qu_probes += other.qu_probes;
+		if (other.max_depth > max_depth)
+			max_depth = other.max_depth;
+		words_found += other.words_found;
+	}
+};
+
+struct s_boggle_solver_thread_stats
+{
+	s_boggle_solver_counters counters;
+	uint32_t roots_solved;
+	// solving roots, and waiting for the other threads to finish theirs
+	std::chrono::duration<int64_t, std::nano> busy_time;
+	std::chrono::duration<int64_t, std::nano> idle_time;
+};
+
+// only filled in when built with BOGGLE_SOLVER_STATS
+struct s_boggle_solver_stats
+{
+	// the sum of every thread's counters
+	s_boggle_solver_counters totals;
+	std::array<uint32_t, k_number_of_boggle_grid_characters> words_found_per_root;
+	// indexed by OpenMP thread number
+	std::vector<s_boggle_solver_thread_stats> threads;
+
+	void clear()
+	{
+		totals.clear();
+		words_found_per_root.fill(0);
+		threads.clear();
+	}
+};
@@ -3,10 +3,25 @@
 
 #include <boggle_dictionary.h>
 #include <boggle_grid_char.h>
+#include <double_buffered_file.h>
+#include <memory_mapped_file.h>
+#include <tracked_memory.h>
 #include <utilities.h>
 
 #include <set>
 
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define BOGGLE_TEXT_FILE_IO_SSE2 1
+#include <emmintrin.h>
+#else
+#define BOGGLE_TEXT_FILE_IO_SSE2 0
+#endif
+
+// in bytes
+static const size_t k_longest_utf8_sequence_length = 4;
+// if we get more than a million words, the file may be bad
+static const int k_suspect_word_count = 1000000;
+
 bool read_boggle_board_file(
 	const char* filename,
 	std::vector<char>& grid_chars,
@@ -38,21 +53,41 @@ bool read_boggle_board_file(
 		if (iswspace(c))
 			continue;
 
-		if (consume_u_after_q && c == 'u' && prev_c == 'q')
+		size_t character_byte_offset = byte_offset;
+
+		// gather the rest of the character's UTF-8 sequence
+		char utf8[k_longest_utf8_sequence_length + 1] = { static_cast<char>(c) };
+		for (size_t utf8_index = 1; (c & 0x80) && utf8_index < k_longest_utf8_sequence_length; utf8_index++)
+		{
+			int next_c = fgetc(file);
+			if ((next_c & 0xC0) != 0x80)
+			{
+				ungetc(next_c, file);
+				break;
+			}
+
+			utf8[utf8_index] = static_cast<char>(next_c);
+			byte_offset++;
+		}
+
+		char character;
+		boggle_grid_char_character_from_utf8(utf8, character);
+
+		if (consume_u_after_q && character == 'u' && prev_c == 'q')
 		{
 			continue;
 		}
 
-		auto test_grid_char = boggle_grid_char_from_character(c);
+		auto test_grid_char = boggle_grid_char_from_character(character);
 		if (test_grid_char == k_invalid_boggle_grid_char)
 		{
 			output_error("\tskipping non-playable character reading boggle board at byte offset #%d",
-				static_cast<int>(byte_offset));
+				static_cast<int>(character_byte_offset));
 			continue;
 		}
 
-		grid_chars.push_back(c);
-		prev_c = c;
+		grid_chars.push_back(character);
+		prev_c = character;
 	}
 
 	bool success = true;
@@ -93,10 +128,8 @@ bool read_boggle_dictionary_file(
 	const bool sort_all_words_after_loading,
 	const bool find_and_remove_duplicates)
 {
-	// if we get more than a million words, the file may be bad
-	static const int k_suspect_word_count = 1000000;
 	static const size_t k_word_length_padding_for_newlines = 2;
-	static const size_t k_word_length = c_boggle_dictionary::k_longest_acceptable_word_length + k_word_length_padding_for_newlines;
+	static const size_t k_word_length = (c_boggle_dictionary::k_longest_acceptable_word_length * k_longest_utf8_sequence_length) + k_word_length_padding_for_newlines;
 
 	auto start_time = std::chrono::high_resolution_clock::now();
 
@@ -121,6 +154,7 @@ bool read_boggle_dictionary_file(
 	bool success = true;
 
 	char word[k_word_length+1];
+	std::string word_string;
 	for (int line = 1, word_count = 0; word_count <= k_suspect_word_count; line++)
 	{
 		memset(word, 0, sizeof word);
@@ -161,6 +195,10 @@ bool read_boggle_dictionary_file(
 			word_length--;
 		}
 
+		// words are kept with one byte per grid char, rather than as UTF-8
+		boggle_grid_char_string_from_utf8(word, word_string);
+		word_length = word_string.length();
+
 		if (word_length == 0)
 		{
 			// empty line
@@ -186,9 +224,7 @@ bool read_boggle_dictionary_file(
 		int invalid_character_column = -1;
 		for (size_t letter_index = 0; letter_index < word_length; letter_index++)
 		{
-			word[letter_index] = tolower(word[letter_index]);
-
-			auto grid_char = boggle_grid_char_from_character(word[letter_index]);
+			auto grid_char = boggle_grid_char_from_character(word_string[letter_index]);
 			if (grid_char == k_invalid_boggle_grid_char)
 			{
 				invalid_character_column = static_cast<int>(letter_index+1);
@@ -204,7 +240,6 @@ bool read_boggle_dictionary_file(
 			continue;
 		}
 
-		std::string word_string(word);
 		all_words.push_back(word_string);
 	}
 
@@ -245,14 +280,311 @@ bool read_boggle_dictionary_file(
 	return true;
 }
 
+// returns end if there are no more line breaks
+static const char* find_next_newline(
+	const char* begin,
+	const char* end)
+{
+#if BOGGLE_TEXT_FILE_IO_SSE2
+	const __m128i newlines = _mm_set1_epi8('\n');
+	for (; end - begin >= 16; begin += 16)
+	{
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+		uint32_t newline_bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newlines)));
+		if (newline_bits != 0)
+			return begin + index_of_lowest_bit_set(newline_bits);
+	}
+#endif
+
+	auto newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+	return newline ? newline : end;
+}
+
+// a run of whole lines from the dictionary file, and the words decoded out of them
+struct s_boggle_dictionary_file_chunk
+{
+	const char* begin;
+	const char* end;
+	// each word lower cased, one byte per grid char, with its terminator
+	tracked_vector_t<char, _memory_tag_file_io> words;
+	tracked_vector_t<uint32_t, _memory_tag_file_io> word_offsets;
+};
+
+// decodes the line onto the end of out_words, returns false (leaving out_words as it was) if
+// it's empty or can't be a legal word
+static bool decode_boggle_dictionary_file_line(
+	const char* line,
+	const char* line_end,
+	tracked_vector_t<char, _memory_tag_file_io>& out_words)
+{
+	size_t word_offset = out_words.size();
+
+	// every grid char takes at least one byte
+	bool too_long = static_cast<size_t>(line_end - line) > c_boggle_dictionary::k_longest_acceptable_word_length * k_longest_utf8_sequence_length;
+	bool invalid_character = false;
+	for (const char* utf8 = line; utf8 < line_end && !too_long && !invalid_character; )
+	{
+		char character;
+		if (static_cast<uint8_t>(*utf8) < 0x80)
+		{
+			character = boggle_grid_char_character_to_lower(*utf8++);
+		}
+		else
+		{
+			// the mapped file isn't terminated, so decode from a terminated copy of the sequence
+			char utf8_sequence[k_longest_utf8_sequence_length + 1] = {};
+			memcpy(utf8_sequence, utf8, std::min<size_t>(k_longest_utf8_sequence_length, line_end - utf8));
+			utf8 += boggle_grid_char_character_from_utf8(utf8_sequence, character);
+		}
+
+		invalid_character = boggle_grid_char_from_character(character) == k_invalid_boggle_grid_char;
+		out_words.push_back(character);
+		too_long = out_words.size() - word_offset > c_boggle_dictionary::k_longest_acceptable_word_length;
+	}
+
+	size_t word_length = out_words.size() - word_offset;
+	if (word_length == 0)
+	{
+		// empty line
+		return false;
+	}
+
+	if (too_long || invalid_character || word_length < c_boggle_dictionary::k_shortest_acceptable_word_length)
+	{
+#pragma omp critical
+		{
+			output_error("\t%s, skipping: %.*s",
+				too_long ? "word is too long" : invalid_character ? "word contains unacceptable characters" : "word is too short",
+				static_cast<int>(line_end - line),
+				line);
+		}
+
+		out_words.resize(word_offset);
+		return false;
+	}
+
+	out_words.push_back('\0');
+	return true;
+}
+
+static void decode_boggle_dictionary_file_chunk(
+	s_boggle_dictionary_file_chunk& chunk)
+{
+	// decoded words are never longer than their lines
+	chunk.words.reserve(chunk.end - chunk.begin + 1);
+
+	for (const char* line = chunk.begin; line < chunk.end; )
+	{
+		const char* newline = find_next_newline(line, chunk.end);
+		const char* line_end = newline;
+		if (line_end > line && line_end[-1] == '\r')
+			line_end--;
+
+		uint32_t word_offset = static_cast<uint32_t>(chunk.words.size());
+		if (decode_boggle_dictionary_file_line(line, line_end, chunk.words))
+			chunk.word_offsets.push_back(word_offset);
+
+		// the last line may not end with a newline, and stepping past chunk.end isn't allowed
+		line = newline != chunk.end ? newline + 1 : chunk.end;
+	}
+}
+
+// sorts runs of the values in parallel, then merges pairs of runs in parallel until there's only one
+template<
+	typename TVector,
+	typename TLess>
+static void parallel_sort(
+	TVector& values,
+	const TLess& less)
+{
+	static const size_t k_minimum_run_length = 4096;
+
+	int run_count = static_cast<int>(std::min<size_t>(omp_get_max_threads(), values.size() / k_minimum_run_length));
+	run_count = std::max(run_count, 1);
+
+	std::vector<size_t> run_bounds(run_count + 1);
+	for (int run_index = 0; run_index <= run_count; run_index++)
+		run_bounds[run_index] = values.size() * run_index / run_count;
+
+#pragma omp parallel for schedule(dynamic, 1)
+	for (int run_index = 0; run_index < run_count; run_index++)
+	{
+		std::sort(values.begin() + run_bounds[run_index], values.begin() + run_bounds[run_index + 1], less);
+	}
+
+	TVector merged_values(run_count > 1 ? values.size() : 0);
+	for (int run_width = 1; run_width < run_count; run_width *= 2)
+	{
+		int merge_count = (run_count + (run_width * 2) - 1) / (run_width * 2);
+
+#pragma omp parallel for schedule(dynamic, 1)
+		for (int merge_index = 0; merge_index < merge_count; merge_index++)
+		{
+			int first_run_index = merge_index * run_width * 2;
+			auto begin = values.begin() + run_bounds[first_run_index];
+			auto middle = values.begin() + run_bounds[std::min(first_run_index + run_width, run_count)];
+			auto end = values.begin() + run_bounds[std::min(first_run_index + (run_width * 2), run_count)];
+
+			std::merge(begin, middle, middle, end, merged_values.begin() + (begin - values.begin()), less);
+		}
+
+		values.swap(merged_values);
+	}
+}
+
+bool read_boggle_dictionary_file_in_parallel(
+	const char* filename,
+	c_boggle_dictionary& dictionary)
+{
+	// small enough to spread across all threads, big enough that the per chunk overhead doesn't matter
+	static const size_t k_minimum_chunk_size = 64 * 1024;
+	static const int k_chunks_per_thread = 4;
+
+	auto start_time = std::chrono::high_resolution_clock::now();
+
+	c_memory_mapped_file mapped_file;
+	if (!mapped_file.open(filename))
+	{
+		output_error("failed to read dictionary file: %s",
+			filename);
+		return false;
+	}
+
+	output_message("reading dictionary file %s in parallel...",
+		filename);
+
+	size_t text_offset;
+	if (!handle_byte_order_marker(mapped_file.get_data(), mapped_file.get_size(), text_offset))
+	{
+		output_error("\tfile is not text or has unacceptable BOM, not processing");
+		return false;
+	}
+
+	const char* text = reinterpret_cast<const char*>(mapped_file.get_data()) + text_offset;
+	const char* text_end = reinterpret_cast<const char*>(mapped_file.get_data()) + mapped_file.get_size();
+	size_t text_size = text_end - text;
+
+	// split the text into chunks of whole lines
+	int chunk_count = static_cast<int>(std::min<size_t>(omp_get_max_threads() * k_chunks_per_thread, text_size / k_minimum_chunk_size));
+	chunk_count = std::max(chunk_count, 1);
+
+	std::vector<s_boggle_dictionary_file_chunk> chunks(chunk_count);
+	const char* chunk_begin = text;
+	for (int chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+	{
+		const char* chunk_end = text_end;
+		if (chunk_index + 1 < chunk_count)
+		{
+			chunk_end = text + (text_size * (chunk_index + 1) / chunk_count);
+			chunk_end = std::max(chunk_end, chunk_begin);
+			// past the newline, unless there isn't one, as text_end + 1 would be past the mapping
+			const char* newline = find_next_newline(chunk_end, text_end);
+			chunk_end = newline != text_end ? newline + 1 : text_end;
+		}
+
+		chunks[chunk_index].begin = chunk_begin;
+		chunks[chunk_index].end = chunk_end;
+		chunk_begin = chunk_end;
+	}
+
+#pragma omp parallel for schedule(dynamic, 1)
+	for (int chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+	{
+		decode_boggle_dictionary_file_chunk(chunks[chunk_index]);
+	}
+
+	size_t words_count = 0;
+	for (auto& chunk : chunks)
+		words_count += chunk.word_offsets.size();
+
+	// checked before sorting, as a bad file could be big enough to take a while and a lot of memory
+	if (words_count > static_cast<size_t>(k_suspect_word_count))
+	{
+		output_error("\tdictionary file has more than %d words, it may be bad, not processing: %s",
+			k_suspect_word_count,
+			filename);
+		return false;
+	}
+
+	tracked_vector_t<const char*, _memory_tag_file_io> words;
+	words.reserve(words_count);
+	for (auto& chunk : chunks)
+	{
+		for (uint32_t word_offset : chunk.word_offsets)
+			words.push_back(&chunk.words[word_offset]);
+	}
+
+	output_message("\tfinished reading dictionary file (#%d words)",
+		static_cast<int>(words.size()));
+
+	// strcmp compares as unsigned chars, same as sorting the words as std::strings
+	parallel_sort(words, [](const char* lhs, const char* rhs) { return strcmp(lhs, rhs) < 0; });
+	words.erase(
+		std::unique(words.begin(), words.end(), [](const char* lhs, const char* rhs) { return strcmp(lhs, rhs) == 0; }),
+		words.end());
+
+	// pack the words into the string pool in sorted order, so the duplicates are left behind
+	tracked_vector_t<uint32_t, _memory_tag_file_io> word_string_pool_offsets(words.size());
+	size_t string_pool_size = 0;
+	for (size_t word_index = 0; word_index < words.size(); word_index++)
+	{
+		word_string_pool_offsets[word_index] = static_cast<uint32_t>(string_pool_size);
+		string_pool_size += strlen(words[word_index]) + 1;
+	}
+
+	if (string_pool_size > UINT32_MAX)
+	{
+		output_error("\tdictionary file has too many words for the string pool: %s",
+			filename);
+		return false;
+	}
+
+	char* string_pool = tracked_new_array<char>(_memory_tag_dictionary, string_pool_size);
+	if (!string_pool)
+	{
+		output_error("\tfailed to allocate the string pool: %s",
+			filename);
+		return false;
+	}
+
+#pragma omp parallel for
+	for (int word_index = 0; word_index < static_cast<int>(words.size()); word_index++)
+	{
+		size_t word_size = (static_cast<size_t>(word_index + 1) < words.size()
+			? word_string_pool_offsets[word_index + 1]
+			: string_pool_size) - word_string_pool_offsets[word_index];
+		memcpy(&string_pool[word_string_pool_offsets[word_index]], words[word_index], word_size);
+	}
+
+	if (!dictionary.set_legal_words_from_sorted_string_pool(string_pool,
+		static_cast<uint32_t>(string_pool_size),
+		word_string_pool_offsets.data(),
+		static_cast<uint32_t>(words.size())))
+	{
+		output_error("\tfailed to add words to dictionary: %s",
+			filename);
+		return false;
+	}
+
+	auto end_time = std::chrono::high_resolution_clock::now();
+
+	long long stopwatch_millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+	long long stopwatch_micros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+	output_message("\ttotal time: %" PRId64 "ms (%" PRId64 "us)",
+		stopwatch_millis, stopwatch_micros);
+
+	return true;
+}
+
 bool write_boggle_dictionary_file(
 	const char* filename,
 	const std::vector<std::string>& all_words)
 {
 	auto start_time = std::chrono::high_resolution_clock::now();
 
-	FILE* file;
-	if (fopen_s(&file, filename, "w+") != 0)
+	c_double_buffered_file_writer file;
+	if (!file.open(filename))
 	{
 		output_error("failed to open/create dictionary file: %s",
 			filename);
@@ -264,13 +596,22 @@ bool write_boggle_dictionary_file(
 
 	for (auto& word : all_words)
 	{
-		fprintf_s(file, "%s\n", word.c_str());
+		auto word_utf8 = reinterpret_cast<char*>(file.reserve((word.size() * k_boggle_grid_char_longest_utf8_length) + 1));
+		size_t word_utf8_size = boggle_grid_char_string_to_utf8(word.c_str(), word.size(), word_utf8);
+		word_utf8[word_utf8_size++] = '\n';
+		file.commit(word_utf8_size);
 	}
 
-	fclose(file);
+	bool success = file.close();
 
 	auto end_time = std::chrono::high_resolution_clock::now();
 
+	if (!success)
+	{
+		output_error("\tfailed writing dictionary file");
+		return false;
+	}
+
 	output_message("\tfinished writing dictionary file");
 
 	long long stopwatch_millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 
+class c_boggle_dictionary;
+
 bool read_boggle_board_file(
 	const char* filename,
 	std::vector<char>& grid_chars,
@@ -14,6 +16,13 @@ bool read_boggle_dictionary_file(
 	const bool sort_all_words_after_loading = true,
 	const bool find_and_remove_duplicates = false);
 
+// Same words as read_boggle_dictionary_file with sorting and duplicate removal, but the file is
+// mapped and decoded in parallel straight into the dictionary's string pool, with no std::string
+// per word
+bool read_boggle_dictionary_file_in_parallel(
+	const char* filename,
+	c_boggle_dictionary& dictionary);
+
 bool write_boggle_dictionary_file(
 	const char* filename,
 	const std::vector<std::string>& all_words);
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <inttypes.h>
+#include <cassert>
+
+#include <bit_vectors.h>
+#include <boggle_grid_cell.h>
+
+#if defined(__SSE2__) || (defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define BOGGLE_VISITED_CELLS_SSE2 1
+#include <emmintrin.h>
+#else
+#define BOGGLE_VISITED_CELLS_SSE2 0
+#endif
+
+// Ways for the solver to track which grid cells are on the current path, as a path can't use a
+// cell twice. Each has is_visited/visit/leave, with leave always called in the reverse order of
+// visit, so the solver is templated on them.
+
+// #NOTE cell indices are 16 bit, so the bit vector is never more than 8KB and stays in L1. Measured
+// on random boards the path was 15-20% slower up to 16x16, and within noise of the bit vector from
+// 32x32 up to 255x255, so there's no board size where it's worth defaulting to. Grids of at least
+// this many cells use the path, which is more than any board can have. Contexts can choose
+// otherwise (see c_boggle_solve_context::set_visited_cells_path_min_cell_count), as can targets
+// with less cache by defining this lower
+#ifndef BOGGLE_VISITED_CELLS_PATH_MIN_CELL_COUNT
+	#define BOGGLE_VISITED_CELLS_PATH_MIN_CELL_COUNT 0x10000
+#endif
+
+enum
+{
+	k_boggle_visited_cells_path_min_cell_count = BOGGLE_VISITED_CELLS_PATH_MIN_CELL_COUNT,
+};
+
+// a bit per grid cell, cleared before each root char is solved. Every cell visited is left again,
+// so once a search finishes its bits are clear for the next
+class c_boggle_visited_cells_bit_vector
+{
+	uint32_t* m_flags;
+
+public:
+	explicit c_boggle_visited_cells_bit_vector(
+		uint32_t* flags = nullptr)
+		: m_flags(flags)
+	{
+	}
+
+	bool is_visited(
+		const boggle_grid_cell_index_t cell_index) const
+	{
+		return BIT_VECTOR_TEST_FLAG32(m_flags, cell_index);
+	}
+
+	void visit(
+		const boggle_grid_cell_index_t cell_index)
+	{
+		BIT_VECTOR_SET_FLAG32(m_flags, cell_index, true);
+	}
+
+	void leave(
+		const boggle_grid_cell_index_t cell_index)
+	{
+		BIT_VECTOR_SET_FLAG32(m_flags, cell_index, false);
+	}
+};
+
+// the cells of the current path, scanned eight at a time. A path is never longer than the
+// longest acceptable word, so however big the grid this stays within a few cache lines and
+// there's nothing to clear
+class c_boggle_visited_cells_path
+{
+public:
+	enum
+	{
+		// k_longest_acceptable_word_length, rounded up to a whole number of scans
+		k_max_path_length = 128,
+	};
+
+private:
+	enum
+	{
+		k_cells_per_scan = 8,
+	};
+
+	// unused cells are k_invalid_boggle_grid_cell_index, which never matches a visited cell, so a
+	// partially used scan needs no masking
+#if BOGGLE_VISITED_CELLS_SSE2
+	__m128i m_scans[k_max_path_length / k_cells_per_scan];
+#else
+	boggle_grid_cell_index_t m_scans[k_max_path_length / k_cells_per_scan][k_cells_per_scan];
+#endif
+	uint32_t m_path_length;
+
+	boggle_grid_cell_index_t* get_cells()
+	{
+		return reinterpret_cast<boggle_grid_cell_index_t*>(m_scans);
+	}
+
+public:
+	c_boggle_visited_cells_path()
+		: m_path_length(0)
+	{
+		auto cells = get_cells();
+		for (uint32_t path_index = 0; path_index < k_max_path_length; path_index++)
+		{
+			cells[path_index] = k_invalid_boggle_grid_cell_index;
+		}
+	}
+
+	bool is_visited(
+		const boggle_grid_cell_index_t cell_index) const
+	{
+		uint32_t scan_count = (m_path_length + k_cells_per_scan - 1) / k_cells_per_scan;
+#if BOGGLE_VISITED_CELLS_SSE2
+		const __m128i cell = _mm_set1_epi16(static_cast<short>(cell_index));
+		for (uint32_t scan_index = 0; scan_index < scan_count; scan_index++)
+		{
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(m_scans[scan_index], cell)) != 0)
+				return true;
+		}
+#else
+		for (uint32_t scan_index = 0; scan_index < scan_count; scan_index++)
+		{
+			for (boggle_grid_cell_index_t path_cell_index : m_scans[scan_index])
+			{
+				if (path_cell_index == cell_index)
+					return true;
+			}
+		}
+#endif
+		return false;
+	}
+
+	void visit(
+		const boggle_grid_cell_index_t cell_index)
+	{
+		assert(m_path_length < k_max_path_length);
+		get_cells()[m_path_length++] = cell_index;
+	}
+
+	void leave(
+		const boggle_grid_cell_index_t cell_index)
+	{
+		assert(m_path_length > 0 && get_cells()[m_path_length - 1] == cell_index);
+		get_cells()[--m_path_length] = k_invalid_boggle_grid_cell_index;
+	}
+};
@@ -0,0 +1,98 @@
+#include <precompile.h>
+#include <crc32c.h>
+
+#if defined(__SSE4_2__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define CRC32C_HARDWARE_SUPPORTED 1
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define CRC32C_HARDWARE_SUPPORTED 0
+#endif
+
+// reversed Castagnoli polynomial
+const uint32_t k_crc32c_polynomial = 0x82F63B78;
+
+static std::array<uint32_t, 256> build_crc32c_table()
+{
+	std::array<uint32_t, 256> table;
+	for (uint32_t byte = 0; byte < table.size(); byte++)
+	{
+		uint32_t crc = byte;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ ((crc & 1) ? k_crc32c_polynomial : 0);
+
+		table[byte] = crc;
+	}
+
+	return table;
+}
+
+static uint32_t crc32c_software(
+	const uint8_t* bytes,
+	const size_t size,
+	uint32_t crc)
+{
+	static const std::array<uint32_t, 256> k_table = build_crc32c_table();
+
+	for (size_t index = 0; index < size; index++)
+		crc = (crc >> 8) ^ k_table[(crc ^ bytes[index]) & 0xFF];
+
+	return crc;
+}
+
+#if CRC32C_HARDWARE_SUPPORTED
+static bool crc32c_hardware_available()
+{
+#ifdef __SSE4_2__
+	return true;
+#else
+	int cpu_info[4];
+	__cpuid(cpu_info, 1);
+	// ECX bit 20 is SSE4.2
+	return (cpu_info[2] & (1 << 20)) != 0;
+#endif
+}
+
+static uint32_t crc32c_hardware(
+	const uint8_t* bytes,
+	size_t size,
+	uint32_t crc)
+{
+	// get up to word alignment a byte at a time, then do whole words
+	for (; size > 0 && (reinterpret_cast<uintptr_t>(bytes) % sizeof(size_t)) != 0; size--)
+		crc = _mm_crc32_u8(crc, *bytes++);
+
+#if defined(_M_X64) || defined(__x86_64__)
+	uint64_t crc64 = crc;
+	for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t))
+		crc64 = _mm_crc32_u64(crc64, *reinterpret_cast<const uint64_t*>(bytes));
+	crc = static_cast<uint32_t>(crc64);
+#else
+	for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t), bytes += sizeof(uint32_t))
+		crc = _mm_crc32_u32(crc, *reinterpret_cast<const uint32_t*>(bytes));
+#endif
+
+	for (; size > 0; size--)
+		crc = _mm_crc32_u8(crc, *bytes++);
+
+	return crc;
+}
+#endif
+
+uint32_t crc32c(
+	const void* data,
+	const size_t size,
+	const uint32_t crc)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+
+#if CRC32C_HARDWARE_SUPPORTED
+	static const bool k_hardware_available = crc32c_hardware_available();
+	if (k_hardware_available)
+		return ~crc32c_hardware(bytes, size, ~crc);
+#endif
+
+	return ~crc32c_software(bytes, size, ~crc);
+}
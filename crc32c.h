@@ -0,0 +1,10 @@
+#pragma once
+
+#include <inttypes.h>
+
+// CRC-32C (Castagnoli), using the SSE4.2 crc32 instruction when the CPU supports it.
+// Pass a previous result as crc to continue the checksum over more data.
+uint32_t crc32c(
+	const void* data,
+	const size_t size,
+	const uint32_t crc = 0);
@@ -0,0 +1,446 @@
+#include <precompile.h>
+#include <double_buffered_file.h>
+
+#include <utilities.h>
+
+c_double_buffered_file_worker::c_double_buffered_file_worker()
+	: m_thread()
+	, m_mutex()
+	, m_condition()
+	, m_job()
+	, m_job_pending(false)
+	, m_stopping(false)
+{
+}
+
+c_double_buffered_file_worker::~c_double_buffered_file_worker()
+{
+	stop();
+}
+
+void c_double_buffered_file_worker::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		m_condition.wait(lock, [this]() { return m_job_pending || m_stopping; });
+		if (!m_job_pending)
+			break;
+
+		lock.unlock();
+		m_job();
+		lock.lock();
+
+		m_job_pending = false;
+		m_condition.notify_all();
+	}
+}
+
+void c_double_buffered_file_worker::start(
+	std::function<void()> job)
+{
+	assert(!m_thread.joinable());
+
+	m_job = std::move(job);
+	m_job_pending = false;
+	m_stopping = false;
+	m_thread = std::thread(&c_double_buffered_file_worker::run, this);
+}
+
+void c_double_buffered_file_worker::stop()
+{
+	if (!m_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	m_thread.join();
+	m_job = nullptr;
+}
+
+void c_double_buffered_file_worker::begin()
+{
+	assert(m_thread.joinable());
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assert(!m_job_pending);
+		m_job_pending = true;
+	}
+	m_condition.notify_all();
+}
+
+void c_double_buffered_file_worker::wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this]() { return !m_job_pending; });
+}
+
+
+c_double_buffered_file_reader::c_double_buffered_file_reader()
+	: m_file(nullptr)
+	, m_buffers()
+	, m_buffer_lengths()
+	, m_current_buffer_index(0)
+	, m_current_buffer_offset(0)
+	, m_fill_worker()
+	, m_fill_buffer_index(0)
+	, m_file_size(0)
+	, m_bytes_consumed(0)
+	, m_fill_end_of_file(false)
+	, m_fill_failed(false)
+	, m_end_of_file(false)
+	, m_failed(false)
+{
+}
+
+c_double_buffered_file_reader::~c_double_buffered_file_reader()
+{
+	close();
+}
+
+void c_double_buffered_file_reader::fill_buffer(
+	const int buffer_index)
+{
+	auto& buffer = m_buffers[buffer_index];
+
+	size_t length = fread(buffer.data(), sizeof buffer[0], buffer.size(), m_file);
+	m_buffer_lengths[buffer_index] = length;
+
+	if (length < buffer.size())
+	{
+		m_fill_end_of_file = true;
+		if (ferror(m_file))
+			m_fill_failed = true;
+	}
+}
+
+void c_double_buffered_file_reader::begin_filling_buffer(
+	const int buffer_index)
+{
+	if (m_end_of_file)
+	{
+		m_buffer_lengths[buffer_index] = 0;
+		return;
+	}
+
+	m_fill_buffer_index = buffer_index;
+	m_fill_worker.begin();
+}
+
+void c_double_buffered_file_reader::wait_for_filled_buffer()
+{
+	m_fill_worker.wait();
+
+	m_end_of_file |= m_fill_end_of_file;
+	m_failed |= m_fill_failed;
+}
+
+bool c_double_buffered_file_reader::swap_buffers()
+{
+	wait_for_filled_buffer();
+
+	int next_buffer_index = m_current_buffer_index ^ 1;
+	if (m_buffer_lengths[next_buffer_index] == 0)
+		return false;
+
+	int previous_buffer_index = m_current_buffer_index;
+	m_current_buffer_index = next_buffer_index;
+	m_current_buffer_offset = 0;
+
+	begin_filling_buffer(previous_buffer_index);
+	return true;
+}
+
+bool c_double_buffered_file_reader::open(
+	const char* filename,
+	const size_t buffer_size)
+{
+	close();
+
+	if (fopen_s(&m_file, filename, "rb") != 0)
+	{
+		m_file = nullptr;
+		return false;
+	}
+
+	if (0 != _fseeki64(m_file, 0, SEEK_END))
+	{
+		close();
+		return false;
+	}
+	m_file_size = static_cast<uint64_t>(_ftelli64(m_file));
+	_fseeki64(m_file, 0, SEEK_SET);
+
+	for (auto& buffer : m_buffers)
+		buffer.resize(buffer_size);
+
+	// the first buffer is read up front, so the file's header can be peeked at straight away
+	fill_buffer(m_current_buffer_index);
+	m_end_of_file = m_fill_end_of_file;
+	m_failed = m_fill_failed;
+	if (m_failed)
+	{
+		close();
+		return false;
+	}
+
+	m_fill_worker.start([this]() { fill_buffer(m_fill_buffer_index); });
+	begin_filling_buffer(m_current_buffer_index ^ 1);
+
+	return true;
+}
+
+void c_double_buffered_file_reader::close()
+{
+	m_fill_worker.stop();
+
+	if (m_file)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+
+	for (auto& buffer : m_buffers)
+	{
+		buffer.clear();
+		buffer.shrink_to_fit();
+	}
+
+	m_buffer_lengths[0] = m_buffer_lengths[1] = 0;
+	m_current_buffer_index = 0;
+	m_current_buffer_offset = 0;
+	m_file_size = 0;
+	m_bytes_consumed = 0;
+	m_fill_end_of_file = false;
+	m_fill_failed = false;
+	m_end_of_file = false;
+	m_failed = false;
+}
+
+bool c_double_buffered_file_reader::read(
+	void* destination,
+	const size_t size)
+{
+	auto destination_bytes = static_cast<uint8_t*>(destination);
+
+	for (size_t bytes_read = 0; bytes_read < size; )
+	{
+		size_t available = m_buffer_lengths[m_current_buffer_index] - m_current_buffer_offset;
+		if (available == 0)
+		{
+			if (!swap_buffers())
+				return false;
+
+			continue;
+		}
+
+		size_t length = std::min(available, size - bytes_read);
+		memcpy(destination_bytes + bytes_read, m_buffers[m_current_buffer_index].data() + m_current_buffer_offset, length);
+
+		m_current_buffer_offset += length;
+		m_bytes_consumed += length;
+		bytes_read += length;
+	}
+
+	return true;
+}
+
+bool c_double_buffered_file_reader::read_line(
+	std::string& out_line)
+{
+	out_line.clear();
+
+	bool read_anything = false;
+	for (;;)
+	{
+		size_t available = m_buffer_lengths[m_current_buffer_index] - m_current_buffer_offset;
+		if (available == 0)
+		{
+			if (!swap_buffers())
+				break;
+
+			continue;
+		}
+
+		auto line = reinterpret_cast<const char*>(m_buffers[m_current_buffer_index].data() + m_current_buffer_offset);
+		auto newline = static_cast<const char*>(memchr(line, '\n', available));
+		size_t length = newline
+			? static_cast<size_t>(newline - line)
+			: available;
+
+		out_line.append(line, length);
+		read_anything = true;
+
+		size_t consumed = newline ? length + 1 : length;
+		m_current_buffer_offset += consumed;
+		m_bytes_consumed += consumed;
+
+		if (newline)
+			break;
+	}
+
+	if (!out_line.empty() && out_line.back() == '\r')
+		out_line.pop_back();
+
+	return read_anything;
+}
+
+const uint8_t* c_double_buffered_file_reader::peek(
+	const size_t size) const
+{
+	size_t available = m_buffer_lengths[m_current_buffer_index] - m_current_buffer_offset;
+
+	return size <= available
+		? m_buffers[m_current_buffer_index].data() + m_current_buffer_offset
+		: nullptr;
+}
+
+
+c_double_buffered_file_writer::c_double_buffered_file_writer()
+	: m_file(nullptr)
+	, m_buffers()
+	, m_current_buffer_index(0)
+	, m_current_buffer_length(0)
+	, m_flush_worker()
+	, m_flush_buffer_index(0)
+	, m_flush_buffer_length(0)
+	, m_bytes_written(0)
+	, m_flush_failed(false)
+	, m_failed(false)
+{
+}
+
+c_double_buffered_file_writer::~c_double_buffered_file_writer()
+{
+	close();
+}
+
+void c_double_buffered_file_writer::flush_buffer()
+{
+	const uint8_t* data = m_buffers[m_flush_buffer_index].data();
+	m_flush_failed = m_flush_buffer_length != fwrite(data, sizeof data[0], m_flush_buffer_length, m_file);
+}
+
+void c_double_buffered_file_writer::wait_for_flush()
+{
+	m_flush_worker.wait();
+
+	m_failed |= m_flush_failed;
+}
+
+void c_double_buffered_file_writer::flush_current_buffer()
+{
+	wait_for_flush();
+
+	if (m_current_buffer_length == 0)
+		return;
+
+	m_flush_buffer_index = m_current_buffer_index;
+	m_flush_buffer_length = m_current_buffer_length;
+	m_flush_worker.begin();
+
+	m_current_buffer_index ^= 1;
+	m_current_buffer_length = 0;
+}
+
+bool c_double_buffered_file_writer::open(
+	const char* filename,
+	const size_t buffer_size)
+{
+	close();
+
+	if (fopen_s(&m_file, filename, "w+b") != 0)
+	{
+		m_file = nullptr;
+		return false;
+	}
+
+	for (auto& buffer : m_buffers)
+		buffer.resize(buffer_size);
+
+	m_flush_worker.start([this]() { flush_buffer(); });
+
+	return true;
+}
+
+bool c_double_buffered_file_writer::close()
+{
+	if (!m_file)
+		return !m_failed;
+
+	flush_current_buffer();
+	wait_for_flush();
+	m_flush_worker.stop();
+
+	bool success = !m_failed;
+
+	fclose(m_file);
+	m_file = nullptr;
+
+	for (auto& buffer : m_buffers)
+	{
+		buffer.clear();
+		buffer.shrink_to_fit();
+	}
+
+	m_current_buffer_index = 0;
+	m_current_buffer_length = 0;
+	m_flush_buffer_index = 0;
+	m_flush_buffer_length = 0;
+	m_bytes_written = 0;
+	m_flush_failed = false;
+	m_failed = false;
+
+	return success;
+}
+
+bool c_double_buffered_file_writer::write(
+	const void* data,
+	const size_t size)
+{
+	auto data_bytes = static_cast<const uint8_t*>(data);
+
+	for (size_t bytes_written = 0; bytes_written < size; )
+	{
+		auto& buffer = m_buffers[m_current_buffer_index];
+		if (m_current_buffer_length == buffer.size())
+		{
+			flush_current_buffer();
+			continue;
+		}
+
+		size_t length = std::min(buffer.size() - m_current_buffer_length, size - bytes_written);
+		memcpy(buffer.data() + m_current_buffer_length, data_bytes + bytes_written, length);
+
+		m_current_buffer_length += length;
+		bytes_written += length;
+	}
+
+	m_bytes_written += size;
+	return !m_failed;
+}
+
+uint8_t* c_double_buffered_file_writer::reserve(
+	const size_t size)
+{
+	assert(size <= m_buffers[m_current_buffer_index].size());
+
+	if (m_buffers[m_current_buffer_index].size() - m_current_buffer_length < size)
+		flush_current_buffer();
+
+	return m_buffers[m_current_buffer_index].data() + m_current_buffer_length;
+}
+
+void c_double_buffered_file_writer::commit(
+	const size_t size)
+{
+	assert(m_current_buffer_length + size <= m_buffers[m_current_buffer_index].size());
+
+	m_current_buffer_length += size;
+	m_bytes_written += size;
+}
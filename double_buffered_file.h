@@ -0,0 +1,223 @@
+#pragma once
+
+#include <inttypes.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tracked_memory.h>
+
+struct _iobuf;
+
+enum
+{
+	k_double_buffered_file_default_buffer_size = 1 << 20,
+};
+
+// Runs a file's job, e.g. filling a buffer, on one thread kept for as long as the file is open,
+// rather than creating and joining a thread every time the buffers are swapped.
+
+class c_double_buffered_file_worker
+{
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::function<void()> m_job;
+	// set by begin, cleared by the thread once the job has run
+	bool m_job_pending;
+	bool m_stopping;
+
+private:
+	void run();
+
+public:
+	c_double_buffered_file_worker();
+	~c_double_buffered_file_worker();
+
+	c_double_buffered_file_worker(const c_double_buffered_file_worker&) = delete;
+	c_double_buffered_file_worker& operator=(const c_double_buffered_file_worker&) = delete;
+
+	// starts the thread, which then runs job once per begin
+	void start(
+		std::function<void()> job);
+
+	// runs any job still pending, then ends the thread
+	void stop();
+
+	// the previous job must have been waited for
+	void begin();
+
+	// returns once the job last begun has run. What the job wrote is visible to the caller after
+	void wait();
+};
+
+// Reads a file through two buffers. The next one is filled on another thread while the current
+// one is consumed, so parsing only waits on the disk when it outruns it.
+
+class c_double_buffered_file_reader
+{
+	_iobuf* m_file;
+	tracked_vector_t<uint8_t, _memory_tag_file_io> m_buffers[2];
+	size_t m_buffer_lengths[2];
+	int m_current_buffer_index;
+	size_t m_current_buffer_offset;
+	// fills the other buffer
+	c_double_buffered_file_worker m_fill_worker;
+	int m_fill_buffer_index;
+	uint64_t m_file_size;
+	uint64_t m_bytes_consumed;
+	// set by the fill, only read once it's waited for and merged into the flags below
+	bool m_fill_end_of_file;
+	bool m_fill_failed;
+	bool m_end_of_file;
+	bool m_failed;
+
+private:
+	void fill_buffer(
+		const int buffer_index);
+
+	void begin_filling_buffer(
+		const int buffer_index);
+
+	void wait_for_filled_buffer();
+
+	// waits for the other buffer to be filled and makes it current. False at end of file
+	bool swap_buffers();
+
+public:
+	c_double_buffered_file_reader();
+	~c_double_buffered_file_reader();
+
+	c_double_buffered_file_reader(const c_double_buffered_file_reader&) = delete;
+	c_double_buffered_file_reader& operator=(const c_double_buffered_file_reader&) = delete;
+
+	bool open(
+		const char* filename,
+		const size_t buffer_size = k_double_buffered_file_default_buffer_size);
+
+	void close();
+
+	bool is_open() const
+	{
+		return m_file != nullptr;
+	}
+
+	// false if the file ends first
+	bool read(
+		void* destination,
+		const size_t size);
+
+	template<
+		typename TValue>
+	bool read(
+		TValue& out_value)
+	{
+		return read(&out_value, sizeof(out_value));
+	}
+
+	// reads up to the next '\n', which is consumed but not returned, and neither is a '\r' before
+	// it. False at end of file
+	bool read_line(
+		std::string& out_line);
+
+	// the next size bytes without consuming them. Returns nullptr if they aren't all in the current
+	// buffer, though right after open they are unless the file is shorter
+	const uint8_t* peek(
+		const size_t size) const;
+
+	// reading failed, rather than just reached the end of the file
+	bool has_failed() const
+	{
+		return m_failed;
+	}
+
+	uint64_t get_file_size() const
+	{
+		return m_file_size;
+	}
+
+	uint64_t get_bytes_consumed() const
+	{
+		return m_bytes_consumed;
+	}
+};
+
+// Writes a file through two buffers. A full buffer is written out on another thread while the
+// other one is filled.
+
+class c_double_buffered_file_writer
+{
+	_iobuf* m_file;
+	tracked_vector_t<uint8_t, _memory_tag_file_io> m_buffers[2];
+	int m_current_buffer_index;
+	size_t m_current_buffer_length;
+	// writes out the other buffer
+	c_double_buffered_file_worker m_flush_worker;
+	int m_flush_buffer_index;
+	size_t m_flush_buffer_length;
+	uint64_t m_bytes_written;
+	// set by the flush, only read once it's waited for
+	bool m_flush_failed;
+	bool m_failed;
+
+private:
+	void flush_buffer();
+
+	void wait_for_flush();
+
+	// hands the current buffer to the flush worker and makes the other one current
+	void flush_current_buffer();
+
+public:
+	c_double_buffered_file_writer();
+	~c_double_buffered_file_writer();
+
+	c_double_buffered_file_writer(const c_double_buffered_file_writer&) = delete;
+	c_double_buffered_file_writer& operator=(const c_double_buffered_file_writer&) = delete;
+
+	bool open(
+		const char* filename,
+		const size_t buffer_size = k_double_buffered_file_default_buffer_size);
+
+	// writes out whatever is still buffered. False if any write failed
+	bool close();
+
+	bool is_open() const
+	{
+		return m_file != nullptr;
+	}
+
+	bool write(
+		const void* data,
+		const size_t size);
+
+	template<
+		typename TValue>
+	bool write(
+		const TValue& value)
+	{
+		return write(&value, sizeof(value));
+	}
+
+	// room for up to size bytes (no more than the buffer size) to be formatted in place, then
+	// committed with commit
+	uint8_t* reserve(
+		const size_t size);
+
+	void commit(
+		const size_t size);
+
+	bool has_failed() const
+	{
+		return m_failed;
+	}
+
+	// including what's still buffered
+	uint64_t get_bytes_written() const
+	{
+		return m_bytes_written;
+	}
+};
@@ -1,92 +1,1355 @@
 #include <precompile.h>
 
-#include <ransampl.h>
-
 #include <boggle.h>
+#include <boggle_benchmark.h>
+#include <boggle_board_batch_file.h>
 #include <boggle_dictionary.h>
+#include <boggle_dictionary_binary_file.h>
+#include <boggle_dictionary_compact_trie.h>
+#include <boggle_dictionary_compact_trie_cache.h>
+#include <boggle_dictionary_registry.h>
+#include <boggle_found_words.h>
 #include <boggle_grid_char.h>
+#include <boggle_merged_dictionary.h>
+#include <boggle_resident_dictionary.h>
+#include <boggle_result_file.h>
+#include <boggle_solve_context.h>
 #include <boggle_text_file_io.h>
+#include <double_buffered_file.h>
+#include <trace.h>
 #include <utilities.h>
 
-void boggle_board_unit_tests();
+static bool boggle_board_unit_tests();
+static bool solve_boggle_board_batch_file(
+	const char* boards_filename,
+	const char* results_filename);
 
-int main()
+int main(
+	int argc,
+	char* argv[])
 {
 	boggle_grid_char_definitions_initialize();
 
-	boggle_board_unit_tests();
-
-	return 0;
-}
+	// --trace trace.json, ahead of any other arguments, captures a Chrome trace of the whole run
+	const char* trace_filename = nullptr;
+	if (argc > 2 && strcmp(argv[1], "--trace") == 0)
+	{
+		trace_filename = argv[2];
+		argc -= 2;
+		argv += 2;
 
-static void generate_boggle_board(
-	const int board_width,
-	const int board_height,
-	std::string& board_letters)
-{
-	int board_cell_count = board_width * board_height;
-	board_letters.reserve(board_cell_count + 1);
+		trace_begin_capture();
+	}
 
-	ransampl_ws* ws = ransampl_alloc(static_cast<int>(k_boggle_grid_char_frequencies.size()));
-	ransampl_set(ws, k_boggle_grid_char_frequencies.data());
+	bool success = true;
 
-	std::default_random_engine generator;
-	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	// --benchmark [report.json] runs the benchmark sweep instead
+	if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+	{
+		s_boggle_benchmark_options benchmark_options;
+		get_default_boggle_benchmark_options(benchmark_options);
+		if (argc > 2)
+			benchmark_options.report_filename = argv[2];
 
-	for (int x = 0; x < board_cell_count; x++)
+		success = run_boggle_benchmarks(benchmark_options);
+	}
+	// given a board batch file (and optionally a file for the results), solve its boards instead
+	else if (argc > 1)
+	{
+		success = solve_boggle_board_batch_file(argv[1], argc > 2 ? argv[2] : nullptr);
+	}
+	else
 	{
-		double ran1 = distribution(generator);
-		double ran2 = distribution(generator);
+		success = boggle_board_unit_tests();
+	}
 
-		int freq_index = ransampl_draw(ws, ran1, ran2);
-		auto grid_char = static_cast<boggle_grid_char_t>(freq_index);
-		board_letters.push_back( boggle_grid_char_to_string(grid_char)[0] );
+	if (trace_filename)
+	{
+		trace_end_capture();
+		success = trace_write_chrome_json(trace_filename) && success;
 	}
 
-	ransampl_free(ws);
+	return success
+		? 0
+		: 1;
 }
 
-static void boggle_board_unit_tests()
+static bool load_legal_words(
+	c_boggle& boggle)
 {
-	boggle_grid_char_definitions_initialize();
-
-	c_boggle boggle;
 	static const char* k_boggle_dictionary_filename =
 		R"(data\english.boggle_dictionary)";
 
-	std::vector<std::string> all_boggle_words;
-	std::vector<char> grid_chars;
-	int board_width, board_height;
-
-	const char* board_letters = nullptr;
-
 	output_message("loading precomputed legal words dictionary binary %s",
 		k_boggle_dictionary_filename);
-	if (!boggle.load_binary_legal_words(k_boggle_dictionary_filename))
+	if (!boggle.map_binary_legal_words(k_boggle_dictionary_filename))
 	{
 		output_message("couldn't open legal words dictionary, loading from txt file instead");
 
-		if (!read_boggle_dictionary_file(
-			R"(data\english.txt)",
-			//R"(data\10x10_Dictionary.txt)",
-			all_boggle_words,
-			false,
-			false))
+		if (!boggle.load_text_legal_words(
+			R"(data\english.txt)"))
+			//R"(data\10x10_Dictionary.txt)"))
 		{
-			output_error("abandoning test, failed to read legal words txt file");
-			return;
+			output_error("failed to read legal words txt file");
+			return false;
 		}
 
-		boggle.set_legal_words_from_alphabetically_sorted_array(all_boggle_words);
-		all_boggle_words.clear();
-		all_boggle_words.shrink_to_fit();
-
 		if (!boggle.save_binary_legal_words(k_boggle_dictionary_filename))
 		{
 			output_message("couldn't save legal words dictionary, perf won't be saved next time");
 		}
 	}
 
+	return true;
+}
+
+// .jsonl and .boggle_results files get those formats, anything else gets text
+static e_boggle_result_file_format get_boggle_result_file_format(
+	const char* results_filename)
+{
+	const char* extension = strrchr(results_filename, '.');
+	if (extension && _stricmp(extension, ".jsonl") == 0)
+		return _boggle_result_file_format_json_lines;
+	if (extension && _stricmp(extension, ".boggle_results") == 0)
+		return _boggle_result_file_format_binary;
+
+	return _boggle_result_file_format_text;
+}
+
+static bool solve_boggle_board_batch_file(
+	const char* boards_filename,
+	const char* results_filename)
+{
+	c_boggle boggle;
+	if (!load_legal_words(boggle))
+	{
+		output_error("abandoning batch, failed to load legal words");
+		return false;
+	}
+
+	c_boggle_board_batch_reader reader;
+	if (!reader.open(boards_filename))
+		return false;
+
+	c_boggle_result_writer result_writer;
+	if (results_filename &&
+		!result_writer.open(results_filename, get_boggle_result_file_format(results_filename)))
+	{
+		return false;
+	}
+
+	output_message("solving boards from %s...",
+		boards_filename);
+
+	auto start_time = std::chrono::high_resolution_clock::now();
+
+	c_boggle::board_batch_solved_callback_t board_solved_callback = nullptr;
+	if (results_filename)
+	{
+		board_solved_callback = [&result_writer](const s_boggle_batch_board& board, const s_boggle_found_words& found_words)
+		{
+			result_writer.write_board(board, found_words);
+		};
+	}
+
+	bool success = boggle.solve_board_batch(reader,
+		board_solved_callback,
+		[](const s_boggle_board_batch_progress& progress)
+		{
+			output_message("\t%" PRIu64 " boards solved, %" PRIu64 " words found (%d%% of file)",
+				progress.boards_solved,
+				progress.words_found,
+				progress.file_size > 0
+					? static_cast<int>((progress.bytes_read * 100) / progress.file_size)
+					: 100);
+		});
+
+	auto end_time = std::chrono::high_resolution_clock::now();
+
+	long long stopwatch_millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+	long long stopwatch_micros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+	printf_s("total time: %" PRId64 "ms (%" PRId64 "us)\n",
+		stopwatch_millis, stopwatch_micros);
+
+	if (results_filename && !result_writer.close())
+	{
+		output_error("failed to write all results to %s",
+			results_filename);
+		success = false;
+	}
+
+	return success;
+}
+
+// the words found on a board, named as solve_board names them
+static void get_found_word_strings(
+	const s_boggle_found_words& found_words,
+	std::vector<std::string>& out_words)
+{
+	out_words.clear();
+	for_each_boggle_found_word(found_words,
+		[&out_words](const uint32_t, const char* word_string, const uint32_t word_length)
+		{
+			out_words.emplace_back(word_string, word_length);
+		});
+}
+
+static bool check_found_words(
+	const char* check_name,
+	const s_boggle_batch_board& board,
+	const std::vector<std::string>& expected_words,
+	const std::vector<std::string>& words)
+{
+	if (words == expected_words)
+		return true;
+
+	output_error("\t%s found %d words on %dx%d board %s, expected %d",
+		check_name,
+		static_cast<int>(words.size()),
+		board.width, board.height,
+		board.letters.c_str(),
+		static_cast<int>(expected_words.size()));
+	return false;
+}
+
+static bool check_boards_found_words(
+	const char* check_name,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words,
+	const std::vector<std::vector<std::string>>& boards_words)
+{
+	if (boards_words.size() != boards.size())
+	{
+		output_error("\t%s solved %d boards, expected %d",
+			check_name,
+			static_cast<int>(boards_words.size()),
+			static_cast<int>(boards.size()));
+		return false;
+	}
+
+	bool success = true;
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		success = check_found_words(check_name, boards[board_index], boards_expected_words[board_index], boards_words[board_index]) &&
+			success;
+	}
+
+	return success;
+}
+
+static bool write_board_batch_file(
+	const char* boards_filename,
+	const e_boggle_board_batch_file_format format,
+	const std::vector<s_boggle_batch_board>& boards)
+{
+	c_boggle_board_batch_writer writer;
+	bool success = writer.open(boards_filename, format);
+	for (size_t board_index = 0; success && board_index < boards.size(); board_index++)
+	{
+		success = writer.write_board(boards[board_index]);
+	}
+
+	return writer.close() && success;
+}
+
+// solves every board of a batch file, leaving the words found on each in the order they were read.
+// board_solved_callback (if any) is also given each board
+static bool solve_board_batch_file_words(
+	c_boggle& boggle,
+	const char* boards_filename,
+	std::vector<std::vector<std::string>>& out_boards_words,
+	const c_boggle::board_batch_solved_callback_t& board_solved_callback = nullptr)
+{
+	out_boards_words.clear();
+
+	c_boggle_board_batch_reader reader;
+	if (!reader.open(boards_filename))
+		return false;
+
+	return boggle.solve_board_batch(reader,
+		[&out_boards_words, &board_solved_callback](const s_boggle_batch_board& board, const s_boggle_found_words& found_words)
+		{
+			out_boards_words.emplace_back();
+			get_found_word_strings(found_words, out_boards_words.back());
+
+			if (board_solved_callback)
+				board_solved_callback(board, found_words);
+		});
+}
+
+// every third of the dictionary's words, for a second dictionary finding some of the same words
+static void get_every_third_dictionary_word(
+	const c_boggle_dictionary& dictionary,
+	std::vector<std::string>& out_words)
+{
+	out_words.clear();
+
+	int word_index = 0;
+	for (auto word = dictionary.begin_words(), end = dictionary.end_words(); word != end; ++word, word_index++)
+	{
+		if (word_index % 3 == 0)
+			out_words.emplace_back(dictionary.get_string(*word), word->get_length());
+	}
+}
+
+// the words of each board which are also among the alphabetically sorted words
+static void get_boards_words_in_sorted_words(
+	const std::vector<std::vector<std::string>>& boards_words,
+	const std::vector<std::string>& sorted_words,
+	std::vector<std::vector<std::string>>& out_boards_words)
+{
+	out_boards_words.clear();
+	for (auto& words : boards_words)
+	{
+		out_boards_words.emplace_back();
+		for (auto& word : words)
+		{
+			if (std::binary_search(sorted_words.begin(), sorted_words.end(), word))
+				out_boards_words.back().push_back(word);
+		}
+	}
+}
+
+// boards from a fixed seed, so any failure reproduces. Sizes either side of where a root's walks
+// stop being interleaved, a board that isn't square, and one with plenty of 'q' cells
+static void generate_behaviour_check_boards(
+	std::vector<s_boggle_batch_board>& out_boards)
+{
+	static const std::array<int, 5> k_board_sizes = { {
+		4, 5, 10, 12, 16,
+	} };
+	static const int k_boards_per_size = 4;
+
+	std::default_random_engine generator(1234);
+	s_boggle_batch_board board;
+	for (int board_size : k_board_sizes)
+	{
+		for (int board_index = 0; board_index < k_boards_per_size; board_index++)
+		{
+			board.width = board.height = board_size;
+			generate_random_boggle_board(board.width, board.height, generator, board.letters);
+			out_boards.push_back(board);
+		}
+	}
+
+	board.width = 9;
+	board.height = 3;
+	generate_random_boggle_board(board.width, board.height, generator, board.letters);
+	out_boards.push_back(board);
+
+	// 'q' cells spell "qu", which the solver special cases
+	board.width = board.height = 4;
+	board.letters = "qiteqarsnqelquot";
+	out_boards.push_back(board);
+}
+
+// the compact trie is laid out depth first rather than in word order, but must still spell out
+// exactly the dictionary's words
+static bool check_dictionary_trie_layout(
+	const c_boggle& boggle)
+{
+	auto dictionary = boggle.get_dictionary();
+
+	std::vector<std::string> dictionary_words;
+	dictionary_words.reserve(dictionary->get_words_count());
+	for (auto word = dictionary->begin_words(), end = dictionary->end_words(); word != end; ++word)
+	{
+		dictionary_words.emplace_back(dictionary->get_string(*word), word->get_length());
+	}
+
+	std::vector<std::string> trie_words;
+	boggle.get_dictionary_trie()->dump(trie_words);
+	std::sort(trie_words.begin(), trie_words.end());
+
+	if (trie_words != dictionary_words)
+	{
+		output_error("\tdictionary trie spells out %d words, expected the dictionary's %d",
+			static_cast<int>(trie_words.size()),
+			static_cast<int>(dictionary_words.size()));
+		return false;
+	}
+
+	return true;
+}
+
+// solving with filtered tries must find the same words. Boards whose grid chars the cache has
+// seen before must hit it, batch solves must share it, and it must evict down to its budget
+static bool check_filtered_dictionary_tries(
+	const c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_boards_filename = R"(behaviour_check_filtered.boggle_boards)";
+
+	c_boggle filtering_boggle;
+	filtering_boggle.set_resident_dictionary(boggle.get_resident_dictionary());
+	filtering_boggle.set_filter_dictionary_with_occuring_grid_chars(true);
+	// every board's trie must stay cached, however big the tries of this build's alphabet are
+	filtering_boggle.set_filtered_dictionary_trie_cache_memory_budget(std::numeric_limits<size_t>::max());
+
+	bool success = true;
+	std::vector<std::string> words;
+	c_boggle_dictionary_compact_trie_cache::s_statistics first_statistics = {};
+	// the second time round, every board's trie is already cached
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (size_t board_index = 0; board_index < boards.size(); board_index++)
+		{
+			auto& board = boards[board_index];
+
+			words.clear();
+			success = filtering_boggle.solve_board(words, board.width, board.height, board.letters.c_str()) &&
+				check_found_words("filtered trie solve", board, boards_expected_words[board_index], words) &&
+				success;
+		}
+
+		if (pass == 0 && filtering_boggle.get_filtered_dictionary_trie_cache())
+			first_statistics = filtering_boggle.get_filtered_dictionary_trie_cache()->get_statistics();
+	}
+
+	auto filtered_dictionary_trie_cache = filtering_boggle.get_filtered_dictionary_trie_cache();
+	if (!filtered_dictionary_trie_cache)
+	{
+		output_error("\tfiltered trie solves didn't create a filtered trie cache");
+		return false;
+	}
+
+	auto statistics = filtered_dictionary_trie_cache->get_statistics();
+	if (first_statistics.hit_count + first_statistics.miss_count != boards.size() ||
+		statistics.hit_count != first_statistics.hit_count + boards.size() ||
+		statistics.miss_count != first_statistics.miss_count ||
+		statistics.eviction_count != 0 ||
+		statistics.entry_count != first_statistics.miss_count)
+	{
+		output_error("\tfiltered trie cache has %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " evictions and %u entries after solving %d boards twice",
+			statistics.hit_count,
+			statistics.miss_count,
+			statistics.eviction_count,
+			statistics.entry_count,
+			static_cast<int>(boards.size()));
+		success = false;
+	}
+
+	// every board's trie is still cached, so a batch of the same boards only hits the cache
+	std::vector<std::vector<std::string>> boards_words;
+	if (!write_board_batch_file(k_boards_filename, _boggle_board_batch_file_format_text, boards) ||
+		!solve_board_batch_file_words(filtering_boggle, k_boards_filename, boards_words))
+	{
+		output_error("\tfailed to solve a board batch with filtered tries");
+		success = false;
+	}
+	else
+	{
+		success = check_boards_found_words("filtered trie batch solve", boards, boards_expected_words, boards_words) &&
+			success;
+
+		auto batch_statistics = filtered_dictionary_trie_cache->get_statistics();
+		if (batch_statistics.hit_count != statistics.hit_count + boards.size() ||
+			batch_statistics.miss_count != statistics.miss_count)
+		{
+			output_error("\tfiltered trie batch solve didn't reuse the cached tries");
+			success = false;
+		}
+		statistics = batch_statistics;
+	}
+	remove(k_boards_filename);
+
+	// only the most recently used trie is kept over budget
+	filtering_boggle.set_filtered_dictionary_trie_cache_memory_budget(1);
+	auto evicted_statistics = filtered_dictionary_trie_cache->get_statistics();
+	if (evicted_statistics.entry_count != 1 ||
+		evicted_statistics.eviction_count != statistics.entry_count - 1)
+	{
+		output_error("\tfiltered trie cache kept %u of %u entries over budget, with %" PRIu64 " evictions",
+			evicted_statistics.entry_count,
+			statistics.entry_count,
+			evicted_statistics.eviction_count);
+		success = false;
+	}
+
+	return success;
+}
+
+// saved binary legal words must load back as the same words, and a corrupted section must fail
+// its checksum
+static bool check_binary_dictionary_round_trip(
+	const c_boggle& boggle)
+{
+	static const char* k_dictionary_filename = R"(behaviour_check.boggle_dictionary)";
+	static const char* k_corrupted_dictionary_filename = R"(behaviour_check_corrupted.boggle_dictionary)";
+
+	if (!boggle.get_resident_dictionary()->save_binary_file(k_dictionary_filename))
+	{
+		output_error("\tfailed to save binary legal words");
+		return false;
+	}
+
+	bool success = true;
+
+	s_boggle_resident_dictionary_binary_file_options options = {};
+	options.verify_checksums = true;
+	auto loaded_dictionary = c_boggle_resident_dictionary::create_from_binary_file(k_dictionary_filename, options);
+	if (!loaded_dictionary || !loaded_dictionary->has_same_content(*boggle.get_resident_dictionary()))
+	{
+		output_error("\tbinary legal words didn't load back as the same words");
+		success = false;
+	}
+
+	// flip a byte in the middle of the dictionary section
+	std::vector<uint8_t> file_bytes;
+	s_boggle_dictionary_binary_file_layout layout;
+	FILE* file;
+	if (fopen_s(&file, k_dictionary_filename, "rb") == 0)
+	{
+		if (read_boggle_dictionary_binary_file_layout(file, false, layout) &&
+			0 == _fseeki64(file, 0, SEEK_END))
+		{
+			file_bytes.resize(static_cast<size_t>(_ftelli64(file)));
+			_fseeki64(file, 0, SEEK_SET);
+			if (fread(file_bytes.data(), 1, file_bytes.size(), file) != file_bytes.size())
+				file_bytes.clear();
+		}
+		fclose(file);
+	}
+
+	auto& dictionary_section = layout.sections[_boggle_dictionary_binary_file_section_dictionary];
+	if (file_bytes.empty() || dictionary_section.length == 0)
+	{
+		output_error("\tfailed to read back binary legal words");
+		success = false;
+	}
+	else
+	{
+		file_bytes[static_cast<size_t>(dictionary_section.offset + (dictionary_section.length / 2))] ^= 0x01;
+
+		if (fopen_s(&file, k_corrupted_dictionary_filename, "wb") == 0)
+		{
+			fwrite(file_bytes.data(), 1, file_bytes.size(), file);
+			fclose(file);
+		}
+
+		output_message("\tloading corrupted binary legal words, which should fail its checksum:");
+		if (c_boggle_resident_dictionary::create_from_binary_file(k_corrupted_dictionary_filename, options))
+		{
+			output_error("\tcorrupted binary legal words loaded despite verifying checksums");
+			success = false;
+		}
+	}
+
+	remove(k_dictionary_filename);
+	remove(k_corrupted_dictionary_filename);
+
+	return success;
+}
+
+// binary legal words loaded trie-only must still find the same words, named from the trie
+static bool check_trie_only_dictionary_solves(
+	const c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_dictionary_filename = R"(behaviour_check_trie_only.boggle_dictionary)";
+
+	c_boggle trie_only_boggle;
+	trie_only_boggle.set_load_trie_only_dictionary(true);
+	if (!boggle.get_resident_dictionary()->save_binary_file(k_dictionary_filename) ||
+		!trie_only_boggle.load_binary_legal_words(k_dictionary_filename))
+	{
+		output_error("\tfailed to load binary legal words trie-only");
+		remove(k_dictionary_filename);
+		return false;
+	}
+	remove(k_dictionary_filename);
+
+	bool success = true;
+	if (!trie_only_boggle.get_dictionary()->is_trie_only())
+	{
+		output_error("\tbinary legal words loaded trie-only kept their words");
+		success = false;
+	}
+
+	std::vector<std::string> words;
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+
+		words.clear();
+		success = trie_only_boggle.solve_board(words, board.width, board.height, board.letters.c_str()) &&
+			check_found_words("trie-only solve", board, boards_expected_words[board_index], words) &&
+			success;
+	}
+
+	return success;
+}
+
+// the same binary legal words or words added to a registry under several ids must share one
+// resident dictionary, even when added from several threads at once, and solve boards as
+// solve_board does. A dictionary whose content key collides with another's must keep its own words
+static bool check_dictionary_registry(
+	const c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_dictionary_filename = R"(behaviour_check_registry.boggle_dictionary)";
+	static const int k_concurrent_add_count = 8;
+	// different words, but the same content key, as their CRC-32Cs collide
+	static const std::array<const char*, 2> k_colliding_words = { {
+		"ymkriezb",
+		"zvahmshc",
+	} };
+
+	c_boggle_dictionary_registry registry;
+
+	s_boggle_resident_dictionary_binary_file_options options = {};
+	options.verify_checksums = true;
+	bool added_binary_legal_words = boggle.get_resident_dictionary()->save_binary_file(k_dictionary_filename) &&
+		registry.add_from_binary_file("english", k_dictionary_filename, options) &&
+		registry.add_from_binary_file("english_again", k_dictionary_filename, options);
+	remove(k_dictionary_filename);
+	if (!added_binary_legal_words)
+	{
+		output_error("\tfailed to add binary legal words to the registry");
+		return false;
+	}
+
+	bool success = true;
+	if (registry.find("english") != registry.find("english_again"))
+	{
+		output_error("\tbinary legal words added to the registry twice weren't shared");
+		success = false;
+	}
+
+	c_boggle_solve_context context;
+	std::vector<std::string> words;
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+
+		words.clear();
+		success = registry.solve_board("english", context, &words, board.width, board.height, board.letters.c_str()) &&
+			check_found_words("registry solve", board, boards_expected_words[board_index], words) &&
+			success;
+	}
+
+	// each thread adds the same words under its own id. Enough of them that the threads are still
+	// building their own copies of the dictionary when the first is added
+	std::vector<std::string> shared_words;
+	auto dictionary = boggle.get_dictionary();
+	for (auto word = dictionary->begin_words(), end = dictionary->end_words(); word != end && shared_words.size() < 50000; ++word)
+	{
+		shared_words.emplace_back(dictionary->get_string(*word), word->get_length());
+	}
+
+	int failed_add_count = 0;
+#pragma omp parallel for num_threads(k_concurrent_add_count) reduction(+:failed_add_count)
+	for (int add_index = 0; add_index < k_concurrent_add_count; add_index++)
+	{
+		std::string id = "shared_" + std::to_string(add_index);
+		if (!registry.add_from_alphabetically_sorted_array(id.c_str(), shared_words))
+			failed_add_count++;
+	}
+
+	auto shared_dictionary = registry.find("shared_0");
+	for (int add_index = 0; add_index < k_concurrent_add_count; add_index++)
+	{
+		std::string id = "shared_" + std::to_string(add_index);
+		if (failed_add_count > 0 || !shared_dictionary || registry.find(id.c_str()) != shared_dictionary)
+		{
+			output_error("\twords added to the registry from %d threads at once weren't all shared",
+				k_concurrent_add_count);
+			success = false;
+			break;
+		}
+	}
+
+	std::array<std::vector<std::string>, 2> colliding_words;
+	std::array<std::shared_ptr<const c_boggle_resident_dictionary>, 2> colliding_dictionaries;
+	for (size_t colliding_index = 0; colliding_index < colliding_words.size(); colliding_index++)
+	{
+		std::string id = "colliding_" + std::to_string(colliding_index);
+		colliding_words[colliding_index].push_back(k_colliding_words[colliding_index]);
+		registry.add_from_alphabetically_sorted_array(id.c_str(), colliding_words[colliding_index]);
+		colliding_dictionaries[colliding_index] = registry.find(id.c_str());
+	}
+
+	if (!colliding_dictionaries[0] || !colliding_dictionaries[1] ||
+		colliding_dictionaries[0]->get_content_key() < colliding_dictionaries[1]->get_content_key() ||
+		colliding_dictionaries[1]->get_content_key() < colliding_dictionaries[0]->get_content_key())
+	{
+		output_error("\tfailed to add dictionaries with colliding content keys to the registry");
+		success = false;
+	}
+	else if (colliding_dictionaries[0] == colliding_dictionaries[1] ||
+		!colliding_dictionaries[1]->get_dictionary()->has_legal_words(colliding_words[1]))
+	{
+		output_error("\tthe registry shared a dictionary with different words, as their content keys collided");
+		success = false;
+	}
+
+	return success;
+}
+
+// a dictionary published while boards are being solved mustn't change the words found by solves
+// already in flight, which keep the previous dictionary until the last of them finishes. One loaded
+// in the background is in place once its future is ready
+static bool check_dictionary_hot_swap(
+	const c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_boards_filename = R"(behaviour_check_hot_swap.boggle_boards)";
+	static const char* k_words_filename = R"(behaviour_check_hot_swap_words.txt)";
+
+	std::vector<std::string> every_third_word;
+	get_every_third_dictionary_word(*boggle.get_dictionary(), every_third_word);
+	std::vector<std::vector<std::string>> boards_every_third_word_expected_words;
+	get_boards_words_in_sorted_words(boards_expected_words, every_third_word, boards_every_third_word_expected_words);
+
+	c_boggle swapping_boggle;
+	swapping_boggle.set_legal_words_from_alphabetically_sorted_array(every_third_word);
+	std::weak_ptr<const c_boggle_resident_dictionary> every_third_word_dictionary = swapping_boggle.get_resident_dictionary();
+
+	// the full dictionary is published from the first board's callback, while the batch still has
+	// the found words of the rest to hand over
+	bool published_dictionary = false;
+	std::vector<std::vector<std::string>> boards_words;
+	bool solved_boards = write_board_batch_file(k_boards_filename, _boggle_board_batch_file_format_text, boards) &&
+		solve_board_batch_file_words(swapping_boggle, k_boards_filename, boards_words,
+			[&boggle, &swapping_boggle, &published_dictionary](const s_boggle_batch_board&, const s_boggle_found_words&)
+			{
+				if (!published_dictionary)
+					swapping_boggle.set_resident_dictionary(boggle.get_resident_dictionary());
+				published_dictionary = true;
+			});
+	remove(k_boards_filename);
+	if (!solved_boards)
+	{
+		output_error("	failed to solve a batch of boards while publishing a new dictionary");
+		return false;
+	}
+
+	bool success = check_boards_found_words("hot swapped batch solve", boards, boards_every_third_word_expected_words, boards_words);
+	if (!every_third_word_dictionary.expired())
+	{
+		output_error("	the dictionary replaced during a batch solve outlived it");
+		success = false;
+	}
+
+	if (!write_boggle_dictionary_file(k_words_filename, every_third_word))
+	{
+		output_error("	failed to write legal words to load in the background");
+		return false;
+	}
+
+	// every solve while the words load finds either the full dictionary's words or theirs
+	std::future<bool> loaded_dictionary = swapping_boggle.load_text_legal_words_in_background(k_words_filename);
+	std::vector<std::string> words;
+	do
+	{
+		for (size_t board_index = 0; board_index < boards.size(); board_index++)
+		{
+			auto& board = boards[board_index];
+
+			words.clear();
+			if (!swapping_boggle.solve_board(words, board.width, board.height, board.letters.c_str()) ||
+				(words != boards_expected_words[board_index] && words != boards_every_third_word_expected_words[board_index]))
+			{
+				output_error("	solve while loading legal words in the background found neither dictionary's words on board %s",
+					board.letters.c_str());
+				success = false;
+			}
+		}
+	} while (loaded_dictionary.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+	remove(k_words_filename);
+
+	if (!loaded_dictionary.get())
+	{
+		output_error("	failed to load legal words in the background");
+		return false;
+	}
+
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+
+		words.clear();
+		success = swapping_boggle.solve_board(words, board.width, board.height, board.letters.c_str()) &&
+			check_found_words("solve after loading legal words in the background", board, boards_every_third_word_expected_words[board_index], words) &&
+			success;
+	}
+
+	return success;
+}
+
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+// UTF-8 legal words with letters beyond 'z' must load the same read serially or in parallel, and
+// be found on a board of their Latin-1 letters
+static bool check_extended_alphabet_solves()
+{
+	static const char* k_words_filename = R"(behaviour_check_extended_alphabet_words.txt)";
+	// año, niño, señor, übel, über, in UTF-8
+	static const char k_utf8_words[] =
+		"a\xC3\xB1o\n"
+		"ni\xC3\xB1o\n"
+		"se\xC3\xB1or\n"
+		"\xC3\xBC" "bel\n"
+		"\xC3\xBC" "ber\n";
+	// año along the top row, über along the second, in Latin-1
+	static const char* k_board_letters =
+		"a\xF1ox"
+		"\xFC" "ber"
+		"xxxx"
+		"xxxx";
+	static const std::array<const char*, 2> k_expected_words = { {
+		"a\xF1o",
+		"\xFC" "ber",
+	} };
+
+	FILE* file;
+	if (fopen_s(&file, k_words_filename, "wb") != 0)
+	{
+		output_error("\tfailed to write extended alphabet legal words");
+		return false;
+	}
+	fwrite(k_utf8_words, 1, sizeof(k_utf8_words) - 1, file);
+	fclose(file);
+
+	std::vector<std::string> all_words;
+	c_boggle serially_read_boggle;
+	c_boggle parallel_read_boggle;
+	bool loaded_legal_words = read_boggle_dictionary_file(k_words_filename, all_words, true, true) &&
+		parallel_read_boggle.load_text_legal_words(k_words_filename);
+	remove(k_words_filename);
+	if (!loaded_legal_words)
+	{
+		output_error("\tfailed to read extended alphabet legal words");
+		return false;
+	}
+	serially_read_boggle.set_legal_words_from_alphabetically_sorted_array(all_words);
+
+	bool success = true;
+	if (!serially_read_boggle.get_resident_dictionary() ||
+		!serially_read_boggle.get_resident_dictionary()->has_same_content(*parallel_read_boggle.get_resident_dictionary()))
+	{
+		output_error("\textended alphabet legal words read serially and in parallel differ");
+		success = false;
+	}
+
+	s_boggle_batch_board board;
+	board.width = board.height = 4;
+	board.letters = k_board_letters;
+	std::vector<std::string> expected_words(k_expected_words.begin(), k_expected_words.end());
+	std::vector<std::string> words;
+	success = serially_read_boggle.solve_board(words, board.width, board.height, board.letters.c_str()) &&
+		check_found_words("extended alphabet solve", board, expected_words, words) &&
+		success;
+
+	return success;
+}
+#endif
+
+// the parallel text loader must read the same words as the serial one from the same file, here
+// out of order, with CRLF line endings and upper cased duplicates to sort, lower case and remove
+static bool check_text_dictionary_loaders(
+	const c_boggle& boggle)
+{
+	static const char* k_words_filename = R"(behaviour_check_words.txt)";
+
+	std::vector<std::string> expected_words;
+	auto dictionary = boggle.get_dictionary();
+	for (auto word = dictionary->begin_words(), end = dictionary->end_words(); word != end; ++word)
+	{
+		expected_words.emplace_back(dictionary->get_string(*word), word->get_length());
+	}
+
+	FILE* file;
+	if (fopen_s(&file, k_words_filename, "wb") != 0)
+	{
+		output_error("\tfailed to write legal words to read back");
+		return false;
+	}
+
+	std::string utf8_word;
+	for (size_t word_index = expected_words.size(); word_index-- > 0; )
+	{
+		utf8_word.clear();
+		boggle_grid_char_string_to_utf8(expected_words[word_index].c_str(), utf8_word);
+		fprintf(file, "%s\r\n", utf8_word.c_str());
+
+		if (word_index % 7 == 0)
+		{
+			std::transform(utf8_word.begin(), utf8_word.end(), utf8_word.begin(),
+				[](const char character)
+				{
+					return (character >= 'a' && character <= 'z')
+						? static_cast<char>(character - ('a' - 'A'))
+						: character;
+				});
+			fprintf(file, "%s\r\n", utf8_word.c_str());
+		}
+	}
+	fclose(file);
+
+	std::vector<std::string> serially_read_words;
+	bool read_serially = read_boggle_dictionary_file(k_words_filename, serially_read_words, true, true);
+	auto parallel_read_dictionary = c_boggle_resident_dictionary::create_from_text_file(k_words_filename);
+	remove(k_words_filename);
+
+	bool success = true;
+	if (!read_serially || serially_read_words != expected_words)
+	{
+		output_error("\tread legal words serially as %d words, expected %d",
+			static_cast<int>(serially_read_words.size()),
+			static_cast<int>(expected_words.size()));
+		success = false;
+	}
+
+	std::vector<std::string> parallel_read_words;
+	if (parallel_read_dictionary)
+	{
+		auto parallel_read_words_dictionary = parallel_read_dictionary->get_dictionary();
+		for (auto word = parallel_read_words_dictionary->begin_words(), end = parallel_read_words_dictionary->end_words(); word != end; ++word)
+		{
+			parallel_read_words.emplace_back(parallel_read_words_dictionary->get_string(*word), word->get_length());
+		}
+	}
+	if (parallel_read_words != serially_read_words)
+	{
+		output_error("\tread legal words in parallel as %d words, but serially as %d",
+			static_cast<int>(parallel_read_words.size()),
+			static_cast<int>(serially_read_words.size()));
+		success = false;
+	}
+
+	return success;
+}
+
+// boards must read back from batch files of either format as they were written, and a batch solve
+// of them find the same words as solving them one at a time
+static bool check_board_batch_round_trip(
+	c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_boards_filename = R"(behaviour_check.boggle_boards)";
+
+	bool success = true;
+	for (int format = 0; format < k_number_of_boggle_board_batch_file_formats; format++)
+	{
+		bool format_success = write_board_batch_file(k_boards_filename, static_cast<e_boggle_board_batch_file_format>(format), boards);
+
+		c_boggle_board_batch_reader reader;
+		format_success = format_success && reader.open(k_boards_filename);
+
+		s_boggle_batch_board board;
+		size_t boards_read = 0;
+		while (format_success && reader.read_board(board))
+		{
+			format_success = boards_read < boards.size() &&
+				board.width == boards[boards_read].width &&
+				board.height == boards[boards_read].height &&
+				board.letters == boards[boards_read].letters;
+			boards_read++;
+		}
+
+		if (!format_success || reader.has_failed() || boards_read != boards.size() ||
+			reader.get_format() != static_cast<e_boggle_board_batch_file_format>(format))
+		{
+			output_error("\tboards didn't read back from a %s batch file",
+				format == _boggle_board_batch_file_format_binary ? "binary" : "text");
+			success = false;
+			continue;
+		}
+		reader.close();
+
+		std::vector<std::vector<std::string>> boards_words;
+		if (!solve_board_batch_file_words(boggle, k_boards_filename, boards_words))
+		{
+			output_error("\tfailed to solve the boards of a %s batch file",
+				format == _boggle_board_batch_file_format_binary ? "binary" : "text");
+			success = false;
+			continue;
+		}
+
+		success = check_boards_found_words("batch solve", boards, boards_expected_words, boards_words) &&
+			success;
+	}
+	remove(k_boards_filename);
+
+	return success;
+}
+
+
+static bool read_varint(
+	c_double_buffered_file_reader& reader,
+	uint64_t& out_value)
+{
+	out_value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		uint8_t byte;
+		if (!reader.read(byte))
+			return false;
+
+		out_value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+// each format of result file must read back as the expected words of every board
+static bool check_result_files(
+	const c_boggle& boggle,
+	const std::array<const char*, k_number_of_boggle_result_file_formats>& results_filenames,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	auto dictionary = boggle.get_dictionary();
+
+	bool success = true;
+	for (int format = 0; format < k_number_of_boggle_result_file_formats; format++)
+	{
+		c_double_buffered_file_reader reader;
+		if (!reader.open(results_filenames[format]))
+		{
+			output_error("\tfailed to open result file %s",
+				results_filenames[format]);
+			success = false;
+			continue;
+		}
+
+		bool format_success = true;
+		if (format == _boggle_result_file_format_binary)
+		{
+			s_boggle_result_file_header header;
+			format_success = reader.read(header) &&
+				header.signature == k_boggle_result_file_signature &&
+				header.version == k_boggle_result_file_version;
+		}
+
+		std::string line;
+		std::string expected_line;
+		std::vector<std::string> words;
+		for (size_t board_index = 0; format_success && board_index < boards.size(); board_index++)
+		{
+			auto& board = boards[board_index];
+			auto& board_expected_words = boards_expected_words[board_index];
+
+			if (format == _boggle_result_file_format_binary)
+			{
+				uint64_t words_count;
+				format_success = read_varint(reader, words_count);
+
+				words.clear();
+				uint64_t word_index = 0;
+				for (uint64_t word_number = 0; format_success && word_number < words_count; word_number++)
+				{
+					uint64_t word_index_delta;
+					format_success = read_varint(reader, word_index_delta) &&
+						(word_index += word_index_delta) < dictionary->get_words_count();
+					if (format_success)
+					{
+						auto word = dictionary->get_word(static_cast<int>(word_index));
+						words.emplace_back(dictionary->get_string(*word), word->get_length());
+					}
+				}
+
+				format_success = format_success &&
+					check_found_words("binary result file", board, board_expected_words, words);
+				continue;
+			}
+
+			expected_line.clear();
+			if (format == _boggle_result_file_format_json_lines)
+			{
+				char board_prefix[96];
+				sprintf_s(board_prefix, sizeof board_prefix, "{\"board\":%d,\"width\":%d,\"height\":%d,\"words\":[",
+					static_cast<int>(board_index),
+					board.width, board.height);
+				expected_line = board_prefix;
+			}
+			for (auto& expected_word : board_expected_words)
+			{
+				if (&expected_word != &board_expected_words.front())
+					expected_line += format == _boggle_result_file_format_json_lines ? "," : " ";
+				expected_line += format == _boggle_result_file_format_json_lines
+					? "\"" + expected_word + "\""
+					: expected_word;
+			}
+			if (format == _boggle_result_file_format_json_lines)
+				expected_line += "]}";
+
+			format_success = reader.read_line(line) && line == expected_line;
+		}
+
+		// and nothing after the last board
+		uint8_t extra_byte;
+		if (!format_success || reader.read(extra_byte))
+		{
+			output_error("\tresult file %s didn't read back as the boards' words",
+				results_filenames[format]);
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+// a batch solve's results must read back from result files of every format as the boards' words
+static bool check_result_file_round_trip(
+	c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_boards_filename = R"(behaviour_check_results.boggle_boards)";
+	static const std::array<const char*, k_number_of_boggle_result_file_formats> k_results_filenames = { {
+		R"(behaviour_check_results.txt)",
+		R"(behaviour_check_results.jsonl)",
+		R"(behaviour_check_results.boggle_results)",
+	} };
+
+	bool success = true;
+	std::array<c_boggle_result_writer, k_number_of_boggle_result_file_formats> result_writers;
+	for (int format = 0; format < k_number_of_boggle_result_file_formats; format++)
+	{
+		success = result_writers[format].open(k_results_filenames[format], static_cast<e_boggle_result_file_format>(format)) &&
+			success;
+	}
+
+	std::vector<std::vector<std::string>> boards_words;
+	if (!success ||
+		!write_board_batch_file(k_boards_filename, _boggle_board_batch_file_format_text, boards) ||
+		!solve_board_batch_file_words(boggle, k_boards_filename, boards_words,
+			[&result_writers](const s_boggle_batch_board& board, const s_boggle_found_words& found_words)
+			{
+				for (auto& result_writer : result_writers)
+					result_writer.write_board(board, found_words);
+			}))
+	{
+		output_error("\tfailed to solve a board batch into result files");
+		success = false;
+	}
+
+	for (auto& result_writer : result_writers)
+	{
+		success = result_writer.close() && success;
+	}
+	success = success &&
+		check_result_files(boggle, k_results_filenames, boards, boards_expected_words);
+
+	remove(k_boards_filename);
+	for (const char* results_filename : k_results_filenames)
+	{
+		remove(results_filename);
+	}
+
+	return success;
+}
+
+// solves every board with the one context, whose found words must be the expected ones
+static bool check_context_solves(
+	const char* check_name,
+	c_boggle& boggle,
+	c_boggle_solve_context& context,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	bool success = true;
+	std::vector<std::string> words;
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+
+		if (!boggle.solve_board(context, board.width, board.height, board.letters.c_str()))
+		{
+			output_error("\t%s failed to solve board %s",
+				check_name,
+				board.letters.c_str());
+			success = false;
+			continue;
+		}
+
+		get_found_word_strings(context.get_found_words(), words);
+		success = check_found_words(check_name, board, boards_expected_words[board_index], words) &&
+			success;
+	}
+
+	return success;
+}
+
+// solving with the merged words of the full dictionary and a subset of it must find each source
+// dictionary's own words, split from the one traversal
+static bool check_merged_dictionary_solves(
+	const c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	auto resident_dictionary = boggle.get_resident_dictionary();
+
+	std::vector<std::string> every_third_word;
+	get_every_third_dictionary_word(*resident_dictionary->get_dictionary(), every_third_word);
+	std::vector<std::vector<std::string>> boards_every_third_word_expected_words;
+	get_boards_words_in_sorted_words(boards_expected_words, every_third_word, boards_every_third_word_expected_words);
+
+	auto every_third_word_dictionary = c_boggle_resident_dictionary::create_from_alphabetically_sorted_array(every_third_word);
+	auto merged_dictionary = every_third_word_dictionary
+		? c_boggle_merged_dictionary::create({ resident_dictionary, every_third_word_dictionary })
+		: nullptr;
+	if (!merged_dictionary)
+	{
+		output_error("\tfailed to create the merged dictionary");
+		return false;
+	}
+
+	bool success = true;
+	c_boggle_solve_context context;
+	std::vector<s_boggle_found_words> source_found_words;
+	std::vector<std::string> words;
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+
+		if (!merged_dictionary->solve_board(context, board.width, board.height, board.letters.c_str(), source_found_words))
+		{
+			output_error("\tmerged dictionary failed to solve board %s",
+				board.letters.c_str());
+			success = false;
+			continue;
+		}
+
+		get_found_word_strings(source_found_words[0], words);
+		success = check_found_words("merged solve", board, boards_expected_words[board_index], words) && success;
+
+		get_found_word_strings(source_found_words[1], words);
+		success = check_found_words("merged subset solve", board, boards_every_third_word_expected_words[board_index], words) && success;
+	}
+
+	return success;
+}
+
+// solves with word length limits, on a context of their own and in c_boggle's own batch solves,
+// must find only the expected words within the limits
+static bool check_word_length_limited_solves(
+	c_boggle& boggle,
+	const std::vector<s_boggle_batch_board>& boards,
+	const std::vector<std::vector<std::string>>& boards_expected_words)
+{
+	static const char* k_boards_filename = R"(behaviour_check_length_limited.boggle_boards)";
+	static const uint32_t k_shortest_word_length = 4;
+	static const uint32_t k_longest_word_length = 7;
+
+	std::vector<std::vector<std::string>> boards_length_limited_expected_words;
+	for (auto& expected_words : boards_expected_words)
+	{
+		boards_length_limited_expected_words.emplace_back();
+		for (auto& expected_word : expected_words)
+		{
+			if (expected_word.length() >= k_shortest_word_length && expected_word.length() <= k_longest_word_length)
+				boards_length_limited_expected_words.back().push_back(expected_word);
+		}
+	}
+
+	c_boggle_solve_context length_limited_context;
+	length_limited_context.set_word_length_limits(k_shortest_word_length, k_longest_word_length);
+	bool success = check_context_solves("length limited solve", boggle, length_limited_context, boards, boards_length_limited_expected_words);
+
+	// c_boggle's own limits apply to its batch solves, and are put back afterwards
+	uint32_t shortest_word_length = boggle.get_shortest_word_length();
+	uint32_t longest_word_length = boggle.get_longest_word_length();
+
+	std::vector<std::vector<std::string>> boards_words;
+	if (!boggle.set_word_length_limits(k_shortest_word_length, k_longest_word_length) ||
+		!write_board_batch_file(k_boards_filename, _boggle_board_batch_file_format_binary, boards) ||
+		!solve_board_batch_file_words(boggle, k_boards_filename, boards_words))
+	{
+		output_error("\tfailed to solve a length limited board batch");
+		success = false;
+	}
+	else
+	{
+		success = check_boards_found_words("length limited batch solve", boards, boards_length_limited_expected_words, boards_words) &&
+			success;
+	}
+	remove(k_boards_filename);
+
+	boggle.set_word_length_limits(shortest_word_length, longest_word_length);
+
+	return success;
+}
+
+static bool check_boggle_board_behaviour(
+	c_boggle& boggle)
+{
+	output_message("checking the ways of solving boards agree...");
+
+	std::vector<s_boggle_batch_board> boards;
+	generate_behaviour_check_boards(boards);
+
+	// what every other way of solving the boards is checked against
+	std::vector<std::vector<std::string>> boards_expected_words(boards.size());
+	for (size_t board_index = 0; board_index < boards.size(); board_index++)
+	{
+		auto& board = boards[board_index];
+		if (!boggle.solve_board(boards_expected_words[board_index], board.width, board.height, board.letters.c_str()))
+		{
+			output_error("\tfailed to solve board %s",
+				board.letters.c_str());
+			return false;
+		}
+	}
+
+	bool success = true;
+	success = check_dictionary_trie_layout(boggle) && success;
+	success = check_filtered_dictionary_tries(boggle, boards, boards_expected_words) && success;
+	success = check_binary_dictionary_round_trip(boggle) && success;
+	success = check_trie_only_dictionary_solves(boggle, boards, boards_expected_words) && success;
+	success = check_dictionary_registry(boggle, boards, boards_expected_words) && success;
+	success = check_dictionary_hot_swap(boggle, boards, boards_expected_words) && success;
+	success = check_text_dictionary_loaders(boggle) && success;
+	success = check_board_batch_round_trip(boggle, boards, boards_expected_words) && success;
+	success = check_result_file_round_trip(boggle, boards, boards_expected_words) && success;
+
+	// a context reused from board to board must find the same words as solve_board's own
+	c_boggle_solve_context context;
+	success = check_context_solves("context solve", boggle, context, boards, boards_expected_words) && success;
+
+	// the expected words were found tracking visited cells with bit vectors, which every board
+	// is small enough for, so force the path tracker
+	c_boggle_solve_context path_tracking_context;
+	path_tracking_context.set_visited_cells_path_min_cell_count(0);
+	success = check_context_solves("path tracking solve", boggle, path_tracking_context, boards, boards_expected_words) && success;
+
+	// the boards up to 12x12 interleave the walks of each root's cells, so search them one at a time
+	c_boggle_solve_context recursive_context;
+	recursive_context.set_interleave_walks(false);
+	success = check_context_solves("recursive solve", boggle, recursive_context, boards, boards_expected_words) && success;
+
+	success = check_merged_dictionary_solves(boggle, boards, boards_expected_words) && success;
+	success = check_word_length_limited_solves(boggle, boards, boards_expected_words) && success;
+#if BOGGLE_GRID_CHAR_EXTENDED_ALPHABET
+	success = check_extended_alphabet_solves() && success;
+#endif
+
+	return success;
+}
+
+static bool boggle_board_unit_tests()
+{
+	c_boggle boggle;
+	if (!load_legal_words(boggle))
+	{
+		output_error("abandoning test, failed to load legal words");
+		return false;
+	}
+
+	std::vector<char> grid_chars;
+	int board_width, board_height;
+
+	const char* board_letters = nullptr;
+
 #if 0 // test with a known board
 	if (!read_boggle_board_file(
 		R"(data\10x10_Grid.txt)",
@@ -94,7 +1357,7 @@ static void boggle_board_unit_tests()
 		true))
 	{
 		output_error("abandoning test, failed to read grid txt file");
-		return;
+		return false;
 	}
 
 	board_width = board_height = 10;
@@ -103,7 +1366,8 @@ static void boggle_board_unit_tests()
 
 #if 1 // generate a very large random grid
 	std::string random_grid_chars;
-	generate_boggle_board(board_width=255, board_height=255, random_grid_chars);
+	std::default_random_engine generator;
+	generate_random_boggle_board(board_width=255, board_height=255, generator, random_grid_chars);
 
 	board_letters = random_grid_chars.data();
 #endif
@@ -124,17 +1388,18 @@ static void boggle_board_unit_tests()
 
 	auto end_time = std::chrono::high_resolution_clock::now();
 
-	printf_s("estimated memory usage:\n");
-	printf_s("\tdictionary: %" PRIuPTR " bytes\n",
-		boggle.get_dictionary()->estimate_total_memory_used());
-	printf_s("\tdictionary trie: %" PRIuPTR " bytes\n",
-		boggle.m_estimated_total_memory_used_for_dictionary_trie);
-	printf_s("\tcompact dictionary trie: %" PRIuPTR " bytes\n",
-		boggle.m_estimated_total_memory_used_for_dictionary_compact_trie);
-	printf_s("\tgrid: %" PRIuPTR " bytes\n",
-		boggle.m_estimated_total_memory_used_for_grid);
-	printf_s("\tgrid solver: %" PRIuPTR " bytes\n",
-		boggle.m_estimated_total_memory_used_for_solver);
+	printf_s("memory usage:\n");
+	for (int tag = 0; tag < k_number_of_memory_tags; tag++)
+	{
+		s_memory_tag_stats memory_stats;
+		c_boggle::get_memory_stats(static_cast<e_memory_tag>(tag), memory_stats);
+
+		printf_s("\t%s: %" PRIuPTR " bytes (peak %" PRIuPTR " bytes, %" PRIu64 " allocations)\n",
+			memory_tag_to_string(static_cast<e_memory_tag>(tag)),
+			memory_stats.current_bytes,
+			memory_stats.peak_bytes,
+			memory_stats.allocation_count);
+	}
 
 	long long stopwatch_millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
 	long long stopwatch_micros = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
@@ -142,10 +1407,18 @@ static void boggle_board_unit_tests()
 	printf_s("total time: %" PRId64 "ms (%" PRId64 "us)\n",
 		stopwatch_millis, stopwatch_micros);
 
-	std::sort(found_words.begin(), found_words.end());
-
+	// found words come out in dictionary order, so they're already sorted
 	write_boggle_dictionary_file(
 		R"(found_words.txt)",
 		found_words);
+
+	if (!check_boggle_board_behaviour(boggle))
+	{
+		output_error("behaviour checks failed");
+		return false;
+	}
+
+	output_message("behaviour checks passed");
+	return true;
 }
 
@@ -0,0 +1,150 @@
+#include <precompile.h>
+#include <memory_mapped_file.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+c_memory_mapped_file::c_memory_mapped_file()
+	: m_data(nullptr)
+	, m_size(0)
+{
+}
+
+c_memory_mapped_file::~c_memory_mapped_file()
+{
+	close();
+}
+
+bool c_memory_mapped_file::open(
+	const char* filename)
+{
+	close();
+
+	if (!filename || *filename == '\0')
+		return false;
+
+#ifdef _WIN32
+	HANDLE file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size) ||
+		file_size.QuadPart <= 0 ||
+		static_cast<uint64_t>(file_size.QuadPart) > std::numeric_limits<size_t>::max())
+	{
+		CloseHandle(file_handle);
+		return false;
+	}
+
+	HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	// the mapping keeps its own reference to the file
+	CloseHandle(file_handle);
+	if (!mapping_handle)
+		return false;
+
+	void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	// and the view keeps its own reference to the mapping
+	CloseHandle(mapping_handle);
+	if (!data)
+		return false;
+
+	m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+	int file_descriptor = ::open(filename, O_RDONLY);
+	if (file_descriptor == -1)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(file_descriptor, &file_stat) != 0 ||
+		file_stat.st_size <= 0)
+	{
+		::close(file_descriptor);
+		return false;
+	}
+
+	void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, file_descriptor, 0);
+	// the mapping keeps its own reference to the file
+	::close(file_descriptor);
+	if (data == MAP_FAILED)
+		return false;
+
+	m_size = static_cast<size_t>(file_stat.st_size);
+#endif
+
+	m_data = static_cast<const uint8_t*>(data);
+	return true;
+}
+
+void c_memory_mapped_file::close()
+{
+	if (!m_data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+#else
+	munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
+
+c_memory_reader::c_memory_reader(
+	const void* data,
+	const size_t size)
+	: m_data(static_cast<const uint8_t*>(data))
+	, m_size(size)
+	, m_offset(0)
+{
+	assert(data != nullptr || size == 0);
+}
+
+bool c_memory_reader::seek(
+	const size_t offset)
+{
+	if (offset > m_size)
+		return false;
+
+	m_offset = offset;
+	return true;
+}
+
+bool c_memory_reader::read(
+	void* destination,
+	const size_t size)
+{
+	if (size > m_size - m_offset)
+		return false;
+
+	memcpy(destination, m_data + m_offset, size);
+	m_offset += size;
+	return true;
+}
+
+const void* c_memory_reader::read_in_place(
+	const size_t element_size,
+	const size_t count,
+	const size_t alignment)
+{
+	size_t padding = get_alignment_padding(m_offset, alignment);
+	if (padding > m_size - m_offset)
+		return nullptr;
+
+	size_t array_offset = m_offset + padding;
+	if (element_size != 0 && count > (m_size - array_offset) / element_size)
+		return nullptr;
+
+	m_offset = array_offset + (element_size * count);
+	return m_data + array_offset;
+}
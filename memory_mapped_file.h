@@ -0,0 +1,101 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include <utilities.h>
+
+// Read-only view of an entire file mapped into memory. Pages are only loaded as they're touched,
+// and are shared with any other process which maps the same file.
+
+class c_memory_mapped_file
+{
+	const uint8_t* m_data;
+	size_t m_size;
+
+public:
+	c_memory_mapped_file();
+	~c_memory_mapped_file();
+
+	c_memory_mapped_file(const c_memory_mapped_file&) = delete;
+	c_memory_mapped_file& operator=(const c_memory_mapped_file&) = delete;
+
+	bool open(
+		const char* filename);
+
+	void close();
+
+	bool is_open() const
+	{
+		return m_data != nullptr;
+	}
+
+	const uint8_t* get_data() const
+	{
+		return m_data;
+	}
+
+	size_t get_size() const
+	{
+		return m_size;
+	}
+};
+
+// Sequential reads out of a block of memory, mirroring the fread calls used on binary files.
+// Arrays can be read in place, as long as the block starts at the same alignment as the file did.
+
+class c_memory_reader
+{
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset;
+
+public:
+	c_memory_reader(
+		const void* data,
+		const size_t size);
+
+	bool seek(
+		const size_t offset);
+
+	size_t tell() const
+	{
+		return m_offset;
+	}
+
+	const uint8_t* get_data() const
+	{
+		return m_data;
+	}
+
+	size_t get_size() const
+	{
+		return m_size;
+	}
+
+	bool read(
+		void* destination,
+		const size_t size);
+
+	template<
+		typename TValue>
+	bool read(
+		TValue& out_value)
+	{
+		return read(&out_value, sizeof(out_value));
+	}
+
+	// skips the padding written by fwrite_alignment_padding, then returns the array in place.
+	// Returns nullptr if the array runs past the end of the memory
+	const void* read_in_place(
+		const size_t element_size,
+		const size_t count,
+		const size_t alignment);
+
+	template<
+		typename TElement>
+	const TElement* read_array_in_place(
+		const size_t count)
+	{
+		return static_cast<const TElement*>(read_in_place(sizeof(TElement), count, k_binary_file_array_alignment));
+	}
+};
@@ -4,6 +4,7 @@
 #include <omp.h>
 #include <stdio.h>
 #include <tchar.h>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -0,0 +1,234 @@
+#include <precompile.h>
+#include <trace.h>
+
+#include <mutex>
+
+#include <utilities.h>
+
+struct s_trace_event
+{
+	const char* name;
+	const char* detail;
+	int64_t arg;
+	// in nanoseconds since the capture began
+	int64_t begin_time;
+	int64_t end_time;
+};
+
+struct s_trace_thread_buffer
+{
+	uint32_t thread_index;
+	// the capture the events were recorded for. A buffer from an earlier capture is reset by its
+	// thread the next time it records, so beginning a capture never touches other threads' buffers
+	uint32_t capture_number;
+	uint64_t events_recorded;
+	std::vector<s_trace_event> events;
+};
+
+std::atomic_bool g_trace_capturing(false);
+
+static std::atomic<uint32_t> g_trace_capture_number(0);
+static std::atomic<uint32_t> g_trace_events_per_thread(k_trace_default_events_per_thread);
+static std::atomic<int64_t> g_trace_capture_begin_time(0);
+
+// buffers live until exit, so a thread exiting mid capture doesn't lose its events
+static std::mutex g_trace_thread_buffers_mutex;
+static std::vector<std::unique_ptr<s_trace_thread_buffer>> g_trace_thread_buffers;
+
+static thread_local s_trace_thread_buffer* t_trace_thread_buffer = nullptr;
+
+static int64_t get_trace_clock_time()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static s_trace_thread_buffer* get_trace_thread_buffer()
+{
+	s_trace_thread_buffer* thread_buffer = t_trace_thread_buffer;
+	if (!thread_buffer)
+	{
+		std::lock_guard<std::mutex> lock(g_trace_thread_buffers_mutex);
+
+		thread_buffer = new s_trace_thread_buffer();
+		thread_buffer->thread_index = static_cast<uint32_t>(g_trace_thread_buffers.size());
+		thread_buffer->capture_number = 0;
+		thread_buffer->events_recorded = 0;
+		g_trace_thread_buffers.emplace_back(thread_buffer);
+
+		t_trace_thread_buffer = thread_buffer;
+	}
+
+	uint32_t capture_number = g_trace_capture_number.load(std::memory_order_acquire);
+	if (thread_buffer->capture_number != capture_number)
+	{
+		thread_buffer->events.assign(g_trace_events_per_thread.load(std::memory_order_relaxed), s_trace_event());
+		thread_buffer->events_recorded = 0;
+		thread_buffer->capture_number = capture_number;
+	}
+
+	return thread_buffer;
+}
+
+void trace_begin_capture(
+	const uint32_t events_per_thread)
+{
+	g_trace_events_per_thread.store(std::max(events_per_thread, 1U), std::memory_order_relaxed);
+	g_trace_capture_begin_time.store(get_trace_clock_time(), std::memory_order_relaxed);
+	g_trace_capture_number.fetch_add(1, std::memory_order_release);
+
+	g_trace_capturing.store(true, std::memory_order_relaxed);
+}
+
+void trace_end_capture()
+{
+	g_trace_capturing.store(false, std::memory_order_relaxed);
+}
+
+c_trace_scope::c_trace_scope(
+	const char* name,
+	const char* detail,
+	const int64_t arg)
+	: m_name(nullptr)
+	, m_detail(detail)
+	, m_arg(arg)
+	, m_begin_time(0)
+{
+	if (trace_is_capturing())
+	{
+		m_name = name;
+		m_begin_time = get_trace_clock_time();
+	}
+}
+
+c_trace_scope::~c_trace_scope()
+{
+	if (!m_name)
+		return;
+
+	int64_t end_time = get_trace_clock_time();
+	int64_t capture_begin_time = g_trace_capture_begin_time.load(std::memory_order_relaxed);
+
+	s_trace_thread_buffer* thread_buffer = get_trace_thread_buffer();
+	auto& trace_event = thread_buffer->events[thread_buffer->events_recorded % thread_buffer->events.size()];
+	trace_event.name = m_name;
+	trace_event.detail = m_detail;
+	trace_event.arg = m_arg;
+	trace_event.begin_time = m_begin_time - capture_begin_time;
+	trace_event.end_time = end_time - capture_begin_time;
+
+	thread_buffer->events_recorded++;
+}
+
+// strings are ASCII or Latin-1 (grid char strings), and Latin-1 bytes are their own code point
+static void write_trace_json_string(
+	FILE* file,
+	const char* string)
+{
+	fputc('"', file);
+	for (; *string != '\0'; string++)
+	{
+		auto character = static_cast<uint8_t>(*string);
+		if (character == '"' || character == '\\')
+		{
+			fputc('\\', file);
+			fputc(character, file);
+		}
+		else if (character < 0x20 || character >= 0x80)
+		{
+			fprintf(file, "\\u%04x", character);
+		}
+		else
+		{
+			fputc(character, file);
+		}
+	}
+	fputc('"', file);
+}
+
+bool trace_write_chrome_json(
+	const char* filename)
+{
+	FILE* file;
+	if (fopen_s(&file, filename, "w") != 0)
+	{
+		output_error("failed to open/create trace file: %s",
+			filename);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(g_trace_thread_buffers_mutex);
+
+	uint32_t capture_number = g_trace_capture_number.load(std::memory_order_acquire);
+	uint64_t dropped_events_count = 0;
+	bool first_event = true;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+	for (auto& thread_buffer : g_trace_thread_buffers)
+	{
+		if (thread_buffer->capture_number != capture_number || thread_buffer->events_recorded == 0)
+			continue;
+
+		uint64_t events_size = thread_buffer->events.size();
+		uint64_t first_event_number = thread_buffer->events_recorded > events_size
+			? thread_buffer->events_recorded - events_size
+			: 0;
+		dropped_events_count += first_event_number;
+
+		fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread #%u\"}}",
+			first_event ? "" : ",",
+			thread_buffer->thread_index,
+			thread_buffer->thread_index);
+		first_event = false;
+
+		for (uint64_t event_number = first_event_number; event_number < thread_buffer->events_recorded; event_number++)
+		{
+			auto& trace_event = thread_buffer->events[event_number % events_size];
+
+			fprintf(file, ",\n{\"name\":");
+			write_trace_json_string(file, trace_event.name);
+			fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+				trace_event.begin_time / 1000.0,
+				(trace_event.end_time - trace_event.begin_time) / 1000.0,
+				thread_buffer->thread_index);
+
+			if (trace_event.detail || trace_event.arg != k_trace_no_arg)
+			{
+				fprintf(file, ",\"args\":{");
+				if (trace_event.detail)
+				{
+					fprintf(file, "\"detail\":");
+					write_trace_json_string(file, trace_event.detail);
+				}
+				if (trace_event.arg != k_trace_no_arg)
+				{
+					fprintf(file, "%s\"arg\":%" PRId64,
+						trace_event.detail ? "," : "",
+						trace_event.arg);
+				}
+				fprintf(file, "}");
+			}
+
+			fprintf(file, "}");
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+
+	bool success = ferror(file) == 0;
+	success = fclose(file) == 0 && success;
+
+	if (!success)
+	{
+		output_error("failed to write trace file: %s",
+			filename);
+	}
+	else if (dropped_events_count > 0)
+	{
+		output_message("trace buffers overflowed, the oldest %" PRIu64 " spans were dropped",
+			dropped_events_count);
+	}
+
+	return success;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <inttypes.h>
+#include <atomic>
+
+// Lightweight tracing of timed spans, e.g. the phases of a solve and the tasks run on each thread.
+// Each thread records into its own fixed-size ring buffer, so recording never locks or allocates,
+// and once a buffer is full its oldest spans are overwritten. While not capturing, a span costs
+// one relaxed atomic load.
+// Captures are written as Chrome trace event JSON, which chrome://tracing and Perfetto open.
+
+enum
+{
+	k_trace_default_events_per_thread = 64 * 1024,
+
+	// for spans without a numeric argument
+	k_trace_no_arg = -1,
+};
+
+extern std::atomic_bool g_trace_capturing;
+
+// discards any previous capture. Threads allocate their buffer the first time they record a span
+void trace_begin_capture(
+	const uint32_t events_per_thread = k_trace_default_events_per_thread);
+
+void trace_end_capture();
+
+inline bool trace_is_capturing()
+{
+	return g_trace_capturing.load(std::memory_order_relaxed);
+}
+
+// only call once the traced threads are done recording, e.g. after trace_end_capture
+bool trace_write_chrome_json(
+	const char* filename);
+
+// records the time from construction to destruction as a span on the calling thread. The
+// strings aren't copied, so must outlive the capture (string literals, grid char strings, etc)
+class c_trace_scope
+{
+	const char* m_name;
+	const char* m_detail;
+	int64_t m_arg;
+	int64_t m_begin_time;
+
+public:
+	c_trace_scope(
+		const char* name,
+		const char* detail = nullptr,
+		const int64_t arg = k_trace_no_arg);
+	~c_trace_scope();
+
+	c_trace_scope(const c_trace_scope&) = delete;
+	c_trace_scope& operator=(const c_trace_scope&) = delete;
+};
+
+#define TRACE_SCOPE_NAME_INNER(line) trace_scope_##line
+#define TRACE_SCOPE_NAME(line) TRACE_SCOPE_NAME_INNER(line)
+
+// TRACE_SCOPE("name"), TRACE_SCOPE("name", "detail") or TRACE_SCOPE("name", nullptr, number)
+#define TRACE_SCOPE(...) c_trace_scope TRACE_SCOPE_NAME(__LINE__)(__VA_ARGS__)
@@ -0,0 +1,161 @@
+#include <precompile.h>
+#include <tracked_memory.h>
+
+#include <atomic>
+
+#include <utilities.h>
+
+// ahead of every allocation
+struct s_tracked_allocation_header
+{
+	size_t size;
+	e_memory_tag tag;
+};
+
+// room for the header, rounded up so the memory after it keeps malloc's alignment
+static const size_t k_tracked_allocation_header_size = 16;
+static_assert(sizeof(s_tracked_allocation_header) <= k_tracked_allocation_header_size,
+	"s_tracked_allocation_header doesn't fit ahead of allocations");
+
+struct s_memory_tag_counters
+{
+	std::atomic<size_t> current_bytes;
+	std::atomic<size_t> peak_bytes;
+	std::atomic<uint64_t> allocation_count;
+	std::atomic<uint64_t> live_allocation_count;
+};
+
+static s_memory_tag_counters g_memory_tag_counters[k_number_of_memory_tags];
+
+static void add_tracked_allocation(
+	const e_memory_tag tag,
+	const size_t size)
+{
+	auto& counters = g_memory_tag_counters[tag];
+
+	size_t current_bytes = counters.current_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+	while (current_bytes > peak_bytes &&
+		!counters.peak_bytes.compare_exchange_weak(peak_bytes, current_bytes, std::memory_order_relaxed))
+	{
+	}
+
+	counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+	counters.live_allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void remove_tracked_allocation(
+	const e_memory_tag tag,
+	const size_t size)
+{
+	auto& counters = g_memory_tag_counters[tag];
+
+	counters.current_bytes.fetch_sub(size, std::memory_order_relaxed);
+	counters.live_allocation_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+static s_tracked_allocation_header* get_tracked_allocation_header(
+	const e_memory_tag tag,
+	void* memory)
+{
+	auto header = reinterpret_cast<s_tracked_allocation_header*>(
+		reinterpret_cast<uint8_t*>(memory) - k_tracked_allocation_header_size);
+	assert(header->tag == tag);
+	(void)tag;
+
+	return header;
+}
+
+const char* memory_tag_to_string(
+	const e_memory_tag tag)
+{
+	switch (tag)
+	{
+	case _memory_tag_dictionary:				return "dictionary";
+	case _memory_tag_dictionary_trie_builder:	return "dictionary trie builder";
+	case _memory_tag_dictionary_compact_trie:	return "dictionary compact trie";
+	case _memory_tag_grid:						return "grid";
+	case _memory_tag_solver:					return "solver";
+	case _memory_tag_file_io:					return "file io";
+	default:
+		return "unknown";
+	}
+}
+
+void get_memory_tag_stats(
+	const e_memory_tag tag,
+	s_memory_tag_stats& out_stats)
+{
+	auto& counters = g_memory_tag_counters[tag];
+
+	out_stats.current_bytes = counters.current_bytes.load(std::memory_order_relaxed);
+	out_stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+	out_stats.allocation_count = counters.allocation_count.load(std::memory_order_relaxed);
+	out_stats.live_allocation_count = counters.live_allocation_count.load(std::memory_order_relaxed);
+}
+
+void reset_memory_tag_peaks()
+{
+	for (auto& counters : g_memory_tag_counters)
+	{
+		counters.peak_bytes.store(counters.current_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void* tracked_malloc(
+	const e_memory_tag tag,
+	const size_t size)
+{
+	assert(tag >= 0 && tag < k_number_of_memory_tags);
+
+	if (size > SIZE_MAX - k_tracked_allocation_header_size)
+		return nullptr;
+
+	auto header = reinterpret_cast<s_tracked_allocation_header*>(malloc(k_tracked_allocation_header_size + size));
+	if (!header)
+		return nullptr;
+
+	header->size = size;
+	header->tag = tag;
+	add_tracked_allocation(tag, size);
+
+	return reinterpret_cast<uint8_t*>(header) + k_tracked_allocation_header_size;
+}
+
+void* tracked_realloc(
+	const e_memory_tag tag,
+	void* memory,
+	const size_t size)
+{
+	if (!memory)
+		return tracked_malloc(tag, size);
+
+	if (size > SIZE_MAX - k_tracked_allocation_header_size)
+		return nullptr;
+
+	auto header = get_tracked_allocation_header(tag, memory);
+	size_t old_size = header->size;
+
+	auto new_header = reinterpret_cast<s_tracked_allocation_header*>(realloc(header, k_tracked_allocation_header_size + size));
+	if (!new_header)
+		return nullptr;
+
+	new_header->size = size;
+	remove_tracked_allocation(tag, old_size);
+	add_tracked_allocation(tag, size);
+
+	return reinterpret_cast<uint8_t*>(new_header) + k_tracked_allocation_header_size;
+}
+
+void tracked_free(
+	const e_memory_tag tag,
+	void* memory)
+{
+	if (!memory)
+		return;
+
+	auto header = get_tracked_allocation_header(tag, memory);
+	remove_tracked_allocation(tag, header->size);
+
+	free(header);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <inttypes.h>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Allocations made through these are counted against a tag, so the memory each subsystem uses
+// is measured rather than estimated, including transient peaks like the trie builder's.
+// Counters are process wide and updated atomically, so are safe to read while other threads
+// allocate.
+
+enum e_memory_tag
+{
+	// words and their string pool
+	_memory_tag_dictionary,
+	// state used while building a compact trie, freed once it's built
+	_memory_tag_dictionary_trie_builder,
+	_memory_tag_dictionary_compact_trie,
+	_memory_tag_grid,
+	_memory_tag_solver,
+	// file buffers, and text dictionaries while they're decoded and sorted
+	_memory_tag_file_io,
+
+	k_number_of_memory_tags
+};
+
+struct s_memory_tag_stats
+{
+	size_t current_bytes;
+	// the most current_bytes has been since start up, or since reset_memory_tag_peaks
+	size_t peak_bytes;
+	// allocations ever made
+	uint64_t allocation_count;
+	// allocations not yet freed
+	uint64_t live_allocation_count;
+};
+
+const char* memory_tag_to_string(
+	const e_memory_tag tag);
+
+void get_memory_tag_stats(
+	const e_memory_tag tag,
+	s_memory_tag_stats& out_stats);
+
+// lowers each tag's peak to its current bytes, e.g. to measure the peak of one operation
+void reset_memory_tag_peaks();
+
+// returns nullptr on failure. Like malloc, memory is aligned for any fundamental type
+void* tracked_malloc(
+	const e_memory_tag tag,
+	const size_t size);
+
+// returns nullptr on failure, leaving memory as it was
+void* tracked_realloc(
+	const e_memory_tag tag,
+	void* memory,
+	const size_t size);
+
+// memory must have come from tracked_malloc/tracked_realloc with the same tag, or be nullptr
+void tracked_free(
+	const e_memory_tag tag,
+	void* memory);
+
+// returns nullptr on failure. Elements are default-initialized, as with new[]
+template<
+	typename T>
+T* tracked_new_array(
+	const e_memory_tag tag,
+	const size_t count)
+{
+	static_assert(std::is_trivially_destructible<T>::value,
+		"tracked arrays are freed without running destructors");
+
+	if (count > SIZE_MAX / sizeof(T))
+		return nullptr;
+
+	T* array = reinterpret_cast<T*>(tracked_malloc(tag, sizeof(T) * count));
+	if (array)
+	{
+		for (size_t index = 0; index < count; index++)
+		{
+			new (&array[index]) T;
+		}
+	}
+
+	return array;
+}
+
+template<
+	typename T>
+void tracked_delete_array(
+	const e_memory_tag tag,
+	T* array)
+{
+	static_assert(std::is_trivially_destructible<T>::value,
+		"tracked arrays are freed without running destructors");
+
+	tracked_free(tag, array);
+}
+
+// for standard containers, e.g. tracked_vector_t
+template<
+	typename T,
+	e_memory_tag k_tag>
+class c_tracked_allocator
+{
+public:
+	typedef T value_type;
+
+	template<
+		typename TOther>
+	struct rebind
+	{
+		typedef c_tracked_allocator<TOther, k_tag> other;
+	};
+
+	c_tracked_allocator() = default;
+
+	template<
+		typename TOther>
+	c_tracked_allocator(
+		const c_tracked_allocator<TOther, k_tag>&)
+	{
+	}
+
+	T* allocate(
+		const size_t count)
+	{
+		if (count > SIZE_MAX / sizeof(T))
+			throw std::bad_alloc();
+
+		T* memory = reinterpret_cast<T*>(tracked_malloc(k_tag, sizeof(T) * count));
+		if (!memory)
+			throw std::bad_alloc();
+
+		return memory;
+	}
+
+	void deallocate(
+		T* memory,
+		const size_t)
+	{
+		tracked_free(k_tag, memory);
+	}
+
+	template<
+		typename TOther>
+	bool operator==(
+		const c_tracked_allocator<TOther, k_tag>&) const
+	{
+		return true;
+	}
+
+	template<
+		typename TOther>
+	bool operator!=(
+		const c_tracked_allocator<TOther, k_tag>&) const
+	{
+		return false;
+	}
+};
+
+template<
+	typename T,
+	e_memory_tag k_tag>
+using tracked_vector_t = std::vector<T, c_tracked_allocator<T, k_tag>>;
@@ -4,9 +4,19 @@
 #include <bit_vectors.h>
 #include <boggle_dictionary.h>
 #include <boggle_dictionary_compact_trie.h>
+#include <boggle_found_words.h>
 #include <boggle_grid.h>
+#include <boggle_resident_dictionary.h>
+#include <boggle_solve_context.h>
+#include <boggle_visited_cells.h>
+#include <trace.h>
 #include <utilities.h>
 
+// the constants are from different enums, so they're compared as plain ints
+static_assert(static_cast<int>(c_boggle_visited_cells_path::k_max_path_length) >=
+	static_cast<int>(c_boggle_dictionary::k_longest_acceptable_word_length),
+	"c_boggle_visited_cells_path is too short for the longest paths");
+
 c_trie_boggle_board_root_character_solver::c_trie_boggle_board_root_character_solver(
 	c_trie_boggle_board_solver& parent,
 	const boggle_grid_char_t root_grid_char)
@@ -14,352 +24,583 @@ c_trie_boggle_board_root_character_solver::c_trie_boggle_board_root_character_so
 	, m_grid(parent.get_grid())
 	, m_trie(parent.get_dictionary_trie())
 	, m_root_grid_char(root_grid_char)
+	, m_grid_chars_on_grid(m_grid.get_occuring_grid_chars_flags())
+	, m_shortest_word_length(parent.get_context().get_shortest_word_length())
+	// no path on the board can spell a longer word, so deeper paths are pruned on small boards
+	, m_longest_word_length(std::min(parent.get_context().get_longest_word_length(), m_grid.get_longest_possible_word_length()))
+	, m_prune_with_word_lengths(false)
 	, m_used_cells_flags_length(0)
 	, m_used_cells_flags(nullptr)
+	, m_name_found_words_from_path(m_trie.get_dictionary()->is_trie_only())
+	, m_trie_node_chars_path(parent.get_context().get_thread_scratch(omp_get_thread_num()).trie_node_chars_path)
+#if BOGGLE_SOLVER_STATS
+	, m_counters()
+	, m_depth(0)
+#endif
 {
+	auto& used_cells_flags = parent.get_context().get_thread_scratch(omp_get_thread_num()).used_cells_flags;
+	m_used_cells_flags_length = static_cast<uint32_t>(used_cells_flags.size());
+	m_used_cells_flags = used_cells_flags.data();
+
+	m_trie_node_chars_path.clear();
 }
 
-size_t c_trie_boggle_board_root_character_solver::estimate_total_memory_needed(
-	const c_boggle_grid& m_grid)
+void c_trie_boggle_board_root_character_solver::clear_cells_in_use()
 {
-	size_t estimated_total_memory_used = sizeof c_trie_boggle_board_root_character_solver;
-	// m_used_cells_flags
-	estimated_total_memory_used += sizeof(uint32_t) * bit_vector_traits_dword::get_size_in_words(m_grid.get_cell_count());
-	return estimated_total_memory_used;
+	memset(m_used_cells_flags, 0,
+		sizeof(m_used_cells_flags[0]) * m_used_cells_flags_length);
 }
 
-bool c_trie_boggle_board_root_character_solver::is_cell_in_use(
-	const uint32_t cell_index) const
+int32_t c_trie_boggle_board_root_character_solver::get_root_trie_node_index() const
 {
-	return BIT_VECTOR_TEST_FLAG32(m_used_cells_flags, cell_index);
+	auto& root_indices = m_trie.get_root_indices();
+
+	return root_indices[m_root_grid_char];
 }
 
-void c_trie_boggle_board_root_character_solver::mark_cell_in_use(
-	const uint32_t cell_index,
-	const bool in_use)
+bool c_trie_boggle_board_root_character_solver::can_trie_node_complete_word(
+	const int trie_node_index) const
 {
-	BIT_VECTOR_SET_FLAG32(m_used_cells_flags, cell_index, in_use);
+	return m_trie.get_subtree_grid_chars(trie_node_index).can_complete_word_with(m_grid_chars_on_grid) &&
+		(!m_prune_with_word_lengths ||
+			m_trie.get_subtree_word_lengths(trie_node_index).can_complete_word_within(m_shortest_word_length, m_longest_word_length));
 }
 
-void c_trie_boggle_board_root_character_solver::clear_cells_in_use()
+bool c_trie_boggle_board_root_character_solver::is_completed_word_length_acceptable(
+	const int trie_node_index) const
 {
-	memset(m_used_cells_flags, 0,
-		sizeof(m_used_cells_flags[0]) * m_used_cells_flags_length);
+	if (!m_prune_with_word_lengths)
+		return true;
+
+	// a node's own word is the shortest at or below it
+	uint32_t word_length = m_trie.get_subtree_word_lengths(trie_node_index).shortest_word_length;
+
+	return word_length >= m_shortest_word_length && word_length <= m_longest_word_length;
 }
 
-int32_t c_trie_boggle_board_root_character_solver::get_root_trie_node_index() const
+bool c_trie_boggle_board_root_character_solver::should_prune_trie_node_children(
+	const int trie_node_index) const
 {
-	auto& root_indices = m_trie.get_root_indices();
-
-	return root_indices[m_root_grid_char];
+	// once every word below a node is made up of grid chars on the board, and within the word
+	// length limits, there's nothing left to prune
+	return !m_trie.get_subtree_grid_chars(trie_node_index).can_complete_all_words_with(m_grid_chars_on_grid) ||
+		(m_prune_with_word_lengths &&
+			!m_trie.get_subtree_word_lengths(trie_node_index).are_all_words_within(m_shortest_word_length, m_longest_word_length));
 }
 
+template<
+	typename TVisitedCells>
 void c_trie_boggle_board_root_character_solver::solve_recursive(
+	TVisitedCells& visited_cells,
 	const int trie_node_index,
-	const boggle_grid_cell_index_t cell_index)
+	const boggle_grid_char_t trie_node_grid_char,
+	const boggle_grid_cell_index_t cell_index,
+	const bool prune_subtrees)
 {
+	BOGGLE_SOLVER_STAT(m_counters.nodes_entered++);
+	BOGGLE_SOLVER_STAT(m_counters.max_depth = std::max(m_counters.max_depth, ++m_depth));
+
+	if (m_name_found_words_from_path)
+		m_trie_node_chars_path.push_back(boggle_grid_char_to_string(trie_node_grid_char)[0]);
+
 	auto trie_node = m_trie.get_node(trie_node_index);
-	if (trie_node->completed_word_index >= 0 && !trie_node->is_word_found())
+	if (trie_node->completes_word() && is_completed_word_length_acceptable(trie_node_index))
 	{
-		trie_node->set_word_found(true);
-		m_parent.handle_solved_word(trie_node->completed_word_index, cell_index);
+		int completed_word_index = m_trie.get_completed_word_index(trie_node_index);
+		if (!m_parent.is_word_found(completed_word_index))
+		{
+			m_parent.handle_solved_word(completed_word_index);
+			BOGGLE_SOLVER_STAT(m_counters.words_found++);
+
+			if (m_name_found_words_from_path)
+				m_parent.handle_solved_word_path(m_root_grid_char, completed_word_index,
+					m_trie_node_chars_path.data(), static_cast<uint32_t>(m_trie_node_chars_path.size()));
+		}
 	}
 
-	auto trie_node_grid_char = trie_node->get_grid_char();
+	bool prune_child_subtrees = prune_subtrees &&
+		should_prune_trie_node_children(trie_node_index);
 
 	auto cell = m_grid.get_cell(cell_index);
-	// For each neighbor character surrounding our matching character...
+#if BOGGLE_SOLVER_PREFETCH_CHILD_NODES
+	// look up every child we could step into before stepping into any, prefetching each, so their
+	// cache misses overlap instead of each being waited on in turn. Nothing a child's search
+	// changes is left changed once it returns, so these are the children the loop below would find
+	struct s_child
+	{
+		int trie_node_index;
+		boggle_grid_cell_index_t cell_index;
+		boggle_grid_char_t grid_char;
+	};
+	// a child per neighbor, and another for each after a 'q'
+	std::array<s_child, k_number_of_boggle_grid_cell_neighbors * 2> children;
+	uint32_t children_count = 0;
+
 	for (auto neighbor = _boggle_grid_cell_neighbor_iterator_begin_value; neighbor < k_number_of_boggle_grid_cell_neighbors; ++neighbor)
 	{
+		BOGGLE_SOLVER_STAT(m_counters.neighbor_probes++);
+
 		auto neighbor_cell_index = cell->get_neighbor_cell_index(m_grid, neighbor);
-		// neighbor index is invalid, no neighbor there, try the next one...
-		// or the element is already in use by a trie prefix we're trying to solve
 		if (neighbor_cell_index == k_invalid_boggle_grid_cell_index ||
-			is_cell_in_use(neighbor_cell_index))
+			visited_cells.is_visited(neighbor_cell_index))
 		{
 			continue;
 		}
 
-		// look up the next cell and any corresponding trie node
 		auto neighbor_cell = m_grid.get_cell(neighbor_cell_index);
 		auto trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
-			trie_node, neighbor_cell->grid_char);
+			trie_node_index, neighbor_cell->grid_char);
+		BOGGLE_SOLVER_STAT(trie_node_index_with_neighbor_char != -1
+			? m_counters.trie_child_lookup_hits++
+			: m_counters.trie_child_lookup_misses++);
 		if (trie_node_index_with_neighbor_char != -1)
 		{
-			mark_cell_in_use(neighbor_cell_index, true);
-			solve_recursive(trie_node_index_with_neighbor_char, neighbor_cell_index);
-			mark_cell_in_use(neighbor_cell_index, false);
+			m_trie.prefetch_node(trie_node_index_with_neighbor_char, m_prune_with_word_lengths);
+			children[children_count++] = { trie_node_index_with_neighbor_char, neighbor_cell_index, neighbor_cell->grid_char };
 		}
 		// SPECIAL CASE: when we encounter a 'q', act like we already encountered a 'u' element
 		if (trie_node_grid_char == k_boggle_grid_char_special_case_q)
 		{
 			trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
-				trie_node, k_boggle_grid_char_special_case_u);
+				trie_node_index, k_boggle_grid_char_special_case_u);
+			BOGGLE_SOLVER_STAT(m_counters.qu_probes++);
+			BOGGLE_SOLVER_STAT(trie_node_index_with_neighbor_char != -1
+				? m_counters.trie_child_lookup_hits++
+				: m_counters.trie_child_lookup_misses++);
 			if (trie_node_index_with_neighbor_char != -1)
 			{
-				mark_cell_in_use(neighbor_cell_index, true);
-				solve_recursive(trie_node_index_with_neighbor_char, neighbor_cell_index);
-				mark_cell_in_use(neighbor_cell_index, false);
+				m_trie.prefetch_node(trie_node_index_with_neighbor_char, m_prune_with_word_lengths);
+				children[children_count++] = { trie_node_index_with_neighbor_char, neighbor_cell_index, k_boggle_grid_char_special_case_u };
 			}
 		}
 	}
-}
 
-struct s_solver_stack_data
-{
-	enum e_state : uint8_t
-	{
-		_state_unused,
-		_state_start_iterating_neighbors,
-		_state_iterating_neighbors,
-		_state_finished,
-	};
-	enum e_flags : uint8_t
+	for (uint32_t child_index = 0; child_index < children_count; child_index++)
 	{
-		_unmark_neighbor_cell_in_use_bit,
-		_requires_iterating_neighbors_as_qu_bit,
-		_iterated_current_neighbor_as_qu_bit,
-		_try_current_neighbor_as_qu_bit,
-	};
-
-	const s_boggle_grid_cell* cell;
-	s_boggle_dictionary_compact_trie_node* trie_node;
-	boggle_grid_char_t trie_node_grid_char;
-	e_boggle_grid_cell_neighbor neighbor;
-	boggle_grid_cell_index_t neighbor_cell_index;
-	e_state state;
-	uint8_t flags;
-
-	void reset()
-	{
-		cell = nullptr;
-		trie_node = nullptr;
-		trie_node_grid_char = k_invalid_boggle_grid_char;
-		neighbor = _boggle_grid_cell_neighbor_iterator_begin_value;
-		neighbor_cell_index = k_invalid_boggle_grid_cell_index;
-		state = _state_unused;
-		flags = 0;
+		auto& child = children[child_index];
+		if (!prune_child_subtrees || can_trie_node_complete_word(child.trie_node_index))
+		{
+			visited_cells.visit(child.cell_index);
+			solve_recursive(visited_cells, child.trie_node_index, child.grid_char, child.cell_index,
+				prune_child_subtrees);
+			visited_cells.leave(child.cell_index);
+		}
 	}
-
-	void setup(
-		const c_trie_boggle_board_root_character_solver& solver,
-		const int trie_node_index,
-		const boggle_grid_cell_index_t cell_index)
+#else
+	// For each neighbor character surrounding our matching character...
+	for (auto neighbor = _boggle_grid_cell_neighbor_iterator_begin_value; neighbor < k_number_of_boggle_grid_cell_neighbors; ++neighbor)
 	{
-		assert(trie_node_index != -1);
-		assert(cell_index != k_invalid_boggle_grid_cell_index);
-		assert(trie_node==nullptr);
+		BOGGLE_SOLVER_STAT(m_counters.neighbor_probes++);
 
-		trie_node = solver.m_trie.get_node(trie_node_index);
-		if (trie_node->completed_word_index >= 0 && !trie_node->is_word_found())
+		auto neighbor_cell_index = cell->get_neighbor_cell_index(m_grid, neighbor);
+		// neighbor index is invalid, no neighbor there, try the next one...
+		// or the element is already in use by a trie prefix we're trying to solve
+		if (neighbor_cell_index == k_invalid_boggle_grid_cell_index ||
+			visited_cells.is_visited(neighbor_cell_index))
 		{
-			trie_node->set_word_found(true);
-			solver.m_parent.handle_solved_word(trie_node->completed_word_index, cell_index);
+			continue;
 		}
 
-		trie_node_grid_char = trie_node->get_grid_char();
-
-		cell = solver.m_grid.get_cell(cell_index);
-
-		state = s_solver_stack_data::_state_start_iterating_neighbors;
+		// look up the next cell and any corresponding trie node
+		auto neighbor_cell = m_grid.get_cell(neighbor_cell_index);
+		auto trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
+			trie_node_index, neighbor_cell->grid_char);
+		BOGGLE_SOLVER_STAT(trie_node_index_with_neighbor_char != -1
+			? m_counters.trie_child_lookup_hits++
+			: m_counters.trie_child_lookup_misses++);
+		if (trie_node_index_with_neighbor_char != -1 &&
+			(!prune_child_subtrees || can_trie_node_complete_word(trie_node_index_with_neighbor_char)))
+		{
+			visited_cells.visit(neighbor_cell_index);
+			solve_recursive(visited_cells, trie_node_index_with_neighbor_char, neighbor_cell->grid_char, neighbor_cell_index,
+				prune_child_subtrees);
+			visited_cells.leave(neighbor_cell_index);
+		}
+		// SPECIAL CASE: when we encounter a 'q', act like we already encountered a 'u' element
 		if (trie_node_grid_char == k_boggle_grid_char_special_case_q)
 		{
-			SET_FLAG(flags, _requires_iterating_neighbors_as_qu_bit, true);
+			trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
+				trie_node_index, k_boggle_grid_char_special_case_u);
+			BOGGLE_SOLVER_STAT(m_counters.qu_probes++);
+			BOGGLE_SOLVER_STAT(trie_node_index_with_neighbor_char != -1
+				? m_counters.trie_child_lookup_hits++
+				: m_counters.trie_child_lookup_misses++);
+			if (trie_node_index_with_neighbor_char != -1 &&
+				(!prune_child_subtrees || can_trie_node_complete_word(trie_node_index_with_neighbor_char)))
+			{
+				visited_cells.visit(neighbor_cell_index);
+				solve_recursive(visited_cells, trie_node_index_with_neighbor_char, k_boggle_grid_char_special_case_u, neighbor_cell_index,
+					prune_child_subtrees);
+				visited_cells.leave(neighbor_cell_index);
+			}
 		}
 	}
+#endif
+
+	if (m_name_found_words_from_path)
+		m_trie_node_chars_path.pop_back();
+
+	BOGGLE_SOLVER_STAT(m_depth--);
+}
 
-	bool should_try_neighbor(
-		const c_trie_boggle_board_root_character_solver& solver)
+template<
+	typename TVisitedCells>
+void c_trie_boggle_board_root_character_solver::solve_root_cells(
+	TVisitedCells& visited_cells,
+	const int root_trie_node_index,
+	const bool prune_subtrees)
+{
+	boggle_grid_cell_index_t cell_index_with_root = k_invalid_boggle_grid_cell_index;
+	for ( uint32_t cell_cursor = 0
+		; (cell_index_with_root = m_grid.cell_index_of(m_root_grid_char, cell_cursor)) != k_invalid_boggle_grid_cell_index
+		; cell_cursor = static_cast<uint32_t>(cell_index_with_root) + 1)
 	{
-		neighbor_cell_index = cell->get_neighbor_cell_index(solver.m_grid, neighbor);
-		// neighbor index is invalid, no neighbor there, try the next one...
-		// or the element is already in use by a trie prefix we're trying to solve
-		if (neighbor_cell_index == k_invalid_boggle_grid_cell_index ||
-			solver.is_cell_in_use(neighbor_cell_index))
-		{
-			return false;
-		}
+		visited_cells.visit(cell_index_with_root);
 
-		return true;
+		solve_recursive(visited_cells, root_trie_node_index, m_root_grid_char, cell_index_with_root,
+			prune_subtrees);
+
+		visited_cells.leave(cell_index_with_root);
 	}
+}
 
-	bool requires_iterating_neighbors_as_qu() const
+// one depth first search from a root cell, kept on an explicit stack so a root char's solver can
+// step several in turn
+struct s_solver_walk
+{
+	struct s_frame
 	{
-		return test_bit(flags, _requires_iterating_neighbors_as_qu_bit);
-	}
+		int trie_node_index;
+		boggle_grid_cell_index_t cell_index;
+		boggle_grid_char_t trie_node_grid_char;
+		// the next neighbor to try
+		e_boggle_grid_cell_neighbor neighbor;
+		// after a 'q', the 'u' child is still to be tried with the last neighbor tried
+		bool try_neighbor_as_qu;
+		// false until the trie node has been handled, as it was only prefetched when stepped into
+		bool entered;
+		// on entering, whether to check the node can complete a word. Then whether to check its children
+		bool prune_subtrees;
+	};
 
-	bool has_iterated_current_neighbor_as_qu() const
+	// frames in use, 0 once the walk has finished
+	uint32_t depth;
+	std::array<s_frame, c_boggle_dictionary::k_longest_acceptable_word_length> frames;
+	// for trie-only dictionaries, the chars of the trie nodes on the path
+	std::array<char, c_boggle_dictionary::k_longest_acceptable_word_length> trie_node_chars_path;
+
+	s_frame& get_top_frame()
 	{
-		return test_bit(flags, _iterated_current_neighbor_as_qu_bit);
+		assert(depth > 0);
+		return frames[depth - 1];
 	}
 
-	bool try_current_neighbor_as_qu() const
+	template<
+		typename TVisitedCells>
+	void push(
+		TVisitedCells& visited_cells,
+		const int trie_node_index,
+		const boggle_grid_char_t trie_node_grid_char,
+		const boggle_grid_cell_index_t cell_index,
+		const bool prune_subtrees)
 	{
-		return test_bit(flags, _try_current_neighbor_as_qu_bit);
+		assert(depth < frames.size());
+		visited_cells.visit(cell_index);
+
+		auto& frame = frames[depth++];
+		frame.trie_node_index = trie_node_index;
+		frame.cell_index = cell_index;
+		frame.trie_node_grid_char = trie_node_grid_char;
+		frame.neighbor = _boggle_grid_cell_neighbor_iterator_begin_value;
+		frame.try_neighbor_as_qu = false;
+		frame.entered = false;
+		frame.prune_subtrees = prune_subtrees;
 	}
 
-	static s_solver_stack_data unused_object()
+	template<
+		typename TVisitedCells>
+	void pop(
+		TVisitedCells& visited_cells)
 	{
-		s_solver_stack_data data;
-		data.reset();
-
-		return data;
+		visited_cells.leave(get_top_frame().cell_index);
+		depth--;
 	}
 };
-//static_assert(sizeof(s_solver_stack_data) == 0x18, "unexpected size for 64-bit");
 
-void c_trie_boggle_board_root_character_solver::solve_nonrecursive(
-	const int start_trie_node_index,
-	const boggle_grid_cell_index_t start_cell_index)
+template<
+	typename TVisitedCells>
+void c_trie_boggle_board_root_character_solver::start_walk(
+	TVisitedCells& visited_cells,
+	s_solver_walk& walk,
+	const int root_trie_node_index,
+	const boggle_grid_cell_index_t cell_index,
+	const bool prune_subtrees)
 {
-	std::array<s_solver_stack_data, c_boggle_dictionary::k_longest_acceptable_word_length> stack_data;
-	int stack_index = 0;
-
-	stack_data.fill(s_solver_stack_data::unused_object());
-
-	int next_trie_node_index = start_trie_node_index;
-	boggle_grid_cell_index_t next_cell_index = start_cell_index;
+	assert(walk.depth == 0);
+	walk.push(visited_cells, root_trie_node_index, m_root_grid_char, cell_index, prune_subtrees);
+}
 
-	while (stack_index != -1)
+template<
+	typename TVisitedCells>
+bool c_trie_boggle_board_root_character_solver::step_walk(
+	TVisitedCells& visited_cells,
+	s_solver_walk& walk)
+{
+	auto* frame = &walk.get_top_frame();
+	if (!frame->entered)
 	{
-		if (stack_index < stack_data.max_size() - 1)
+		if (frame->prune_subtrees)
 		{
-			assert(stack_data[stack_index + 1].state == s_solver_stack_data::_state_unused);
-		}
+			if (!can_trie_node_complete_word(frame->trie_node_index))
+			{
+				walk.pop(visited_cells);
+				if (walk.depth == 0)
+					return false;
 
-		auto& cursor = stack_data[stack_index];
-		if (cursor.state == s_solver_stack_data::_state_unused)
-		{
-			cursor.setup(*this, next_trie_node_index, next_cell_index);
-			next_trie_node_index = -1;
-			next_cell_index = k_invalid_boggle_grid_cell_index;
+				frame = &walk.get_top_frame();
+			}
+			else
+			{
+				frame->prune_subtrees = should_prune_trie_node_children(frame->trie_node_index);
+			}
 		}
+	}
+	if (!frame->entered)
+	{
+		frame->entered = true;
+		BOGGLE_SOLVER_STAT(m_counters.nodes_entered++);
+		BOGGLE_SOLVER_STAT(m_counters.max_depth = std::max(m_counters.max_depth, walk.depth));
 
-		// next handle how the neighbor iteration should begin or continue
-		if (cursor.state == s_solver_stack_data::_state_start_iterating_neighbors)
-		{
-			cursor.state = s_solver_stack_data::_state_iterating_neighbors;
-		}
-		else if (cursor.state == s_solver_stack_data::_state_iterating_neighbors)
+		if (m_name_found_words_from_path)
+			walk.trie_node_chars_path[walk.depth - 1] = boggle_grid_char_to_string(frame->trie_node_grid_char)[0];
+
+		if (m_trie.get_node(frame->trie_node_index)->completes_word() &&
+			is_completed_word_length_acceptable(frame->trie_node_index))
 		{
-			if (test_bit(cursor.flags, cursor._unmark_neighbor_cell_in_use_bit))
+			int completed_word_index = m_trie.get_completed_word_index(frame->trie_node_index);
+			if (!m_parent.is_word_found(completed_word_index))
 			{
-				SET_FLAG(cursor.flags, cursor._unmark_neighbor_cell_in_use_bit, false);
-				mark_cell_in_use(cursor.neighbor_cell_index, false);
+				m_parent.handle_solved_word(completed_word_index);
+				BOGGLE_SOLVER_STAT(m_counters.words_found++);
+
+				if (m_name_found_words_from_path)
+					m_parent.handle_solved_word_path(m_root_grid_char, completed_word_index,
+						walk.trie_node_chars_path.data(), walk.depth);
 			}
+		}
+	}
 
-			if (cursor.requires_iterating_neighbors_as_qu() &&
-				cursor.neighbor_cell_index != k_invalid_boggle_grid_cell_index)
+	// walk on from the top frame's next neighbor, until we step into a trie node or run out of frames
+	while (true)
+	{
+		auto cell = m_grid.get_cell(frame->cell_index);
+		while (frame->neighbor < k_number_of_boggle_grid_cell_neighbors)
+		{
+			auto neighbor_cell_index = cell->get_neighbor_cell_index(m_grid, frame->neighbor);
+
+			// SPECIAL CASE: when we encounter a 'q', act like we already encountered a 'u' element
+			if (frame->try_neighbor_as_qu)
 			{
-				if (cursor.has_iterated_current_neighbor_as_qu())
-					++cursor.neighbor;
-				else
-					SET_FLAG(cursor.flags, cursor._try_current_neighbor_as_qu_bit, true);
+				frame->try_neighbor_as_qu = false;
+				++frame->neighbor;
+
+				int trie_node_index_with_u = m_trie.get_child_node_index(
+					frame->trie_node_index, k_boggle_grid_char_special_case_u);
+				BOGGLE_SOLVER_STAT(m_counters.qu_probes++);
+				BOGGLE_SOLVER_STAT(trie_node_index_with_u != -1
+					? m_counters.trie_child_lookup_hits++
+					: m_counters.trie_child_lookup_misses++);
+				if (trie_node_index_with_u != -1)
+				{
+					m_trie.prefetch_node(trie_node_index_with_u, m_prune_with_word_lengths);
+					walk.push(visited_cells, trie_node_index_with_u, k_boggle_grid_char_special_case_u, neighbor_cell_index,
+						frame->prune_subtrees);
+					return true;
+				}
+
+				continue;
 			}
-			else
+
+			BOGGLE_SOLVER_STAT(m_counters.neighbor_probes++);
+
+			// neighbor index is invalid, no neighbor there, try the next one...
+			// or the element is already in use by a trie prefix we're trying to solve
+			if (neighbor_cell_index == k_invalid_boggle_grid_cell_index ||
+				visited_cells.is_visited(neighbor_cell_index))
 			{
-				++cursor.neighbor;
+				++frame->neighbor;
+				continue;
 			}
 
-			if (cursor.neighbor == k_number_of_boggle_grid_cell_neighbors)
+			if (frame->trie_node_grid_char == k_boggle_grid_char_special_case_q)
+				frame->try_neighbor_as_qu = true;
+			else
+				++frame->neighbor;
+
+			auto neighbor_cell = m_grid.get_cell(neighbor_cell_index);
+			auto trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
+				frame->trie_node_index, neighbor_cell->grid_char);
+			BOGGLE_SOLVER_STAT(trie_node_index_with_neighbor_char != -1
+				? m_counters.trie_child_lookup_hits++
+				: m_counters.trie_child_lookup_misses++);
+			if (trie_node_index_with_neighbor_char != -1)
 			{
-				cursor.state = s_solver_stack_data::_state_finished;
-				cursor.reset();
-				stack_index--;
-				continue;
+				// whether it can complete a word is checked once it's entered, so that's prefetched too
+				m_trie.prefetch_node(trie_node_index_with_neighbor_char, m_prune_with_word_lengths);
+				walk.push(visited_cells, trie_node_index_with_neighbor_char, neighbor_cell->grid_char, neighbor_cell_index,
+					frame->prune_subtrees);
+				return true;
 			}
 		}
 
-		assert(cursor.state == s_solver_stack_data::_state_iterating_neighbors);
-		if (cursor.try_current_neighbor_as_qu() &&
-			!cursor.has_iterated_current_neighbor_as_qu())
-		{
-		}
-		else if (!cursor.should_try_neighbor(*this))
+		walk.pop(visited_cells);
+		if (walk.depth == 0)
+			return false;
+
+		frame = &walk.get_top_frame();
+	}
+}
+
+template<
+	typename TVisitedCells>
+void c_trie_boggle_board_root_character_solver::solve_root_cells_interleaved(
+	std::array<TVisitedCells, BOGGLE_SOLVER_INTERLEAVED_WALKS>& walks_visited_cells,
+	const int root_trie_node_index,
+	const bool prune_subtrees)
+{
+	std::array<s_solver_walk, BOGGLE_SOLVER_INTERLEAVED_WALKS> walks;
+	// the walks still walking are the first active_walks_count
+	std::array<uint32_t, BOGGLE_SOLVER_INTERLEAVED_WALKS> active_walk_indices;
+	uint32_t active_walks_count = 0;
+
+	boggle_grid_cell_index_t cell_index_with_root = m_grid.cell_index_of(m_root_grid_char);
+	for (uint32_t walk_index = 0; walk_index < walks.size(); walk_index++)
+	{
+		walks[walk_index].depth = 0;
+
+		if (cell_index_with_root != k_invalid_boggle_grid_cell_index)
 		{
-			continue;
+			start_walk(walks_visited_cells[walk_index], walks[walk_index], root_trie_node_index, cell_index_with_root,
+				prune_subtrees);
+			active_walk_indices[active_walks_count++] = walk_index;
+
+			cell_index_with_root = m_grid.cell_index_of(m_root_grid_char, static_cast<uint32_t>(cell_index_with_root) + 1);
 		}
+	}
 
-		// finally, try to process the current neighbor
-		if (cursor.state == s_solver_stack_data::_state_iterating_neighbors)
+	while (active_walks_count > 0)
+	{
+		for (uint32_t active_walk_index = 0; active_walk_index < active_walks_count; )
 		{
-			auto neighbor_cell = m_grid.get_cell(cursor.neighbor_cell_index);
-			assert(neighbor_cell);
-			int trie_node_index_with_neighbor_char;
-
-			if (!cursor.try_current_neighbor_as_qu())
+			uint32_t walk_index = active_walk_indices[active_walk_index];
+			if (step_walk(walks_visited_cells[walk_index], walks[walk_index]))
 			{
-				trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
-					cursor.trie_node, neighbor_cell->grid_char);
+				active_walk_index++;
 			}
-			else
+			// the walk's finished, leaving its visited cells as it found them, so it takes the next
+			// root cell if there's one left
+			else if (cell_index_with_root != k_invalid_boggle_grid_cell_index)
 			{
-				// SPECIAL CASE: when we encounter a 'q', act like we already encountered a 'u' element
-				trie_node_index_with_neighbor_char = m_trie.get_child_node_index(
-					cursor.trie_node, k_boggle_grid_char_special_case_u);
-
-				// set the flag now so we don't have to do any extra handling when there's
-				// no 'u' neighbors
-				SET_FLAG(cursor.flags, cursor._iterated_current_neighbor_as_qu_bit, true);
-				SET_FLAG(cursor.flags, cursor._try_current_neighbor_as_qu_bit, false);
-			}
+				start_walk(walks_visited_cells[walk_index], walks[walk_index], root_trie_node_index, cell_index_with_root,
+					prune_subtrees);
+				active_walk_index++;
 
-			if (trie_node_index_with_neighbor_char != -1)
+				cell_index_with_root = m_grid.cell_index_of(m_root_grid_char, static_cast<uint32_t>(cell_index_with_root) + 1);
+			}
+			else
 			{
-				mark_cell_in_use(cursor.neighbor_cell_index, true);
-				SET_FLAG(cursor.flags, cursor._unmark_neighbor_cell_in_use_bit, true);
-				next_trie_node_index = trie_node_index_with_neighbor_char;
-				next_cell_index = cursor.neighbor_cell_index;
-				stack_index++;
-				continue;
+				active_walk_indices[active_walk_index] = active_walk_indices[--active_walks_count];
 			}
 		}
 	}
 }
 
+uint32_t c_trie_boggle_board_root_character_solver::get_interleaved_walks_count(
+	const c_boggle_grid& grid)
+{
+	return grid.get_cell_count() <= k_interleaved_walks_max_cell_count
+		? BOGGLE_SOLVER_INTERLEAVED_WALKS
+		: 1;
+}
+
 void c_trie_boggle_board_root_character_solver::solve_words()
 {
-	m_used_cells_flags_length = static_cast<uint32_t>( bit_vector_traits_dword::get_size_in_words(m_grid.get_cell_count()) );
-	m_used_cells_flags = new uint32_t[m_used_cells_flags_length];
+	auto root_trie_node_index = get_root_trie_node_index();
+	// no word starting with the root char can be made from the grid chars on this board
+	if (!can_trie_node_complete_word(root_trie_node_index))
+		return;
 
-	clear_cells_in_use();
+	// or none is within the word length limits
+	auto& root_subtree_word_lengths = m_trie.get_subtree_word_lengths(root_trie_node_index);
+	if (!root_subtree_word_lengths.can_complete_word_within(m_shortest_word_length, m_longest_word_length))
+		return;
 
-	auto root_trie_node_index = get_root_trie_node_index();
+	m_prune_with_word_lengths = !root_subtree_word_lengths.are_all_words_within(
+		m_shortest_word_length, m_longest_word_length);
 
-	boggle_grid_cell_index_t cell_index_with_root = k_invalid_boggle_grid_cell_index;
-	for ( uint32_t cell_cursor = 0
-		; (cell_index_with_root = m_grid.cell_index_of(m_root_grid_char, cell_cursor)) != k_invalid_boggle_grid_cell_index
-		; cell_cursor = static_cast<uint32_t>(cell_index_with_root) + 1)
-	{
-		mark_cell_in_use(cell_index_with_root, true);
-
-		// profiling, in x64, has shown that the non-recursive solver on avg takes longer time to complete,
-		// quite possibly due to all the branching used in an effort to keep the state machine at least
-		// somewhat understandable. Since I haven't yet blown the default stack limits with the
-		// english dictionary, I favor the recursive implementation
-#if 1
-		solve_recursive(root_trie_node_index, cell_index_with_root);
-#else
-		solve_nonrecursive(root_trie_node_index, cell_index_with_root);
-#endif
+	bool prune_subtrees = should_prune_trie_node_children(root_trie_node_index);
 
-		mark_cell_in_use(cell_index_with_root, false);
+	auto first_cell_index_with_root = m_grid.cell_index_of(m_root_grid_char);
+	// with only the one root cell there's nothing to interleave its walk with
+	bool interleave_walks = m_parent.get_context().is_interleaving_walks() &&
+		get_interleaved_walks_count(m_grid) > 1 &&
+		first_cell_index_with_root != k_invalid_boggle_grid_cell_index &&
+		m_grid.cell_index_of(m_root_grid_char, static_cast<uint32_t>(first_cell_index_with_root) + 1) != k_invalid_boggle_grid_cell_index;
+
+	if (m_parent.get_context().is_tracking_visited_cells_with_path())
+	{
+		if (interleave_walks)
+		{
+			std::array<c_boggle_visited_cells_path, BOGGLE_SOLVER_INTERLEAVED_WALKS> walks_visited_cells;
+			solve_root_cells_interleaved(walks_visited_cells, root_trie_node_index, prune_subtrees);
+		}
+		else
+		{
+			c_boggle_visited_cells_path visited_cells;
+			solve_root_cells(visited_cells, root_trie_node_index, prune_subtrees);
+		}
 	}
+	else
+	{
+		uint32_t used_cells_flags_length_per_walk = static_cast<uint32_t>(
+			bit_vector_traits_dword::get_size_in_words(m_grid.get_cell_count()));
+		assert(m_used_cells_flags_length >= used_cells_flags_length_per_walk * get_interleaved_walks_count(m_grid));
+		clear_cells_in_use();
+
+		if (interleave_walks)
+		{
+			// each walk has its own bit vector in the scratch
+			std::array<c_boggle_visited_cells_bit_vector, BOGGLE_SOLVER_INTERLEAVED_WALKS> walks_visited_cells;
+			for (uint32_t walk_index = 0; walk_index < walks_visited_cells.size(); walk_index++)
+			{
+				walks_visited_cells[walk_index] = c_boggle_visited_cells_bit_vector(
+					m_used_cells_flags + used_cells_flags_length_per_walk * walk_index);
+			}
 
-	delete[] m_used_cells_flags;
+			solve_root_cells_interleaved(walks_visited_cells, root_trie_node_index, prune_subtrees);
+		}
+		else
+		{
+			c_boggle_visited_cells_bit_vector visited_cells(m_used_cells_flags);
+			solve_root_cells(visited_cells, root_trie_node_index, prune_subtrees);
+		}
+	}
 }
 
 c_trie_boggle_board_solver::c_trie_boggle_board_solver(
-	c_boggle_dictionary_compact_trie& trie,
-	const c_boggle_grid& grid,
-	std::vector<std::string>& found_words)
+	const c_boggle_dictionary_compact_trie& trie,
+	c_boggle_solve_context& context,
+	s_boggle_found_words& found_words,
+	std::vector<std::string>* found_word_strings)
 	: m_trie(trie)
-	, m_grid(grid)
-	, m_found_words(found_words)
-	, m_adding_to_found_words(false)
+	, m_context(context)
+	, m_grid(context.get_grid())
+	, m_found_words_bit_vector(found_words)
+	, m_found_words(found_word_strings)
 	, m_roots_info_count(0)
 	, m_found_words_flags(nullptr)
 	, m_total_time()
+	, m_stats()
 {
 	m_roots_info.fill({ k_invalid_boggle_grid_char });
 
@@ -375,37 +616,61 @@ c_trie_boggle_board_solver::c_trie_boggle_board_solver(
 	}
 }
 
-size_t c_trie_boggle_board_solver::estimate_total_memory_used() const
+int c_trie_boggle_board_solver::get_solve_thread_count()
 {
-	size_t estimated_total_memory_used = sizeof(*this);
-	estimated_total_memory_used += sizeof(uint32_t) * bit_vector_traits_dword::get_size_in_words(m_trie.get_dictionary()->get_words_count());
-
-	int processor_count = omp_get_num_procs();
-	size_t memory_for_one_solver = c_trie_boggle_board_root_character_solver::estimate_total_memory_needed(m_grid);
-	if (processor_count > 1)
-		estimated_total_memory_used += memory_for_one_solver * (processor_count - 1);
-	else
-		estimated_total_memory_used += memory_for_one_solver;
-
-	return estimated_total_memory_used;
+	// within a parallel region (see c_boggle::solve_board_batch) our region has only the one thread
+	return omp_in_parallel() && !omp_get_nested() ? 1 : omp_get_max_threads();
 }
 
 void c_trie_boggle_board_solver::solve_root_character(
 	const boggle_grid_char_t root_grid_char)
 {
+	TRACE_SCOPE("solve_root", boggle_grid_char_to_string(root_grid_char));
+
 	c_trie_boggle_board_root_character_solver root_solver(
 		*this, root_grid_char);
 
 	root_solver.solve_words();
+
+#if BOGGLE_SOLVER_STATS
+	// each root is solved exactly once, and each thread only touches its own stats
+	m_stats.threads[omp_get_thread_num()].counters.add(root_solver.get_counters());
+	m_stats.words_found_per_root[root_grid_char] = root_solver.get_counters().words_found;
+#endif
 }
 
 void c_trie_boggle_board_solver::solve_root_characters_threaded()
 {
+#if BOGGLE_SOLVER_STATS
+	auto region_start_time = std::chrono::high_resolution_clock::now();
+
+#pragma omp parallel
+	{
+		auto& thread_stats = m_stats.threads[omp_get_thread_num()];
+
+#pragma omp for
+		for (int root_info_index = 0; root_info_index < m_roots_info_count; root_info_index++)
+		{
+			auto root_start_time = std::chrono::high_resolution_clock::now();
+			solve_root_character(m_roots_info[root_info_index].root_grid_char);
+			thread_stats.busy_time += std::chrono::high_resolution_clock::now() - root_start_time;
+			thread_stats.roots_solved++;
+		}
+	}
+
+	// any time a thread wasn't solving a root it spent waiting on the others
+	auto region_time = std::chrono::high_resolution_clock::now() - region_start_time;
+	for (auto& thread_stats : m_stats.threads)
+	{
+		thread_stats.idle_time = region_time - thread_stats.busy_time;
+	}
+#else
 #pragma omp parallel for
 	for (int root_info_index = 0; root_info_index < m_roots_info_count; root_info_index++)
 	{
 		solve_root_character(m_roots_info[root_info_index].root_grid_char);
 	}
+#endif
 }
 
 void c_trie_boggle_board_solver::solve_root_characters_nonthreaded()
@@ -422,53 +687,137 @@ void c_trie_boggle_board_solver::solve_board()
 
 	uint32_t total_words_count = dict->get_words_count();
 	uint32_t found_words_flags_length = static_cast<uint32_t>( bit_vector_traits_dword::get_size_in_words(total_words_count) );
-	m_found_words_flags = new uint32_t[found_words_flags_length];
-	memset(m_found_words_flags, 0,
-		sizeof(m_found_words_flags[0]) * found_words_flags_length);
+	m_found_words_bit_vector.dictionary = dict;
+	m_found_words_bit_vector.flags.assign(found_words_flags_length, 0);
+	m_found_words_flags = m_found_words_bit_vector.flags.data();
+
+	int thread_count = get_solve_thread_count();
+	m_context.prepare_threads_scratch(thread_count, dict->get_longest_word_length(),
+		c_trie_boggle_board_root_character_solver::get_interleaved_walks_count(m_grid));
+
+#if BOGGLE_SOLVER_STATS
+	m_stats.clear();
+	m_stats.threads.resize(thread_count);
+#endif
 
 	auto start_time = std::chrono::high_resolution_clock::now();
-	solve_root_characters_threaded();
+	{
+		TRACE_SCOPE("solve_roots");
+
+		solve_root_characters_threaded();
+	}
 	auto end_time = std::chrono::high_resolution_clock::now();
 
 	m_total_time = end_time - start_time;
 
+#if BOGGLE_SOLVER_STATS
+	for (auto& thread_stats : m_stats.threads)
+	{
+		m_stats.totals.add(thread_stats.counters);
+	}
+#endif
+
+	TRACE_SCOPE("materialize_found_words");
+
 	uint32_t found_words_count = 0;
 	for (uint32_t x = 0; x < found_words_flags_length; x++)
 	{
 		found_words_count += count_number_of_1s_bits(m_found_words_flags[x]);
 	}
+	m_found_words_bit_vector.count = found_words_count;
+
+	m_found_words_bit_vector.words_from_paths_chars.clear();
+	m_found_words_bit_vector.words_from_paths_offsets.clear();
+	if (dict->is_trie_only())
+		add_found_words_from_paths();
 
-	m_found_words.reserve(found_words_count);
+	if (m_found_words)
+		add_found_words_from_bit_vector();
+
+	m_found_words_flags = nullptr;
+}
+
+void c_trie_boggle_board_solver::add_found_words_from_paths()
+{
+	auto& words_chars = m_found_words_bit_vector.words_from_paths_chars;
+	auto& words_offsets = m_found_words_bit_vector.words_from_paths_offsets;
 
-	for ( c_bit_vector_dword_bit_filtered_iterator iter(m_found_words_flags, total_words_count)
-		; iter.next()
-		; )
+	// the dictionary is sorted, so sorting each root's words by index and taking the roots in
+	// grid char order gives the same order as walking the found words bit vector
+	for (int root_info_index = 0; root_info_index < m_roots_info_count; root_info_index++)
 	{
-		uint32_t word_index = iter.get_bit_index();
-		auto word = dict->get_word(static_cast<int>(word_index));
-		assert(word != nullptr);
+		auto& root_found_words = m_context.get_root_found_words(m_roots_info[root_info_index].root_grid_char);
+
+		std::sort(root_found_words.words.begin(), root_found_words.words.end(),
+			[](const s_boggle_solve_root_found_words::s_found_word& lhs, const s_boggle_solve_root_found_words::s_found_word& rhs)
+			{
+				return lhs.word_index < rhs.word_index;
+			});
 
-		std::string word_string(dict->get_string(*word));
-		m_found_words.push_back(word_string);
+		for (auto& found_word : root_found_words.words)
+		{
+			words_offsets.push_back(static_cast<uint32_t>(words_chars.size()));
+			words_chars.insert(words_chars.end(),
+				root_found_words.chars.begin() + found_word.chars_offset,
+				root_found_words.chars.begin() + found_word.chars_offset + found_word.length);
+			words_chars.push_back('\0');
+		}
+
+		root_found_words.words.clear();
+		root_found_words.chars.clear();
 	}
 
-	assert(m_found_words.size() == found_words_count);
-	delete[] m_found_words_flags;
+	assert(words_offsets.size() == m_found_words_bit_vector.count);
+}
 
-	m_found_words.shrink_to_fit();
+void c_trie_boggle_board_solver::add_found_words_from_bit_vector()
+{
+	m_found_words->reserve(m_found_words->size() + m_found_words_bit_vector.count);
+
+	for_each_boggle_found_word(m_found_words_bit_vector,
+		[this](const uint32_t, const char* word_string, const uint32_t word_length)
+		{
+			m_found_words->emplace_back(word_string, word_length);
+		});
+}
+
+bool c_trie_boggle_board_solver::is_word_found(
+	const int word_index) const
+{
+	uint32_t flags_index, flag_bit_offset;
+	bit_vector_traits_dword::bit_cursors_from_bit_index(static_cast<uint32_t>(word_index), flags_index, flag_bit_offset);
+
+	// other roots' threads may be setting the flags of the other words sharing these, see handle_solved_word
+	uint32_t flags;
+#pragma omp atomic read
+	flags = m_found_words_flags[flags_index];
+
+	return (flags & (1U << flag_bit_offset)) != 0;
 }
 
 void c_trie_boggle_board_solver::handle_solved_word(
+	const int word_index)
+{
+	uint32_t flags_index, flag_bit_offset;
+	bit_vector_traits_dword::bit_cursors_from_bit_index(static_cast<uint32_t>(word_index), flags_index, flag_bit_offset);
+	uint32_t flag = 1U << flag_bit_offset;
+
+	// a word is only found by its root's solver, but the words sharing its flags may be found by
+	// other roots on other threads
+#pragma omp atomic
+	m_found_words_flags[flags_index] |= flag;
+}
+
+void c_trie_boggle_board_solver::handle_solved_word_path(
+	const boggle_grid_char_t root_grid_char,
 	const int word_index,
-	const int grid_cell_index)
+	const char* word_chars,
+	const uint32_t word_length)
 {
-	while (m_adding_to_found_words.load())
-	{
-	}
+	auto& root_found_words = m_context.get_root_found_words(root_grid_char);
 
-	m_adding_to_found_words.store(true);
-	BIT_VECTOR_SET_FLAG32(m_found_words_flags, static_cast<uint32_t>(word_index), true);
-	m_adding_to_found_words.store(false);
+	root_found_words.words.push_back({ word_index, static_cast<uint32_t>(root_found_words.chars.size()), word_length });
+	root_found_words.chars.insert(root_found_words.chars.end(), word_chars, word_chars + word_length);
 }
 
 const c_boggle_dictionary* c_trie_boggle_board_solver::get_dictionary() const
@@ -476,3 +825,44 @@ const c_boggle_dictionary* c_trie_boggle_board_solver::get_dictionary() const
 	return m_trie.get_dictionary();
 }
 
+
+bool solve_boggle_board(
+	const c_boggle_resident_dictionary& resident_dictionary,
+	c_boggle_solve_context& context,
+	std::vector<std::string>* found_words,
+	const int board_width,
+	const int board_height,
+	const char* board_letters)
+{
+	if (!c_boggle_grid::is_valid_board_size(board_width, board_height))
+	{
+		output_error("called solve_boggle_board with invalid or too large board size: %d by %d",
+			board_width, board_height);
+		return false;
+	}
+	if (!board_letters || *board_letters == '\0')
+	{
+		output_error("called solve_boggle_board with a null or empty board_letters string");
+		return false;
+	}
+
+	auto dictionary_compact_trie = resident_dictionary.get_dictionary_trie();
+	if (!dictionary_compact_trie)
+	{
+		output_error("called solve_boggle_board with a dictionary that has no trie");
+		return false;
+	}
+
+	if (!context.set_board(board_width, board_height, board_letters))
+	{
+		output_error("solve_boggle_board couldn't use board_letters data");
+		return false;
+	}
+
+	c_trie_boggle_board_solver board_solver(
+		*dictionary_compact_trie, context, context.get_found_words(), found_words);
+
+	board_solver.solve_board();
+
+	return true;
+}
@@ -1,61 +1,154 @@
 #pragma once
 
 #include <inttypes.h>
-#include <atomic>
 #include <chrono>
 #include <string>
 #include <vector>
 
 #include <boggle_grid_cell.h>
 #include <boggle_grid_char.h>
+#include <boggle_solver_stats.h>
+#include <tracked_memory.h>
 
 class c_boggle_dictionary;
 class c_boggle_dictionary_compact_trie;
 class c_boggle_grid;
+class c_boggle_resident_dictionary;
+class c_boggle_solve_context;
 
+struct s_boggle_found_words;
+struct s_solver_walk;
 class c_trie_boggle_board_solver;
 
+// #NOTE the number of depth first searches, each from its own root cell, a root char's solver
+// steps in turn, prefetching the trie node each steps into so its cache miss is waited on while
+// the others work. 1 solves each root cell in turn, recursively
+#ifndef BOGGLE_SOLVER_INTERLEAVED_WALKS
+	#define BOGGLE_SOLVER_INTERLEAVED_WALKS 8
+#endif
+
+// #NOTE enable to have the recursive search look up all of a trie node's children it could step
+// into, prefetching each, before stepping into the first, rather than looking each up in turn.
+// Off by default as with a large dictionary on 32x32 and 100x100 boards it measured no faster,
+// a root's searches mostly stepping into trie nodes that are already cached. The benchmark
+// report records which was built, to compare the two on other machines
+#ifndef BOGGLE_SOLVER_PREFETCH_CHILD_NODES
+	#define BOGGLE_SOLVER_PREFETCH_CHILD_NODES 0
+#endif
+
 class c_trie_boggle_board_root_character_solver
 {
-	friend struct s_solver_stack_data;
+	enum
+	{
+		// #NOTE on bigger grids a root's searches keep revisiting the same trie nodes, which stay
+		// cached, so there's little to hide and the recursive search's lower overhead wins (by 10-20%
+		// from 16x16 up, when measured with a large dictionary, against 3-7% gains up to 10x10)
+		k_interleaved_walks_max_cell_count = 12 * 12,
+	};
 
 	c_trie_boggle_board_solver& m_parent;
 	const c_boggle_grid& m_grid;
-	c_boggle_dictionary_compact_trie& m_trie;
+	const c_boggle_dictionary_compact_trie& m_trie;
 
 	boggle_grid_char_t m_root_grid_char;
+	boggle_grid_char_flags_t m_grid_chars_on_grid;
+	// the solve's word length limits, see c_boggle_solve_context::set_word_length_limits, with the
+	// longest also limited to the longest word the board could spell
+	uint32_t m_shortest_word_length;
+	uint32_t m_longest_word_length;
+	// false when every word below the root is within the limits, so there's nothing to prune
+	bool m_prune_with_word_lengths;
+	// from the solve context's scratch for the thread we're solved on
 	uint32_t m_used_cells_flags_length;
 	uint32_t* m_used_cells_flags;
+	// when the dictionary is trie-only, found words are named using the chars of the trie nodes
+	// on the path from the root to the node that completes the word
+	bool m_name_found_words_from_path;
+	tracked_vector_t<char, _memory_tag_solver>& m_trie_node_chars_path;
+	// only in BOGGLE_SOLVER_STATS builds, see boggle_solver_stats.h
+#if BOGGLE_SOLVER_STATS
+	s_boggle_solver_counters m_counters;
+	uint32_t m_depth;
+#endif
 
 private:
-	bool is_cell_in_use(
-		const uint32_t cell_index) const;
-
-	void mark_cell_in_use(
-		const uint32_t cell_index,
-		const bool in_use);
-
 	void clear_cells_in_use();
 
 	int32_t get_root_trie_node_index() const;
 
+	// should the solver visit the trie node, given the grid chars on the board and the word length limits?
+	bool can_trie_node_complete_word(
+		const int trie_node_index) const;
+
+	// is the word the trie node completes within the word length limits?
+	bool is_completed_word_length_acceptable(
+		const int trie_node_index) const;
+
+	// should the solver bother testing the trie node's children with can_trie_node_complete_word?
+	bool should_prune_trie_node_children(
+		const int trie_node_index) const;
+
+	// TVisitedCells is one of the boggle_visited_cells.h trackers
+	template<
+		typename TVisitedCells>
 	void solve_recursive(
+		TVisitedCells& visited_cells,
 		const int trie_node_index,
-		const boggle_grid_cell_index_t cell_index);
-
-	void solve_nonrecursive(
-		const int start_trie_node_index,
-		const boggle_grid_cell_index_t start_cell_index);
+		const boggle_grid_char_t trie_node_grid_char,
+		const boggle_grid_cell_index_t cell_index,
+		const bool prune_subtrees);
+
+	template<
+		typename TVisitedCells>
+	void solve_root_cells(
+		TVisitedCells& visited_cells,
+		const int root_trie_node_index,
+		const bool prune_subtrees);
+
+	// steps into the walk's first trie node, from the given root cell
+	template<
+		typename TVisitedCells>
+	void start_walk(
+		TVisitedCells& visited_cells,
+		s_solver_walk& walk,
+		const int root_trie_node_index,
+		const boggle_grid_cell_index_t cell_index,
+		const bool prune_subtrees);
+
+	// handles the walk's newest trie node if it hasn't yet, then walks on until it steps into
+	// another, which was only just prefetched. Returns false once the walk has finished
+	template<
+		typename TVisitedCells>
+	bool step_walk(
+		TVisitedCells& visited_cells,
+		s_solver_walk& walk);
+
+	// the root char's cells are shared out between BOGGLE_SOLVER_INTERLEAVED_WALKS walks, each
+	// tracking its visited cells with its own TVisitedCells
+	template<
+		typename TVisitedCells>
+	void solve_root_cells_interleaved(
+		std::array<TVisitedCells, BOGGLE_SOLVER_INTERLEAVED_WALKS>& walks_visited_cells,
+		const int root_trie_node_index,
+		const bool prune_subtrees);
 
 public:
 	c_trie_boggle_board_root_character_solver(
 		c_trie_boggle_board_solver& parent,
 		const boggle_grid_char_t root_grid_char);
 
-	static size_t estimate_total_memory_needed(
-		const c_boggle_grid& m_grid);
+	// the walks solve_words interleaves on grids like this, 1 when it solves recursively
+	static uint32_t get_interleaved_walks_count(
+		const c_boggle_grid& grid);
 
 	void solve_words();
+
+#if BOGGLE_SOLVER_STATS
+	const s_boggle_solver_counters& get_counters() const
+	{
+		return m_counters;
+	}
+#endif
 };
 
 class c_trie_boggle_board_solver
@@ -65,14 +158,17 @@ class c_trie_boggle_board_solver
 		boggle_grid_char_t root_grid_char;
 	};
 
-	c_boggle_dictionary_compact_trie& m_trie;
+	const c_boggle_dictionary_compact_trie& m_trie;
+	c_boggle_solve_context& m_context;
 	const c_boggle_grid& m_grid;
-	std::vector<std::string>& m_found_words;
-	std::atomic_bool m_adding_to_found_words;
+	s_boggle_found_words& m_found_words_bit_vector;
+	// optional, the found words are also made into strings when set
+	std::vector<std::string>* m_found_words;
 	int32_t m_roots_info_count;
 	std::array<s_root_info, k_number_of_boggle_grid_characters> m_roots_info;
 	uint32_t* m_found_words_flags;
 	std::chrono::duration<int64_t, std::nano> m_total_time;
+	s_boggle_solver_stats m_stats;
 
 private:
 	void solve_root_character(
@@ -82,25 +178,48 @@ private:
 
 	void solve_root_characters_nonthreaded();
 
+	void add_found_words_from_paths();
+
+	void add_found_words_from_bit_vector();
+
 public:
+	// solves the context's board, leaving the found words as a bit vector in found_words, which
+	// is reused from board to board (e.g. the context's own found words). They're also appended
+	// to found_word_strings, if given
 	c_trie_boggle_board_solver(
-		c_boggle_dictionary_compact_trie& trie,
-		const c_boggle_grid& grid,
-		std::vector<std::string>& found_words);
+		const c_boggle_dictionary_compact_trie& trie,
+		c_boggle_solve_context& context,
+		s_boggle_found_words& found_words,
+		std::vector<std::string>* found_word_strings = nullptr);
 
-	size_t estimate_total_memory_used() const;
+	// threads solve_board spreads the roots across, one when already within a parallel region
+	static int get_solve_thread_count();
 
 	void solve_board();
 
+	bool is_word_found(
+		const int word_index) const;
+
 	void handle_solved_word(
+		const int word_index);
+
+	// names a word just found by the root's solver, for dictionaries without word strings
+	void handle_solved_word_path(
+		const boggle_grid_char_t root_grid_char,
 		const int word_index,
-		const int grid_cell_index);
+		const char* word_chars,
+		const uint32_t word_length);
 
-	c_boggle_dictionary_compact_trie& get_dictionary_trie()
+	const c_boggle_dictionary_compact_trie& get_dictionary_trie() const
 	{
 		return m_trie;
 	}
 
+	c_boggle_solve_context& get_context() const
+	{
+		return m_context;
+	}
+
 	const c_boggle_dictionary* get_dictionary() const;
 
 	const c_boggle_grid& get_grid() const
@@ -112,5 +231,24 @@ public:
 	{
 		return m_total_time;
 	}
+
+	// all zeros unless built with BOGGLE_SOLVER_STATS 1, which is off by default, so check it before
+	// reporting these (as the benchmark's solver_stats flag does)
+	const s_boggle_solver_stats& get_stats() const
+	{
+		return m_stats;
+	}
 };
 
+
+// finds all words on the specified board with the resident dictionary's full trie, leaving them in
+// context.get_found_words() (and appending them to found_words, if given). For solving without a
+// c_boggle, e.g. with a c_boggle_dictionary_registry's dictionaries, without allocating once the
+// context has grown to fit
+bool solve_boggle_board(
+	const c_boggle_resident_dictionary& resident_dictionary,
+	c_boggle_solve_context& context,
+	std::vector<std::string>* found_words,
+	const int board_width,
+	const int board_height,
+	const char* board_letters);
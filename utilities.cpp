@@ -13,6 +13,9 @@
 #pragma intrinsic(__popcnt)
 #pragma intrinsic(_BitScanForward)
 #pragma intrinsic(_BitScanReverse)
+#if defined(_M_X64)
+#pragma intrinsic(__popcnt64)
+#endif
 
 #endif
 
@@ -44,6 +47,17 @@ uint32_t count_number_of_1s_bits(
 #endif
 }
 
+uint32_t count_number_of_1s_bits(
+	const uint64_t bits)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	return static_cast<uint32_t>(__popcnt64(bits));
+#else
+	return count_number_of_1s_bits(static_cast<uint32_t>(bits)) +
+		count_number_of_1s_bits(static_cast<uint32_t>(bits >> 32));
+#endif
+}
+
 int32_t index_of_lowest_bit_set(
 	const uint32_t bits)
 {
@@ -59,6 +73,19 @@ int32_t index_of_lowest_bit_set(
 #endif
 }
 
+int32_t index_of_lowest_bit_set(
+	const uint64_t bits)
+{
+	uint32_t low_bits = static_cast<uint32_t>(bits);
+	if (low_bits != 0)
+		return index_of_lowest_bit_set(low_bits);
+
+	int32_t high_bit_index = index_of_lowest_bit_set(static_cast<uint32_t>(bits >> 32));
+	return high_bit_index != -1
+		? high_bit_index + 32
+		: -1;
+}
+
 int32_t index_of_highest_bit_set_unsafe(
 	const uint32_t bits)
 {
@@ -94,6 +121,16 @@ int32_t index_of_highest_bit_set(
 #endif
 }
 
+int32_t index_of_highest_bit_set(
+	const uint64_t bits)
+{
+	uint32_t high_bits = static_cast<uint32_t>(bits >> 32);
+	if (high_bits != 0)
+		return index_of_highest_bit_set_unsafe(high_bits) + 32;
+
+	return index_of_highest_bit_set(static_cast<uint32_t>(bits));
+}
+
 uint32_t leading_zeros_count(
 	const uint32_t bits)
 {
@@ -163,14 +200,14 @@ void __cdecl output_error(
 }
 
 bool handle_byte_order_marker(
-	_iobuf* file)
+	const uint8_t* data,
+	const size_t size,
+	size_t& out_text_offset)
 {
-	uint8_t header[4];
-	size_t numread = fread_s(header, sizeof header, sizeof header[0], _countof(header), file);
+	const uint8_t* header = data;
+	out_text_offset = 0;
 
-	long seek_position = 0;
-
-	switch (numread)
+	switch (std::min<size_t>(size, 4))
 	{
 	case 4:
 		if (header[0] == 0x00 &&
@@ -196,7 +233,7 @@ bool handle_byte_order_marker(
 			header[2] == 0xBF)
 		{
 			output_message("file looks like UTF8, will TRY to parse it, no promises");
-			seek_position = 3;
+			out_text_offset = 3;
 			break;
 		}
 
@@ -217,11 +254,52 @@ bool handle_byte_order_marker(
 		break;
 	}
 
-	fseek(file, seek_position, SEEK_SET);
+	return true;
+}
+
+bool handle_byte_order_marker(
+	_iobuf* file)
+{
+	uint8_t header[4];
+	size_t numread = fread_s(header, sizeof header, sizeof header[0], _countof(header), file);
+
+	size_t seek_position;
+	if (!handle_byte_order_marker(header, numread, seek_position))
+		return false;
+
+	fseek(file, static_cast<long>(seek_position), SEEK_SET);
 
 	return true;
 }
 
+bool fwrite_alignment_padding(
+	_iobuf* file,
+	const size_t alignment)
+{
+	// enough for any alignment used by our binary files
+	static const uint8_t k_padding[64] = {};
+	assert(alignment <= sizeof(k_padding));
+
+	int64_t position = _ftelli64(file);
+	if (position < 0)
+		return false;
+
+	size_t padding = get_alignment_padding(static_cast<size_t>(position), alignment);
+	return padding == fwrite(k_padding, sizeof k_padding[0], padding, file);
+}
+
+bool fseek_past_alignment_padding(
+	_iobuf* file,
+	const size_t alignment)
+{
+	int64_t position = _ftelli64(file);
+	if (position < 0)
+		return false;
+
+	size_t padding = get_alignment_padding(static_cast<size_t>(position), alignment);
+	return 0 == _fseeki64(file, static_cast<int64_t>(padding), SEEK_CUR);
+}
+
 bool realcmp(
 	const float left,
 	const float right)
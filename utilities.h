@@ -1,6 +1,11 @@
 #pragma once
 
 #include <inttypes.h>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
 
 struct _iobuf;
 
@@ -24,6 +29,9 @@ struct s_point2d
 
 #define BIT_COUNT(type) ( sizeof(type) * 8 )
 
+// arrays in binary files start at this alignment, so a mapped file's arrays can be used in place
+constexpr size_t k_binary_file_array_alignment = 16;
+
 constexpr uint32_t compile_time_log2(
 	const uint32_t n,
 	const uint32_t p = 0)
@@ -41,10 +49,12 @@ bool test_bit(
 		const TFlags flags,
 		const TBit bit)
 {
-	static_assert(sizeof(TFlags) <= sizeof(uint32_t),
-		"test_bit not yet written to support >32-bit flags");
+	static_assert(sizeof(TFlags) <= sizeof(uint64_t),
+		"test_bit not yet written to support >64-bit flags");
 
-	return (static_cast<uint32_t>(flags) & (1U << static_cast<uint32_t>(bit))) > 0;
+	typedef typename std::conditional<(sizeof(TFlags) > sizeof(uint32_t)), uint64_t, uint32_t>::type bits_t;
+
+	return (static_cast<bits_t>(flags) & (static_cast<bits_t>(1) << static_cast<uint32_t>(bit))) > 0;
 }
 
 template<
@@ -60,12 +70,30 @@ inline
 	return (static_cast<uint32_t>(flags) & flag) != 0;
 }
 
+// a hint to start pulling the cache line holding address into the cache, for data about to be read
+inline
+void prefetch_for_read(
+	const void* address)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+	__builtin_prefetch(address, 0, 3);
+#else
+	(void)address;
+#endif
+}
+
 uint32_t count_number_of_1s_bits(
 	const uint32_t bits);
+uint32_t count_number_of_1s_bits(
+	const uint64_t bits);
 
 // if bits==0, returns -1
 int32_t index_of_lowest_bit_set(
 	const uint32_t bits);
+int32_t index_of_lowest_bit_set(
+	const uint64_t bits);
 
 // doesn't handle the bits==0 case
 int32_t index_of_highest_bit_set_unsafe(
@@ -74,6 +102,8 @@ int32_t index_of_highest_bit_set_unsafe(
 // if bits==0, returns -1
 int32_t index_of_highest_bit_set(
 	const uint32_t bits);
+int32_t index_of_highest_bit_set(
+	const uint64_t bits);
 
 // Count the "leftmost" consecutive zero bits (leading)
 uint32_t leading_zeros_count(
@@ -93,6 +123,30 @@ void __cdecl output_error(
 bool handle_byte_order_marker(
 	_iobuf* file);
 
+// for text already in memory, e.g. a mapped file. out_text_offset skips past any BOM
+bool handle_byte_order_marker(
+	const uint8_t* data,
+	const size_t size,
+	size_t& out_text_offset);
+
+inline
+size_t get_alignment_padding(
+	const size_t offset,
+	const size_t alignment)
+{
+	return (alignment - (offset % alignment)) % alignment;
+}
+
+// pads the file with zeros until its position is a multiple of alignment
+bool fwrite_alignment_padding(
+	_iobuf* file,
+	const size_t alignment = k_binary_file_array_alignment);
+
+// skips over the padding written by fwrite_alignment_padding
+bool fseek_past_alignment_padding(
+	_iobuf* file,
+	const size_t alignment = k_binary_file_array_alignment);
+
 bool realcmp(
 	const float left,
 	const float right);